@@ -0,0 +1,181 @@
+//@	{"target":{"name":"generate_terrain.o"}}
+
+#include "bin/cmdline.hpp"
+#include "bin/image_writer.hpp"
+
+#include "pixel_store/image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	uint64_t mix(uint64_t x)
+	{
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111eb;
+		x ^= x >> 31;
+		return x;
+	}
+
+	// A value in [0, 1) that only depends on the lattice point and the seed
+	double lattice_value(int64_t x, int64_t y, uint64_t seed)
+	{
+		auto const h = mix(seed ^ mix(static_cast<uint64_t>(x)*0x9e3779b97f4a7c15 ^ static_cast<uint64_t>(y)));
+		return static_cast<double>(h >> 11)*0x1.0p-53;
+	}
+
+	double value_noise(double x, double y, uint64_t seed)
+	{
+		auto const x0 = std::floor(x);
+		auto const y0 = std::floor(y);
+		auto const smooth = [](double t) { return t*t*(3.0 - 2.0*t); };
+		auto const tx = smooth(x - x0);
+		auto const ty = smooth(y - y0);
+		auto const ix = static_cast<int64_t>(x0);
+		auto const iy = static_cast<int64_t>(y0);
+
+		auto const v00 = lattice_value(ix, iy, seed);
+		auto const v10 = lattice_value(ix + 1, iy, seed);
+		auto const v01 = lattice_value(ix, iy + 1, seed);
+		auto const v11 = lattice_value(ix + 1, iy + 1, seed);
+		return (1.0 - ty)*((1.0 - tx)*v00 + tx*v10) + ty*((1.0 - tx)*v01 + tx*v11);
+	}
+
+	// Fractal noise in [0, 1]. The coarsest octave has features of period pixels.
+	double fractal_noise(double x, double y, uint64_t seed, double period, int octave_count)
+	{
+		auto sum = 0.0;
+		auto amplitude = 1.0;
+		auto total_amplitude = 0.0;
+		auto freq = 1.0/period;
+		for(int k = 0; k != octave_count; ++k)
+		{
+			sum += amplitude*value_noise(x*freq, y*freq, mix(seed + static_cast<uint64_t>(k)));
+			total_amplitude += amplitude;
+			amplitude *= 0.5;
+			freq *= 2.0;
+		}
+		return sum/total_amplitude;
+	}
+
+	struct terrain_sample
+	{
+		float elevation;
+		float friction;
+		float wind_x;
+		float wind_y;
+	};
+
+	// Features have a fixed size in pixels, so larger maps contain more terrain rather than
+	// smoother terrain
+	double terrain_elevation(double x, double y, uint64_t seed)
+	{ return fractal_noise(x, y, seed, 1024.0, 9); }
+
+	terrain_sample sample_terrain(double x, double y, uint64_t seed)
+	{
+		auto const elevation = terrain_elevation(x, y, seed);
+		auto friction = 1.0 + fractal_noise(x, y, seed + 1, 256.0, 4);
+
+		// Barriers follow a level curve of a coarse noise field, and have gaps where another
+		// field is high
+		auto const barrier = fractal_noise(x, y, seed + 2, 2048.0, 3);
+		if(std::abs(barrier - 0.5) < 0.002 && value_noise(x/96.0, y/96.0, seed + 3) < 0.8)
+		{ friction = 50.0; }
+
+		auto const wind_x = 2.0*fractal_noise(x, y, seed + 4, 4096.0, 3) - 1.0;
+		auto const wind_y = 2.0*fractal_noise(x, y, seed + 5, 4096.0, 3) - 1.0;
+		return terrain_sample{static_cast<float>(elevation),
+			static_cast<float>(friction),
+			static_cast<float>(wind_x),
+			static_cast<float>(wind_y)};
+	}
+
+	constexpr uint32_t rows_per_strip = 64;
+}
+
+int main(int argc, char** argv) try
+{
+	cheapest_route::command_line cmdline{argc, argv};
+	if(std::size(cmdline) == 0 || cmdline.contains("help"))
+	{
+		fprintf(stderr, "Usage: generate_terrain output_file=file.exr size=n channels=y|rgba [seed=n]\n");
+		return std::size(cmdline) == 0 ? -1 : 0;
+	}
+
+	std::filesystem::path const output_file{cmdline["output_file"]};
+	auto const size = std::stoul(cmdline["size"]);
+	if(size < 2 || size > 65536)
+	{ throw std::runtime_error{"The size must be between 2 and 65536"}; }
+
+	auto const channels = cmdline["channels"];
+	if(channels != "y" && channels != "rgba")
+	{ throw std::runtime_error{"Unsupported channels"}; }
+
+	auto const seed = static_cast<uint64_t>(std::stoull(get_or(cmdline, "seed", std::string{"1"})));
+	auto const width = static_cast<uint32_t>(size);
+	auto const height = static_cast<uint32_t>(size);
+
+	std::vector<char const*> channel_names;
+	if(channels == "y")
+	{ channel_names = {"Y"}; }
+	else
+	{ channel_names = {"R", "G", "B", "A"}; }
+
+	cheapest_route::image_row_writer dest{output_file, width, height, channel_names};
+	auto const thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	while(dest.next_row() != height)
+	{
+		auto const first_row = dest.next_row();
+		auto const rows = std::min(rows_per_strip, height - first_row);
+		std::vector<pixel_store::image<float>> strip;
+		for(size_t k = 0; k != std::size(channel_names); ++k)
+		{ strip.emplace_back(width, rows); }
+
+		{
+			std::vector<std::jthread> workers;
+			for(uint32_t k = 0; k != thread_count; ++k)
+			{
+				workers.emplace_back([&strip, k, thread_count, rows, width, first_row, seed]() {
+					for(auto y = k; y < rows; y += thread_count)
+					{
+						auto const y_pos = static_cast<double>(first_row + y);
+						for(uint32_t x = 0; x != width; ++x)
+						{
+							auto const x_pos = static_cast<double>(x);
+							if(std::size(strip) == 1)
+							{
+								strip[0](x, y) = static_cast<float>(terrain_elevation(x_pos, y_pos, seed));
+								continue;
+							}
+
+							auto const val = sample_terrain(x_pos, y_pos, seed);
+							strip[0](x, y) = val.elevation;
+							strip[1](x, y) = val.friction;
+							strip[2](x, y) = val.wind_x;
+							strip[3](x, y) = val.wind_y;
+						}
+					}
+				});
+			}
+		}
+
+		std::vector<cheapest_route::image_channel> strip_channels;
+		for(size_t k = 0; k != std::size(channel_names); ++k)
+		{ strip_channels.push_back(cheapest_route::image_channel{channel_names[k], strip[k].pixels()}); }
+		dest.write_rows(strip_channels);
+	}
+}
+catch(std::exception const& err)
+{
+	fprintf(stderr, "generate_terrain: %s\n", err.what());
+	return -1;
+}
@@ -0,0 +1,172 @@
+//@	{"target":{"name":"run_benchmark.o"}}
+
+#include "bin/cmdline.hpp"
+#include "bin/io_utils.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct process_result
+	{
+		int exit_status;
+		double wall_time;
+		long peak_rss;
+	};
+
+	// Runs args[0] with args, and measures its wall time and peak resident set size, in KiB
+	process_result run(std::vector<std::string> const& args)
+	{
+		std::vector<char*> argv;
+		for(auto const& item : args)
+		{ argv.push_back(const_cast<char*>(item.c_str())); }
+		argv.push_back(nullptr);
+
+		auto const start = std::chrono::steady_clock::now();
+		auto const pid = fork();
+		if(pid == -1)
+		{ throw std::runtime_error{"Failed to start a new process"}; }
+
+		if(pid == 0)
+		{
+			execv(argv[0], std::data(argv));
+			_exit(127);
+		}
+
+		int status = 0;
+		rusage usage{};
+		if(wait4(pid, &status, 0, &usage) == -1)
+		{ throw std::runtime_error{std::string{"Failed to wait for "}.append(args[0])}; }
+
+		return process_result{
+			WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status),
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+			usage.ru_maxrss
+		};
+	}
+
+	std::map<std::string, double> load_phase_times(std::filesystem::path const& filename)
+	{
+		std::map<std::string, double> ret;
+		cheapest_route::input_file const src{filename};
+		if(src.get() == nullptr)
+		{ return ret; }
+
+		char name[64];
+		double duration;
+		while(fscanf(src.get(), "%63s %lf", name, &duration) == 2)
+		{ ret[name] = duration; }
+		return ret;
+	}
+
+	std::vector<unsigned long> parse_sizes(std::string const& str)
+	{
+		std::vector<unsigned long> ret;
+		size_t pos = 0;
+		while(pos < std::size(str))
+		{
+			size_t length = 0;
+			ret.push_back(std::stoul(str.substr(pos), &length));
+			pos += length;
+			if(pos != std::size(str) && str[pos] != ',')
+			{ throw std::runtime_error{"Expected , between sizes"}; }
+			++pos;
+		}
+		return ret;
+	}
+
+	constexpr std::array<char const*, 4> phases{"load", "setup", "search", "output"};
+}
+
+int main(int argc, char** argv) try
+{
+	cheapest_route::command_line cmdline{argc, argv};
+	if(std::size(cmdline) == 0 || cmdline.contains("help"))
+	{
+		fprintf(stderr, "Usage: run_benchmark cheapest_route=path generate_terrain=path work_dir=dir "
+			"[sizes=1024,2048,...] [seed=n] [output_file=results.csv]\n");
+		return std::size(cmdline) == 0 ? -1 : 0;
+	}
+
+	auto const cheapest_route_path = cmdline["cheapest_route"];
+	auto const generator_path = cmdline["generate_terrain"];
+	std::filesystem::path const work_dir{cmdline["work_dir"]};
+	std::filesystem::create_directories(work_dir);
+	auto const sizes = parse_sizes(get_or(cmdline, "sizes", std::string{"1024,2048,4096"}));
+	auto const seed = get_or(cmdline, "seed", std::string{"1"});
+
+	auto output_file =
+		get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+			cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+	if(output_file.get() == nullptr)
+	{ throw std::runtime_error{"Failed to create the output file"}; }
+
+	fprintf(output_file.get(), "size,channels,exit_status,wall_time");
+	for(auto const phase : phases)
+	{ fprintf(output_file.get(), ",%s_time", phase); }
+	fprintf(output_file.get(), ",peak_rss_kib\n");
+	fflush(output_file.get());
+
+	for(auto const size : sizes)
+	{
+		for(auto const channels : {"y", "rgba"})
+		{
+			auto const name = std::to_string(size).append("_").append(channels);
+			auto const cost_map = work_dir/std::string{"terrain_"}.append(name).append(".exr");
+			if(!std::filesystem::exists(cost_map))
+			{
+				auto const res = run({generator_path,
+					std::string{"output_file="}.append(cost_map.string()),
+					std::string{"size="}.append(std::to_string(size)),
+					std::string{"channels="}.append(channels),
+					std::string{"seed="}.append(seed)});
+				if(res.exit_status != 0)
+				{ throw std::runtime_error{std::string{"Failed to generate "}.append(cost_map.string())}; }
+			}
+
+			auto const phase_file = work_dir/std::string{"phases_"}.append(name).append(".txt");
+			std::filesystem::remove(phase_file);
+			auto const margin = size/16;
+			auto const res = run({cheapest_route_path,
+				std::string{"cost_map="}.append(cost_map.string()),
+				std::string{"origin=("}.append(std::to_string(margin)).append(",")
+					.append(std::to_string(margin)).append(")"),
+				std::string{"destination=("}.append(std::to_string(size - 1 - margin)).append(",")
+					.append(std::to_string(size - 1 - margin)).append(")"),
+				"world_scale=(1,1,100)",
+				"friction_strength=1",
+				"wind_strength=(0.2,0.2)",
+				"output_format=txt",
+				"length_unit=m",
+				"output_file=/dev/null",
+				std::string{"phase_times="}.append(phase_file.string())});
+
+			auto const phase_times = load_phase_times(phase_file);
+			fprintf(output_file.get(), "%lu,%s,%d,%.6f", size, channels, res.exit_status, res.wall_time);
+			for(auto const phase : phases)
+			{
+				if(auto const i = phase_times.find(phase); i != std::end(phase_times))
+				{ fprintf(output_file.get(), ",%.6f", i->second); }
+				else
+				{ fprintf(output_file.get(), ","); }
+			}
+			fprintf(output_file.get(), ",%ld\n", res.peak_rss);
+			fflush(output_file.get());
+		}
+	}
+}
+catch(std::exception const& err)
+{
+	fprintf(stderr, "run_benchmark: %s\n", err.what());
+	return -1;
+}
@@ -0,0 +1,95 @@
+//@	{"target":{"name":"arc_flag_file.o"}}
+
+#include "./arc_flag_file.hpp"
+#include "./io_utils.hpp"
+#include "./hasher.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace
+{
+	constexpr std::array<char, 8> magic{'C', 'H', 'R', 'T', 'A', 'R', 'C', 'F'};
+	constexpr uint32_t format_version = 2;
+
+	struct file_header
+	{
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t header_size;
+		cheapest_route::cost_function_key key;
+		int64_t width;
+		int64_t height;
+		int64_t region_size;
+		uint64_t word_count;
+		cheapest_route::memory_layout layout;
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(file_header) == 112);
+}
+
+cheapest_route::cost_function_key
+cheapest_route::arc_flags_key(cost_function const& f, passability_view const* passability)
+{
+	hasher h;
+	h.add(format_version);
+	add(h, f);
+	if(passability != nullptr)
+	{ h.add(std::as_bytes(passability->bits)); }
+	return cost_function_key{h.value(), get_cost_parameters(f)};
+}
+
+void cheapest_route::store(arc_flags_view const& flags,
+	cost_function_key const& key,
+	std::filesystem::path const& filename)
+{
+	file_header const header{
+		magic,
+		format_version,
+		sizeof(file_header),
+		key,
+		flags.domain.width(),
+		flags.domain.height(),
+		flags.region_size,
+		std::size(flags.bits),
+		grid_layout,
+		0
+	};
+
+	output_file const dest{filename};
+	if(dest.get() == nullptr)
+	{ throw std::runtime_error{std::string{"Failed to create "}.append(filename.string())}; }
+
+	if(fwrite(&header, sizeof(header), 1, dest.get()) != 1
+		|| fwrite(std::data(flags.bits), sizeof(uint64_t), std::size(flags.bits), dest.get()) != std::size(flags.bits))
+	{ throw std::runtime_error{std::string{"Failed to write "}.append(filename.string())}; }
+}
+
+cheapest_route::arc_flag_file
+cheapest_route::load_arc_flags(std::filesystem::path const& filename, cost_function_key const& key)
+{
+	mapped_file file{filename};
+	auto const data = file.data();
+	if(std::size(data) < sizeof(file_header))
+	{ throw std::runtime_error{std::string{"Unsupported arc flag file "}.append(filename.string())}; }
+
+	file_header header;
+	memcpy(&header, std::data(data), sizeof(header));
+	auto const domain = search_domain{header.width, header.height};
+	if(header.magic != magic || header.version != format_version || header.header_size != sizeof(file_header)
+		|| header.layout != grid_layout || header.width < 1 || header.height < 1 || header.region_size < 1
+		|| header.word_count != arc_flag_word_count(domain, header.region_size)
+		|| std::size(data) != sizeof(file_header) + header.word_count*sizeof(uint64_t))
+	{ throw std::runtime_error{std::string{"Unsupported arc flag file "}.append(filename.string())}; }
+
+	if(header.key != key)
+	{
+		throw std::runtime_error{std::string{"The arc flags in "}.append(filename.string())
+			.append(" were computed from a different cost map, passability mask, or with different parameters")};
+	}
+
+	auto const bits = reinterpret_cast<uint64_t const*>(std::data(data) + sizeof(file_header));
+	return arc_flag_file{std::move(file),
+		arc_flags_view{domain, header.region_size, std::span{bits, header.word_count}}};
+}
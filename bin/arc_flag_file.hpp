@@ -0,0 +1,43 @@
+//@	{"dependencies_extra":[{"ref":"./arc_flag_file.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_ARCFLAGFILE_HPP
+#define CHEAPESTROUTE_ARCFLAGFILE_HPP
+
+#include "./cost_function.hpp"
+#include "./hasher.hpp"
+#include "./mapped_file.hpp"
+
+#include "lib/arc_flags.hpp"
+#include "lib/passability.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace cheapest_route
+{
+	// Identifies a set of arc flags by everything that affects its contents
+	cost_function_key arc_flags_key(cost_function const& f, passability_view const* passability);
+
+	class arc_flag_file
+	{
+	public:
+		explicit arc_flag_file(mapped_file&& file, arc_flags_view const& view):
+			m_file{std::move(file)},
+			m_view{view}
+		{}
+
+		arc_flags_view const& view() const
+		{ return m_view; }
+
+	private:
+		mapped_file m_file;
+		arc_flags_view m_view;
+	};
+
+	void store(arc_flags_view const& flags, cost_function_key const& key, std::filesystem::path const& filename);
+
+	// Throws if the file was computed from a different cost function or passability mask
+	arc_flag_file load_arc_flags(std::filesystem::path const& filename, cost_function_key const& key);
+}
+
+#endif
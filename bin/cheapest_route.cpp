@@ -4,62 +4,681 @@
 #include "./io_utils.hpp"
 #include "./scaling_factors.hpp"
 #include "./image_loader.hpp"
+#include "./cost_function.hpp"
+#include "./cost_expression.hpp"
 #include "./path_encoder.hpp"
 #include "./length_unit.hpp"
+#include "./image_writer.hpp"
+#include "./search_tree_cache.hpp"
+#include "./edge_weight_file.hpp"
+#include "./arc_flag_file.hpp"
+#include "./parameter_sweep.hpp"
+#include "./waypoint_list.hpp"
+#include "./progressive_cost_map.hpp"
+#include "./phase_timer.hpp"
+#include "./tile_file.hpp"
+#include "./worker_processes.hpp"
 
 #include "lib/search.hpp"
+#include "lib/level_curves.hpp"
+#include "lib/search_tree.hpp"
+#include "lib/edge_weights.hpp"
+#include "lib/arc_flags.hpp"
+#include "lib/anytime_search.hpp"
+#include "lib/alternative_routes.hpp"
+#include "lib/waypoint_search.hpp"
+#include "lib/passability.hpp"
+#include "lib/uniform_blocks.hpp"
+#include "lib/adaptive_lattice.hpp"
+#include "lib/path_simplification.hpp"
+#include "lib/tiled_search.hpp"
 #include "pixel_store/image.hpp"
 
 #include <cassert>
 
 namespace cheapest_route
 {
-	cost_values interp(pixel_store::image_span<cost_values const> img, vec2f_t loc)
+	template<class ImageSpan>
+	std::vector<float> get_elevation_profile(ImageSpan pixels, path const& nodes)
 	{
-		auto const x_0  = static_cast<int64_t>(loc[0]);
-		auto const y_0  = static_cast<int64_t>(loc[1]);
+		std::vector<float> ret;
+		ret.reserve(std::size(nodes));
+		std::ranges::transform(nodes, std::back_inserter(ret), [pixels](auto const& item) {
+			return interp(pixels, item.loc.value()).elevation();
+		});
+		return ret;
+	}
+
+	double get_simplify_tolerance(command_line const& cmdline)
+	{
+		auto const ret = get_or(cmdline, "simplify", 0.0);
+		if(!(ret >= 0.0))
+		{ throw std::runtime_error{"The simplify tolerance must be non-negative"}; }
+		return ret;
+	}
+
+	// Removes nodes that are within tolerance from the route through the remaining nodes, measured
+	// in world coordinates, including elevation. The remaining nodes keep their integrated_cost.
+	void simplify_path(path& nodes,
+		std::vector<float>& elevation_profile,
+		scaling_factors world_scale,
+		double tolerance)
+	{
+		if(tolerance == 0.0)
+		{ return; }
+
+		std::vector<polyline_point> points;
+		points.reserve(std::size(nodes));
+		for(size_t k = 0; k != std::size(nodes); ++k)
+		{
+			points.push_back(polyline_point{
+				vec<double, 2>{world_scale.x()*nodes[k].loc[0], world_scale.y()*nodes[k].loc[1]},
+				static_cast<double>(world_scale.z()*elevation_profile[k])
+			});
+		}
+
+		auto const kept = simplify_polyline(points, tolerance);
+		for(size_t k = 0; k != std::size(kept); ++k)
+		{
+			nodes[k] = nodes[kept[k]];
+			elevation_profile[k] = elevation_profile[kept[k]];
+		}
+		nodes.resize(std::size(kept));
+		elevation_profile.resize(std::size(kept));
+	}
+
+	void compute_reachable_area(command_line const& cmdline,
+		from<int64_t> origin,
+		cost_map_span cost_map,
+		cost_function const& f,
+		search_options const& options)
+	{
+		if(options.max_cost == std::numeric_limits<double>::infinity())
+		{ throw std::runtime_error{"reachable_area requires max_cost"}; }
 
-		auto const w = static_cast<int64_t>(img.width());
-		auto const h = static_cast<int64_t>(img.height());
+		auto const mask_file = get_if<std::filesystem::path>(cmdline, "mask_file");
+		auto const mask_type = get_or(cmdline, "mask_type", std::string{"binary"});
+		if(mask_type != "binary" && mask_type != "cost")
+		{ throw std::runtime_error{"Unsupported mask type"}; }
 
-		auto const x_1  = std::min(x_0 + 1, w - 1);
-		auto const y_1  = std::min(y_0 + 1, h - 1);
+		auto const encode = get_if<path_encoder>(cmdline, "output_format");
+		if(!mask_file.has_value() && !encode.has_value())
+		{ throw std::runtime_error{"reachable_area requires mask_file, output_format, or both"}; }
 
-		auto const z_00 = img(x_0, y_0);
-		auto const z_01 = img(x_0, y_1);
-		auto const z_10 = img(x_1, y_0);
-		auto const z_11 = img(x_1, y_1);
+		auto const lu = encode.has_value() ?
+			std::optional<length_unit>{cmdline["length_unit"]} : std::optional<length_unit>{};
 
-		auto const xi = loc - vec2f_t{static_cast<double>(x_0), static_cast<double>(y_0)};
+		auto const w = cost_map.width();
+		auto const h = cost_map.height();
+		auto const domain = search_domain{static_cast<int64_t>(w), static_cast<int64_t>(h)};
+		pixel_store::image<float> costs{w, h};
+		auto const field = std::span{costs.pixels().data(), static_cast<size_t>(w)*h};
+		compute_cost_field(origin, domain, field, f, options);
 
-		auto const z_x0 = (1.0f - static_cast<float>(xi[0])) * z_00 + static_cast<float>(xi[0]) * z_10;
-		auto const z_x1 = (1.0f - static_cast<float>(xi[0])) * z_01 + static_cast<float>(xi[0]) * z_11;
-		return (1.0f - static_cast<float>(xi[1])) * z_x0 + static_cast<float>(xi[1]) * z_x1;
+		if(encode.has_value())
+		{
+			auto curves = trace_level_curves(field, domain, static_cast<float>(options.max_cost));
+			auto const tolerance = get_simplify_tolerance(cmdline);
+			std::vector<std::vector<float>> elevation_profiles;
+			std::vector<path_with_elevation> paths;
+			elevation_profiles.reserve(std::size(curves));
+			paths.reserve(std::size(curves));
+			for(auto& curve : curves)
+			{
+				elevation_profiles.push_back(get_elevation_profile(cost_map, curve));
+				simplify_path(curve, elevation_profiles.back(), f.world_scale, tolerance);
+				paths.push_back(path_with_elevation{&curve, std::data(elevation_profiles.back())});
+			}
+
+			auto output_file =
+				get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+					cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+			(*encode)(output_file.get(), *lu, f.world_scale, domain, paths);
+		}
+
+		if(mask_file.has_value())
+		{
+			if(mask_type == "binary")
+			{
+				std::ranges::transform(field, std::begin(field), [](auto val) {
+					return val != std::numeric_limits<float>::infinity() ? 1.0f : 0.0f;
+				});
+			}
+
+			std::array<image_channel, 1> const channels{image_channel{"Y", costs.pixels()}};
+			store_image(*mask_file, channels);
+		}
 	}
 
-	struct cost_function
+	void compute_source_partition(command_line const& cmdline,
+		search_domain const& domain,
+		cost_function const& f,
+		search_options const& options)
 	{
-		pixel_store::image_span<cost_values const> image;
-		scaling_factors world_scale;
-		float friction_strength;
-		cheapest_route::vec<double, 2, cheapest_route::quantity_type::vector> wind_strength;
+		auto const sources = get_if<waypoint_list>(cmdline, "sources");
+		if(!sources.has_value())
+		{ throw std::runtime_error{"source_partition requires sources"}; }
+
+		auto const label_file = get_if<std::filesystem::path>(cmdline, "label_file");
+		auto const cost_file = get_if<std::filesystem::path>(cmdline, "cost_file");
+		if(!label_file.has_value() && !cost_file.has_value())
+		{ throw std::runtime_error{"source_partition requires label_file, cost_file, or both"}; }
 
-		auto operator()(from<double> x1, to<double> x2) const
+		auto const w = static_cast<uint32_t>(domain.width());
+		auto const h = static_cast<uint32_t>(domain.height());
+		pixel_store::image<float> costs{w, h};
+		std::vector<uint32_t> labels(static_cast<size_t>(w)*h);
+		auto const field = std::span{costs.pixels().data(), static_cast<size_t>(w)*h};
+		compute_source_partition(sources->points(), domain, field, labels, f, options);
+
+		if(label_file.has_value())
 		{
-			auto const dx = x2 - x1;
-			auto const c1 = interp(image, x1.value());
-			auto const c2 = interp(image, x2.value());
+			pixel_store::image<float> label_image{w, h};
+			std::ranges::transform(labels, label_image.pixels().data(), [](auto val) {
+				return val != no_source ? static_cast<float>(val) : -1.0f;
+			});
 
-			auto const dr = world_scale*vec<float, 4>{static_cast<float>(dx[0]),
-				static_cast<float>(dx[1]),
-				c2.elevation() - c1.elevation(),
-				0.0f};
+			std::array<image_channel, 1> const channels{image_channel{"Y", label_image.pixels()}};
+			store_image(*label_file, channels);
+		}
 
-			auto const c = interp(image, midpoint(x2, x1).value());
-			return friction_strength*c.friction()*std::sqrt(dot(dr, dr))
-				+ std::abs(dot(scale(c.wind(), wind_strength), dx));
+		if(cost_file.has_value())
+		{
+			std::array<image_channel, 1> const channels{image_channel{"Y", costs.pixels()}};
+			store_image(*cost_file, channels);
 		}
-	};
+	}
+
+	template<class ImageSpan>
+	std::optional<passability_mask> load_passability(command_line const& cmdline, ImageSpan cost_map)
+	{
+		auto const mask_file = get_if<std::filesystem::path>(cmdline, "passability_mask");
+		if(!mask_file.has_value() && !cmdline.contains("friction_threshold"))
+		{ return std::nullopt; }
+
+		auto const friction_threshold = get_or(cmdline, "friction_threshold", std::numeric_limits<float>::infinity());
+		auto const channel = get_or(cmdline, "passability_channel", std::string{"Y"});
+		auto const mask = mask_file.has_value() ?
+			std::optional{load_channel(*mask_file, channel.c_str())} : std::nullopt;
+		if(mask.has_value() && (mask->width() != cost_map.width() || mask->height() != cost_map.height()))
+		{ throw std::runtime_error{"The passability mask must have the same size as the cost map"}; }
+
+		auto const domain = search_domain{
+			static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+		};
+		return make_passability_mask(domain, [&mask, cost_map, friction_threshold](int64_t x, int64_t y) {
+			auto const px = static_cast<uint32_t>(x);
+			auto const py = static_cast<uint32_t>(y);
+			if(mask.has_value() && (*mask)(px, py) == 0.0f)
+			{ return false; }
+			return cost_map(px, py).friction() < friction_threshold;
+		});
+	}
+
+	std::optional<uniform_block_mask> find_uniform_blocks(command_line const& cmdline, cost_map_span cost_map)
+	{
+		if(!cmdline.contains("jump_block_size"))
+		{ return std::nullopt; }
+
+		if(get_or(cmdline, "mode", std::string{"route"}) != "route")
+		{ throw std::runtime_error{"jump_block_size is only supported in route mode"}; }
+
+		auto const block_size = get_or(cmdline, "jump_block_size", 0.0);
+		if(!(block_size >= 2.0 && block_size <= 4096.0) || block_size != std::floor(block_size))
+		{ throw std::runtime_error{"The jump block size must be an integer between 2 and 4096"}; }
+
+		auto const domain = search_domain{
+			static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+		};
+		return make_uniform_block_mask(domain, static_cast<int64_t>(block_size),
+			[cost_map](int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+				auto const a = cost_map(static_cast<uint32_t>(x0), static_cast<uint32_t>(y0));
+				auto const b = cost_map(static_cast<uint32_t>(x1), static_cast<uint32_t>(y1));
+				return a.elevation() == b.elevation() && a.friction() == b.friction()
+					&& a.wind()[0] == b.wind()[0] && a.wind()[1] == b.wind()[1];
+			});
+	}
+
+	path find_route_using_cache(std::filesystem::path const& cache_dir,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		cost_function const& f,
+		search_options const& options)
+	{
+		auto const key = search_tree_key(f, destination, options);
+		auto const filename = search_tree_filename(cache_dir, key);
+		if(auto const cached = load_search_tree(filename, key); cached.has_value())
+		{ return follow_search_tree(cached->view(), origin); }
+
+		auto const domain = search_domain{
+			static_cast<int64_t>(f.image.width()), static_cast<int64_t>(f.image.height())
+		};
+		auto const tree = build_search_tree(destination, domain, f, options);
+		store(tree.view(), key, filename);
+		return follow_search_tree(tree.view(), origin);
+	}
+
+	path find_route_anytime(double time_budget,
+		double heuristic_weight,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		search_domain const& domain,
+		cost_function const& f,
+		search_options const& options)
+	{
+		if(!(time_budget >= 0.0 && time_budget < 1.0e6))
+		{ throw std::runtime_error{"The time budget must be between 0 and 1e6 seconds"}; }
+
+		anytime_search_options anytime_options;
+		anytime_options.min_cost_per_length = min_cost_per_length(f);
+		anytime_options.initial_weight = heuristic_weight;
+		anytime_options.time_budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>{time_budget});
+
+		auto result = anytime_search(origin, destination, domain, f, options, anytime_options);
+		fprintf(stderr, "cheapest_route: Suboptimality bound after %zu iteration(s): %.8g\n",
+			result.iteration_count, result.suboptimality_bound);
+		return std::move(result.route);
+	}
+
+	// The adaptive lattice only implements route mode, and max_cost among the search options
+	std::string get_lattice(command_line const& cmdline)
+	{
+		auto ret = get_or(cmdline, "lattice", std::string{"regular"});
+		if(ret != "regular" && ret != "adaptive")
+		{ throw std::runtime_error{"Unsupported lattice"}; }
+
+		if(ret == "adaptive")
+		{
+			if(get_or(cmdline, "mode", std::string{"route"}) != "route")
+			{ throw std::runtime_error{"The adaptive lattice is only supported in route mode"}; }
+
+			for(auto const key : {"route_cache", "time_budget", "waypoints", "edge_weights", "search_bounds",
+				"passability_mask", "friction_threshold", "jump_block_size", "arc_flags", "alternatives", "sweep"})
+			{
+				if(cmdline.contains(key))
+				{ throw std::runtime_error{std::string{"The adaptive lattice cannot be combined with "}.append(key)}; }
+			}
+		}
+		return ret;
+	}
+
+	path find_route_adaptive(command_line const& cmdline,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		cost_map_span cost_map,
+		cost_function const& f,
+		search_options const& options)
+	{
+		auto const threshold = get_or(cmdline, "refinement_threshold", 0.05f);
+		if(!(threshold >= 0.0f))
+		{ throw std::runtime_error{"The refinement threshold must be non-negative"}; }
+
+		adaptive_lattice_options lattice_options;
+		lattice_options.max_cell_size = static_cast<int64_t>(get_or(cmdline, "max_cell_size",
+			static_cast<double>(lattice_options.max_cell_size)));
+
+		auto const domain = search_domain{
+			static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+		};
+		auto const lattice = build_adaptive_lattice(domain,
+			[cost_map, world_scale = f.world_scale, threshold](search_bounds const& cell) {
+				return is_smooth(cost_map, cell, world_scale, threshold);
+			},
+			lattice_options);
+		return search_adaptive(lattice, origin, destination, f, options);
+	}
+
+	template<class CostFunction>
+	path find_route_via_waypoints(waypoint_list const& waypoints,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		search_domain const& domain,
+		CostFunction const& f,
+		search_options const& options)
+	{
+		std::vector<vec<int64_t, 2>> points;
+		points.reserve(std::size(waypoints.points()) + 2);
+		points.push_back(vec<int64_t, 2>{origin.value()});
+		points.insert(std::end(points), std::begin(waypoints.points()), std::end(waypoints.points()));
+		points.push_back(vec<int64_t, 2>{destination.value()});
+		return search_via_waypoints(points, domain, f, options);
+	}
+
+	void write_alternative_routes(command_line const& cmdline,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		cost_map_span cost_map,
+		cost_function const& f,
+		search_options const& options)
+	{
+		if(options.edge_weights != nullptr || cmdline.contains("route_cache") || cmdline.contains("time_budget")
+			|| cmdline.contains("waypoints") || cmdline.contains("cost_expr"))
+		{
+			throw std::runtime_error{"alternatives cannot be combined with edge_weights, route_cache, time_budget, "
+				"waypoints, or cost_expr"};
+		}
+
+		auto const route_count = get_or(cmdline, "alternatives", 1.0);
+		if(!(route_count >= 1.0 && route_count <= 64.0) || route_count != std::floor(route_count))
+		{ throw std::runtime_error{"The number of alternatives must be an integer between 1 and 64"}; }
+
+		alternative_route_options alt_options;
+		alt_options.route_count = static_cast<size_t>(route_count);
+		alt_options.max_stretch = get_or(cmdline, "max_stretch", alt_options.max_stretch);
+		alt_options.max_overlap = get_or(cmdline, "max_overlap", alt_options.max_overlap);
+
+		path_encoder const encode{cmdline["output_format"]};
+		length_unit const lu{cmdline["length_unit"]};
+		auto const domain = search_domain{
+			static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+		};
+		auto routes = find_alternative_routes(origin, destination, domain, f, options, alt_options);
+		auto const tolerance = get_simplify_tolerance(cmdline);
+
+		std::vector<std::vector<float>> elevation_profiles;
+		std::vector<path_with_elevation> paths;
+		elevation_profiles.reserve(std::size(routes));
+		paths.reserve(std::size(routes));
+		for(auto& route : routes)
+		{
+			elevation_profiles.push_back(get_elevation_profile(cost_map, route));
+			simplify_path(route, elevation_profiles.back(), f.world_scale, tolerance);
+			paths.push_back(path_with_elevation{&route, std::data(elevation_profiles.back())});
+		}
+
+		auto output_file =
+			get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+				cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+		encode(output_file.get(), lu, f.world_scale, domain, paths);
+	}
+
+	void run_parameter_sweep(command_line const& cmdline,
+		std::filesystem::path const& grid_file,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		cost_map_span cost_map,
+		sweep_parameters const& defaults,
+		search_options const& options)
+	{
+		if(options.edge_weights != nullptr || cmdline.contains("route_cache") || cmdline.contains("time_budget")
+			|| cmdline.contains("alternatives") || cmdline.contains("waypoints") || cmdline.contains("cost_expr")
+			|| cmdline.contains("simplify") || cmdline.contains("arc_flags") || cmdline.contains("jump_block_size"))
+		{
+			throw std::runtime_error{"sweep cannot be combined with edge_weights, route_cache, time_budget, alternatives, "
+				"waypoints, cost_expr, simplify, arc_flags, or jump_block_size"};
+		}
+
+		length_unit const lu{cmdline["length_unit"]};
+		auto const grid = load_parameter_grid(grid_file, defaults);
+		auto const results = run_sweep(origin, destination, cost_map, grid, options,
+			std::max(std::thread::hardware_concurrency(), 1u));
+
+		auto output_file =
+			get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+				cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+		write_sweep_results(output_file.get(), lu, origin, destination,
+			search_domain{static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())},
+			results);
+	}
+
+	// Searches while the cost map is being decoded, so the search only waits for the rows it reaches
+	void find_route_progressively(command_line const& cmdline,
+		std::filesystem::path const& cost_map_path,
+		scaling_factors world_scale,
+		float friction_strength,
+		vec<double, 2, quantity_type::vector> wind_strength,
+		cost_expression const* expression)
+	{
+		if(get_or(cmdline, "mode", std::string{"route"}) != "route")
+		{ throw std::runtime_error{"Progressive loading is only supported in route mode"}; }
+
+		if(get_or(cmdline, "lattice", std::string{"regular"}) != "regular")
+		{ throw std::runtime_error{"Progressive loading is only supported with the regular lattice"}; }
+
+		for(auto const key : {"edge_weights", "route_cache", "time_budget", "sweep", "alternatives", "jump_block_size",
+			"arc_flags", "phase_times"})
+		{
+			if(cmdline.contains(key))
+			{ throw std::runtime_error{std::string{"Progressive loading cannot be combined with "}.append(key)}; }
+		}
+
+		from<int64_t> const origin{cmdline["origin"]};
+		to<int64_t> const destination{cmdline["destination"]};
+		path_encoder const encode{cmdline["output_format"]};
+		length_unit const lu{cmdline["length_unit"]};
+		auto const waypoints = get_if<waypoint_list>(cmdline, "waypoints");
+
+		progressive_cost_map const cost_map{cost_map_path,
+			static_cast<uint32_t>(std::clamp(origin.value()[1], int64_t{0}, int64_t{UINT32_MAX}))};
+		auto const domain = search_domain{
+			static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+		};
+		auto const f = basic_cost_function<progressive_cost_map_span>{
+			cost_map.pixels(), world_scale, friction_strength, wind_strength, expression
+		};
+		auto const batch_cost = make_batch_cost_function(f);
+
+		auto const passability = load_passability(cmdline, cost_map.pixels());
+		auto const passability_view = passability.has_value() ? std::optional{passability->view()} : std::nullopt;
+		auto const options = search_options{
+			.max_cost = get_or(cmdline, "max_cost", std::numeric_limits<double>::infinity()),
+			.bounds = get_if<search_bounds>(cmdline, "search_bounds"),
+			.passability = passability_view.has_value() ? &*passability_view : nullptr,
+			.batch_cost = expression != nullptr ? &batch_cost : nullptr
+		};
+
+		auto const tolerance = get_simplify_tolerance(cmdline);
+		auto result = waypoints.has_value() ?
+			find_route_via_waypoints(*waypoints, origin, destination, domain, f, options)
+			: search(origin, destination, domain, f, options);
+
+		auto output_file =
+			get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+				cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+
+		auto elevation_profile = get_elevation_profile(cost_map.pixels(), result);
+		simplify_path(result, elevation_profile, world_scale, tolerance);
+		encode(output_file.get(), lu, world_scale, domain, result, std::data(elevation_profile));
+	}
+
+	void check_tiled_options(command_line const& cmdline)
+	{
+		if(get_or(cmdline, "mode", std::string{"route"}) != "route")
+		{ throw std::runtime_error{"Tiled loading is only supported in route mode"}; }
+
+		if(get_or(cmdline, "lattice", std::string{"regular"}) != "regular")
+		{ throw std::runtime_error{"Tiled loading is only supported with the regular lattice"}; }
+
+		for(auto const key : {"edge_weights", "route_cache", "time_budget", "sweep", "alternatives", "waypoints",
+			"jump_block_size", "passability_mask", "arc_flags", "search_bounds", "max_cost", "phase_times"})
+		{
+			if(cmdline.contains(key))
+			{ throw std::runtime_error{std::string{"Tiled loading cannot be combined with "}.append(key)}; }
+		}
+	}
+
+	tile_grid get_tile_grid(command_line const& cmdline, search_domain const& domain)
+	{
+		auto const tile_size = get_or(cmdline, "tile_size", 1024.0);
+		if(!(tile_size >= 2.0) || tile_size != std::floor(tile_size))
+		{ throw std::runtime_error{"The tile size must be an integer of at least 2"}; }
+
+		auto const overlap = get_or(cmdline, "tile_overlap", 64.0);
+		if(!(overlap >= 0.0) || overlap != std::floor(overlap))
+		{ throw std::runtime_error{"The tile overlap must be a non-negative integer"}; }
+
+		auto const spacing = get_or(cmdline, "boundary_spacing", 16.0);
+		if(!(spacing >= 1.0) || spacing != std::floor(spacing))
+		{ throw std::runtime_error{"The boundary spacing must be a positive integer"}; }
+
+		return tile_grid{domain,
+			static_cast<int64_t>(tile_size),
+			static_cast<int64_t>(overlap),
+			static_cast<int64_t>(spacing)};
+	}
+
+	search_domain get_image_domain(std::filesystem::path const& cost_map_path)
+	{
+		image_row_reader const src{cost_map_path};
+		return search_domain{static_cast<int64_t>(src.width()), static_cast<int64_t>(src.height())};
+	}
+
+	// Runs one task of find_route_tiled, in a worker process. Only the part of the cost map that the
+	// window of the tile covers is loaded.
+	void solve_tile(command_line const& cmdline,
+		std::filesystem::path const& cost_map_path,
+		scaling_factors world_scale,
+		float friction_strength,
+		vec<double, 2, quantity_type::vector> wind_strength,
+		cost_expression const* expression)
+	{
+		check_tiled_options(cmdline);
+		auto const task = cmdline["tile_task"];
+		if(task != "costs" && task != "route")
+		{ throw std::runtime_error{"Unsupported tile task"}; }
+
+		image_row_reader src{cost_map_path};
+		auto const grid = get_tile_grid(cmdline,
+			search_domain{static_cast<int64_t>(src.width()), static_cast<int64_t>(src.height())});
+		vec<int64_t, 2> const tile{cmdline["tile"]};
+		if(tile[0] < 0 || tile[0] >= tile_count_x(grid) || tile[1] < 0 || tile[1] >= tile_count_y(grid))
+		{ throw std::runtime_error{"The tile is outside the cost map"}; }
+
+		auto const window = tile_window(grid, tile);
+		auto const offset = window.min();
+		image_type pixels{static_cast<uint32_t>(window.width()), static_cast<uint32_t>(window.height())};
+		src.read_region(pixels.pixels(), static_cast<uint32_t>(offset[0]), static_cast<uint32_t>(offset[1]));
+		sampled_cost_map const cost_map{std::move(pixels)};
+
+		auto const f = cost_function{cost_map.pixels(), world_scale, friction_strength, wind_strength, expression};
+		auto const batch_cost = make_batch_cost_function(f);
+		auto options = search_options{};
+		options.batch_cost = expression != nullptr ? &batch_cost : nullptr;
+
+		from<int64_t> const origin{cmdline["origin"]};
+		to<int64_t> const destination{cmdline["destination"]};
+		std::filesystem::path const result_file{cmdline["tile_result"]};
+		if(task == "costs")
+		{
+			std::array const extra_nodes{vec<int64_t, 2>{origin}, vec<int64_t, 2>{destination}};
+			store(compute_tile_costs(grid, tile, extra_nodes, f, options), result_file);
+			return;
+		}
+
+		auto route = search(from<int64_t>{vec<int64_t, 2>{origin} - offset},
+			to<int64_t>{vec<int64_t, 2>{destination} - offset},
+			search_domain{window.width(), window.height()},
+			f,
+			options);
+		auto elevation_profile = get_elevation_profile(cost_map.pixels(), route);
+		auto const loc_offset = vec<double, 2, quantity_type::point>{
+			static_cast<double>(offset[0]), static_cast<double>(offset[1])
+		};
+		for(auto& item : route)
+		{ item.loc += loc_offset; }
+		store(tile_route{std::move(route), std::move(elevation_profile)}, result_file);
+	}
+
+	// Splits the cost map into tiles that are solved by worker processes, so no process needs the
+	// entire cost map. The workers first compute the costs between the boundary nodes of every tile.
+	// The cheapest route through these nodes is then refined within each tile it crosses.
+	void find_route_tiled(command_line const& cmdline,
+		std::filesystem::path const& cost_map_path,
+		scaling_factors world_scale)
+	{
+		check_tiled_options(cmdline);
+		from<int64_t> const origin{cmdline["origin"]};
+		to<int64_t> const destination{cmdline["destination"]};
+		path_encoder const encode{cmdline["output_format"]};
+		length_unit const lu{cmdline["length_unit"]};
+		auto const tolerance = get_simplify_tolerance(cmdline);
+
+		auto const worker_count = get_or(cmdline, "worker_count",
+			static_cast<double>(std::max(std::thread::hardware_concurrency(), 1u)));
+		if(!(worker_count >= 1.0) || worker_count != std::floor(worker_count))
+		{ throw std::runtime_error{"The worker count must be a positive integer"}; }
+
+		auto const domain = get_image_domain(cost_map_path);
+		auto const grid = get_tile_grid(cmdline, domain);
+		if(!inside(vec<int64_t, 2>{origin}, domain) || !inside(vec<int64_t, 2>{destination}, domain))
+		{ throw std::runtime_error{"The origin and the destination must be within the cost map"}; }
+
+		// Workers get the same options, except for the ones that describe their task
+		std::vector<std::string> base_args;
+		for(auto const& [key, value] : cmdline)
+		{
+			if(key != "origin" && key != "destination" && key != "output_file")
+			{ base_args.push_back(std::string{key}.append("=").append(value)); }
+		}
+
+		temporary_directory const work_dir{"cheapest_route_"};
+		auto const make_job = [&base_args, &work_dir](vec<int64_t, 2> tile,
+			char const* task,
+			from<int64_t> leg_origin,
+			to<int64_t> leg_destination,
+			std::string const& result_name) {
+			auto ret = base_args;
+			ret.push_back(std::string{"tile_task="}.append(task));
+			ret.push_back(std::string{"tile="}.append(to_string(tile)));
+			ret.push_back(std::string{"origin="}.append(to_string(leg_origin)));
+			ret.push_back(std::string{"destination="}.append(to_string(leg_destination)));
+			ret.push_back(std::string{"tile_result="}.append((work_dir.path()/result_name).string()));
+			return ret;
+		};
+
+		auto const executable = std::filesystem::read_symlink("/proc/self/exe");
+		auto const process_count = static_cast<size_t>(worker_count);
+		auto const legs = [&]() {
+			std::vector<std::vector<std::string>> jobs;
+			std::vector<std::string> result_names;
+			for(int64_t y = 0; y != tile_count_y(grid); ++y)
+			{
+				for(int64_t x = 0; x != tile_count_x(grid); ++x)
+				{
+					result_names.push_back(std::string{"costs_"}.append(std::to_string(std::size(jobs))));
+					jobs.push_back(make_job(vec<int64_t, 2>{x, y}, "costs", origin, destination, result_names.back()));
+				}
+			}
+			run_worker_processes(executable, jobs, process_count);
+
+			std::vector<tile_costs> tiles;
+			tiles.reserve(std::size(result_names));
+			for(auto const& item : result_names)
+			{ tiles.push_back(load_tile_costs(work_dir.path()/item)); }
+			return find_tile_legs(grid, tiles, origin, destination);
+		}();
+
+		std::vector<std::vector<std::string>> jobs;
+		for(size_t k = 0; k != std::size(legs); ++k)
+		{
+			jobs.push_back(make_job(legs[k].tile, "route", legs[k].origin, legs[k].destination,
+				std::string{"route_"}.append(std::to_string(k))));
+		}
+		run_worker_processes(executable, jobs, process_count);
+
+		path result;
+		std::vector<float> elevation_profile;
+		auto offset = 0.0;
+		for(size_t k = 0; k != std::size(legs); ++k)
+		{
+			auto const leg = load_tile_route(work_dir.path()/std::string{"route_"}.append(std::to_string(k)));
+
+			// The first node of a leg is the last node of the previous one
+			for(auto i = std::empty(result) ? size_t{0} : size_t{1}; i < std::size(leg.nodes); ++i)
+			{
+				result.push_back(visited_node{leg.nodes[i].loc, offset + leg.nodes[i].integrated_cost});
+				elevation_profile.push_back(leg.elevation_profile[i]);
+			}
+			offset = result.back().integrated_cost;
+		}
+
+		simplify_path(result, elevation_profile, world_scale, tolerance);
+		auto output_file =
+			get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
+				cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
+		encode(output_file.get(), lu, world_scale, domain, result, std::data(elevation_profile));
+	}
 
 	void print_help()
 	{
@@ -87,6 +706,39 @@ Supported options are
 +----------------------+---------------+----------------------------------------------------+
 | Option               | Default value | Description                                        |
 +======================+===============+====================================================+
+| mode=mode            | route         | Selects what to compute. Supported modes are       |
+|                      |               | - route - the cheapest route between origin and    |
+|                      |               |         destination                                |
+|                      |               | - reachable_area - the area that can be reached    |
+|                      |               |         from origin within max_cost. The area is   |
+|                      |               |         written to mask_file, and its boundary is  |
+|                      |               |         encoded according to output_format.        |
+|                      |               | - compile_edge_weights - evaluates the cost of     |
+|                      |               |         every edge in the search lattice using all |
+|                      |               |         CPU cores, and stores the result in        |
+|                      |               |         edge_weights. origin is not used.          |
+|                      |               | - source_partition - finds which of the points in  |
+|                      |               |         sources is cheapest to reach each pixel    |
+|                      |               |         from, using a single search, and writes    |
+|                      |               |         label_file and cost_file. origin is not    |
+|                      |               |         used.                                      |
+|                      |               | - compile_arc_flags - splits the cost map into     |
+|                      |               |         regions of region_size pixels, runs a      |
+|                      |               |         backward search from every lattice node on |
+|                      |               |         the region boundaries, and stores which    |
+|                      |               |         edges are on a cheapest route into each    |
+|                      |               |         region in arc_flags. origin is not used.   |
+|                      |               |         There are about                            |
+|                      |               |         50*width*height/region_size boundary       |
+|                      |               |         nodes, and each search covers the whole    |
+|                      |               |         cost map, so this is only practical for    |
+|                      |               |         small maps. The flags take                 |
+|                      |               |         64*width*height*region_count bytes, where  |
+|                      |               |         region_count is                            |
+|                      |               |         width*height/region_size^2, and the edge   |
+|                      |               |         costs another 4 KiB per pixel. See         |
+|                      |               |         max_arc_flag_memory.                       |
++----------------------+---------------+----------------------------------------------------+
 | origin=(x,y)         | *mandatory*   | Sets the starting point of the path                |
 +----------------------+---------------+----------------------------------------------------+
 | destination=(x,y)    | *mandatory*   | Sets the final point of the path                   |
@@ -102,6 +754,28 @@ Supported options are
 |                      |               | it is to travel in a particular direction. This    |
 |                      |               | options only affects RGBA input data.              |
 +----------------------+---------------+----------------------------------------------------+
+| cost_expr=expression | *none*        | Replaces the built-in cost formula, together with  |
+|                      |               | friction_strength and wind_strength. The cost of   |
+|                      |               | a step is computed from the variables              |
+|                      |               | - dx, dy, and dz - the step, in world units        |
+|                      |               | - elevation - the elevation at the midpoint of the |
+|                      |               |         step, in world units                       |
+|                      |               | - friction, wind_x, and wind_y - the channels of   |
+|                      |               |         the cost map at the midpoint of the step   |
+|                      |               | using numbers, + - * / ^, the comparisons          |
+|                      |               | < <= > >= == != (1 if true, otherwise 0), and the  |
+|                      |               | functions sqrt, abs, exp, log, min, max, and       |
+|                      |               | select(condition, if_true, if_false). The cost     |
+|                      |               | must not be negative. Example:                     |
+|                      |               |     friction*sqrt(dx^2 + dy^2 + dz^2)              |
+|                      |               |         + select(dz > 0, 2*dz, 0)                  |
+|                      |               | The expression is compiled when the program        |
+|                      |               | starts, and evaluated for all neighbours of a node |
+|                      |               | at once. An expression may cost differently in     |
+|                      |               | each direction, so it cannot be combined with      |
+|                      |               | sweep, route_cache, edge_weights, alternatives, or |
+|                      |               | arc_flags.                                         |
++----------------------+---------------+----------------------------------------------------+
 | cost_map=file.exr    | *mandatory*   | The image file that contains the cost map. A       |
 |                      |               | grayscale image is used as a pure heighmap. In     |
 |                      |               | this case the "friction" will be constant, and     |
@@ -112,6 +786,51 @@ Supported options are
 |                      |               | - blue is the x component of the wind              |
 |                      |               | - alpha is the y component of the wind             |
 +----------------------+---------------+----------------------------------------------------+
+| cost_map_loading=    | complete      | Selects when the search starts                     |
+|   mode               |               | - complete - after the entire cost map has been    |
+|                      |               |         loaded                                     |
+|                      |               | - progressive - right away. The cost map is loaded |
+|                      |               |         on a separate thread, starting with the    |
+|                      |               |         rows around origin, and the search waits   |
+|                      |               |         only when it reaches rows that have not    |
+|                      |               |         been loaded yet. This shortens the time to |
+|                      |               |         the first route on large maps. Only route  |
+|                      |               |         mode is supported, and it cannot be        |
+|                      |               |         combined with edge_weights, route_cache,   |
+|                      |               |         time_budget, sweep, alternatives,          |
+|                      |               |         jump_block_size, arc_flags, or             |
+|                      |               |         phase_times.                               |
+|                      |               |         friction_threshold waits for the entire    |
+|                      |               |         cost map.                                  |
+|                      |               | - tiled - by worker processes, one tile at a time. |
+|                      |               |         No process loads the entire cost map. The  |
+|                      |               |         workers compute the costs between nodes on |
+|                      |               |         the tile edges, and the route through      |
+|                      |               |         these nodes is then refined within each    |
+|                      |               |         tile. The route is only optimal up to the  |
+|                      |               |         spacing of the boundary nodes. Only route  |
+|                      |               |         mode is supported, and it cannot be        |
+|                      |               |         combined with edge_weights, route_cache,   |
+|                      |               |         time_budget, sweep, alternatives,          |
+|                      |               |         waypoints, jump_block_size,                |
+|                      |               |         passability_mask, arc_flags,               |
+|                      |               |         search_bounds, max_cost, or phase_times.   |
++----------------------+---------------+----------------------------------------------------+
+| tile_size=n          | 1024          | tiled only. The width and height of a tile.        |
++----------------------+---------------+----------------------------------------------------+
+| tile_overlap=n       | 64            | tiled only. How far outside its tile a route       |
+|                      |               | within a tile may go.                              |
++----------------------+---------------+----------------------------------------------------+
+| boundary_spacing=n   | 16            | tiled only. The distance between the nodes on tile |
+|                      |               | edges, where routes may cross from one tile to     |
+|                      |               | another. A smaller spacing gives cheaper routes,   |
+|                      |               | but each node needs its own search within the      |
+|                      |               | tile, and the costs between all nodes of a tile    |
+|                      |               | are kept by the coordinating process.              |
++----------------------+---------------+----------------------------------------------------+
+| worker_count=n       | *number of    | tiled only. The number of worker processes that    |
+|                      |   cores*      | run at the same time.                              |
++----------------------+---------------+----------------------------------------------------+
 | output_format=fmt    | *mandatory*   | Selects how to export serialize the resulting      |
 |                      |               | path. Supported formats are                        |
 |                      |               | - json - exports the result as well as scaling     |
@@ -127,6 +846,195 @@ Supported options are
 |                      |               |         you want to import the path into some kind |
 |                      |               |         of graphics software such as Inkscape or   |
 |                      |               |         Blender.                                   |
+|                      |               | - bin - saves the path in a binary format. The     |
+|                      |               |         file starts with an 80 byte header:        |
+|                      |               |         "CHRTPATH", format version (u32), header   |
+|                      |               |         size (u32), number of nodes n (u64),       |
+|                      |               |         domain width and height (i64), x, y and z  |
+|                      |               |         scaling factors (f64), and the length unit |
+|                      |               |         (16 byte NUL-padded string). The header is |
+|                      |               |         followed by the columns x, y, z, and the   |
+|                      |               |         integrated cost, each stored as n f64      |
+|                      |               |         values. All values are little-endian.      |
+|                      |               |         Coordinates are stored unscaled, like in   |
+|                      |               |         the json format. This is the fastest       |
+|                      |               |         format to import into Blender.             |
++----------------------+---------------+----------------------------------------------------+
+| max_cost=C           | inf           | Gives up when the integrated cost exceeds C. Use   |
+|                      |               | this to make queries to targets that cannot be     |
+|                      |               | reached fail early.                                |
++----------------------+---------------+----------------------------------------------------+
+| search_bounds=       | *cost map*    | Restricts the search to the pixels with            |
+|   (x0,y0,x1,y1)      |               | x0 <= x < x1 and y0 <= y < y1. Both origin and     |
+|                      |               | destination must be within the bounds.             |
++----------------------+---------------+----------------------------------------------------+
+| sources=             | *none*        | source_partition only. The points to partition the |
+|   ((x,y),(x,y),...)  |               | cost map between. Each source is labeled with its  |
+|                      |               | index in the list, starting from zero.             |
++----------------------+---------------+----------------------------------------------------+
+| label_file=file.exr  | *none*        | source_partition only. The image file to write the |
+|                      |               | label of the cheapest source of every pixel to,    |
+|                      |               | using the Y channel. Pixels that cannot be reached |
+|                      |               | within max_cost are set to -1.                     |
++----------------------+---------------+----------------------------------------------------+
+| cost_file=file.exr   | *none*        | source_partition only. The image file to write the |
+|                      |               | cost of reaching every pixel from its cheapest     |
+|                      |               | source to, using the Y channel. Pixels that cannot |
+|                      |               | be reached within max_cost are set to infinity.    |
++----------------------+---------------+----------------------------------------------------+
+| mask_file=file.exr   | *none*        | reachable_area only. The image file to write the   |
+|                      |               | reachable area to. The image has the same size as  |
+|                      |               | the cost map, and uses the Y channel.              |
++----------------------+---------------+----------------------------------------------------+
+| mask_type=type       | binary        | reachable_area only. Selects what to store in      |
+|                      |               | mask_file                                          |
+|                      |               | - binary - 1 for reachable pixels, otherwise 0     |
+|                      |               | - cost - the integrated cost for reachable pixels, |
+|                      |               |         otherwise infinity                         |
++----------------------+---------------+----------------------------------------------------+
+| route_cache=dir      | *none*        | route only. Enables caching of the shortest-path   |
+|                      |               | tree towards destination in dir. The first query   |
+|                      |               | computes the tree for every origin and stores it.  |
+|                      |               | Later queries with the same destination, cost map  |
+|                      |               | and parameters only walk the stored tree from      |
+|                      |               | origin. This requires the costs to be symmetric,   |
+|                      |               | which is the case for the built-in cost model.     |
++----------------------+---------------+----------------------------------------------------+
+| time_budget=T        | *none*        | route only. Returns the best route found within T  |
+|                      |               | seconds, instead of the cheapest one. The search   |
+|                      |               | starts with an inflated A* heuristic and tightens  |
+|                      |               | it while there is time left. The first route is    |
+|                      |               | always completed. The guaranteed bound of how much |
+|                      |               | more expensive the route is, compared to the       |
+|                      |               | cheapest one, is written to stderr.                |
++----------------------+---------------+----------------------------------------------------+
+| heuristic_weight=w   | 3             | The initial A* heuristic weight when time_budget   |
+|                      |               | is used. The first route costs at most w times as  |
+|                      |               | much as the cheapest one.                          |
++----------------------+---------------+----------------------------------------------------+
+| sweep=file           | *none*        | route only. Finds the cheapest route for every     |
+|                      |               | combination of parameters in file, using all CPU   |
+|                      |               | cores. Each line in file lists the values to try   |
+|                      |               | for one parameter, separated by whitespace, as in  |
+|                      |               |     friction_strength=0.01 0.02 0.05               |
+|                      |               |     wind_strength=(1,1) (2,0.5)                    |
+|                      |               | world_scale, friction_strength, and wind_strength  |
+|                      |               | can be swept. Other parameters are taken from the  |
+|                      |               | command line. The results are written as json to   |
+|                      |               | output_file, with the parameters, cost, length,    |
+|                      |               | and path of each combination. output_format is not |
+|                      |               | used.                                              |
++----------------------+---------------+----------------------------------------------------+
+| waypoints=           | *none*        | route only. Points to visit, in order, between     |
+|   ((x,y),(x,y),...)  |               | origin and destination. The legs between the       |
+|                      |               | points are solved in parallel, and the result is   |
+|                      |               | one path whose integrated cost runs across all     |
+|                      |               | legs. max_cost applies to the whole route.         |
++----------------------+---------------+----------------------------------------------------+
+| alternatives=k       | *none*        | route only. Finds up to k different routes, where  |
+|                      |               | the first one is the cheapest. The alternatives    |
+|                      |               | are taken from one search from origin and one      |
+|                      |               | search from destination, so k routes cost about    |
+|                      |               | twice as much as a single route. Each route is     |
+|                      |               | written as a separate path in output_format.       |
++----------------------+---------------+----------------------------------------------------+
+| max_stretch=s        | 0.25          | alternatives only. An alternative may cost at most |
+|                      |               | 1 + s times as much as the cheapest route.         |
++----------------------+---------------+----------------------------------------------------+
+| max_overlap=o        | 0.5           | alternatives only. The largest share of the cost   |
+|                      |               | of an alternative that may be spent on parts of    |
+|                      |               | routes found earlier.                              |
++----------------------+---------------+----------------------------------------------------+
+| passability_mask=    | *none*        | An image file that marks pixels that cannot be     |
+|   file.exr           |               | entered. Pixels where passability_channel is zero  |
+|                      |               | are blocked. The image must have the same size as  |
+|                      |               | the cost map. Blocked pixels are skipped before    |
+|                      |               | their cost is evaluated, which makes maps with     |
+|                      |               | large blocked areas faster to search. The file     |
+|                      |               | written by reachable_area can be used as a mask.   |
++----------------------+---------------+----------------------------------------------------+
+| passability_channel= | Y             | The channel in passability_mask to use. To use an  |
+|   name               |               | extra channel in the cost map, give the cost map   |
+|                      |               | as passability_mask, and the name of the channel.  |
++----------------------+---------------+----------------------------------------------------+
+| friction_threshold=t | *none*        | Blocks all pixels where the friction, before       |
+|                      |               | friction_strength is applied, is at least t. Can   |
+|                      |               | be combined with passability_mask.                 |
++----------------------+---------------+----------------------------------------------------+
+| jump_block_size=n    | *none*        | route only. Splits the cost map into blocks of     |
+|                      |               | n x n pixels, and lets the search cross blocks     |
+|                      |               | where all pixels have the same values along        |
+|                      |               | straight lines, instead of visiting every point in |
+|                      |               | between. This is much faster on flat terrain, but  |
+|                      |               | the route may be slightly more expensive, since it |
+|                      |               | can only turn near block edges. Cannot be          |
+|                      |               | combined with sweep. Ignored by route_cache,       |
+|                      |               | time_budget, and alternatives.                     |
++----------------------+---------------+----------------------------------------------------+
+| lattice=type         | regular       | route only. Selects the search lattice             |
+|                      |               | - regular - four nodes per pixel in each direction |
+|                      |               | - adaptive - a quadtree where cells are split      |
+|                      |               |         until the cost map is smooth within them,  |
+|                      |               |         according to refinement_threshold. Nodes   |
+|                      |               |         are only placed on the boundaries of the   |
+|                      |               |         cells, and every pair of nodes on the same |
+|                      |               |         cell is connected by a straight edge. On   |
+|                      |               |         smooth maps, this uses far fewer nodes,    |
+|                      |               |         while the route is almost as cheap. Cannot |
+|                      |               |         be combined with search_bounds,            |
+|                      |               |         edge_weights, passability, or any other    |
+|                      |               |         route option except max_cost, cost_expr,   |
+|                      |               |         simplify, and phase_times.                 |
++----------------------+---------------+----------------------------------------------------+
+| refinement_          | 0.05          | adaptive lattice only. A cell is split unless the  |
+|   threshold=t        |               | friction and the wind vary by at most t times      |
+|                      |               | their largest magnitude within it, and the slope,  |
+|                      |               | in world units, varies by at most t.               |
++----------------------+---------------+----------------------------------------------------+
+| max_cell_size=n      | 64            | adaptive lattice only. The size of the largest     |
+|                      |               | cells, in pixels. Must be a power of two.          |
++----------------------+---------------+----------------------------------------------------+
+| edge_weights=file    | *none*        | A file with edge weights, written by               |
+|                      |               | compile_edge_weights. The file must have been      |
+|                      |               | compiled from the same cost map, world_scale,      |
+|                      |               | friction_strength and wind_strength. In the other  |
+|                      |               | modes, the weights are read from the file instead  |
+|                      |               | of being evaluated during the search. The file is  |
+|                      |               | about 1 KiB per pixel.                             |
++----------------------+---------------+----------------------------------------------------+
+| arc_flags=file       | *none*        | A file with arc flags, written by                  |
+|                      |               | compile_arc_flags. The file must have been         |
+|                      |               | computed from the same cost map, parameters,       |
+|                      |               | edge_weights, and passability_mask. In route mode, |
+|                      |               | the search skips edges that are not on a cheapest  |
+|                      |               | route into the region of destination, which gives  |
+|                      |               | the same route while settling far fewer nodes.     |
+|                      |               | Cannot be combined with search_bounds or           |
+|                      |               | jump_block_size. Ignored by route_cache,           |
+|                      |               | time_budget, alternatives, and the adaptive        |
+|                      |               | lattice. The file is 64 bytes per pixel and        |
+|                      |               | region.                                            |
++----------------------+---------------+----------------------------------------------------+
+| region_size=n        | 64            | compile_arc_flags only. The size of the regions,   |
+|                      |               | in pixels. Smaller regions prune more edges, but   |
+|                      |               | make the file larger and take longer to compute.   |
++----------------------+---------------+----------------------------------------------------+
+| max_arc_flag_memory= | 4             | compile_arc_flags only. The largest amount of      |
+| size                 |               | memory, in GiB, that compile_arc_flags may use.    |
+|                      |               | If the flags, edge costs, and search state need    |
+|                      |               | more, compile_arc_flags fails before starting.     |
++----------------------+---------------+----------------------------------------------------+
+| phase_times=file     | *none*        | route only. Writes the wall time, in seconds, of   |
+|                      |               | loading the cost map, setting up the search, the   |
+|                      |               | search, and writing the output to file, one phase  |
+|                      |               | per line.                                          |
++----------------------+---------------+----------------------------------------------------+
+| simplify=tolerance   | 0             | Removes route nodes that are within tolerance, in  |
+|                      |               | length_unit, from the polyline through the         |
+|                      |               | remaining nodes, using Douglas-Peucker in world    |
+|                      |               | coordinates including elevation. The remaining     |
+|                      |               | nodes keep their integrated_cost. 0 keeps all      |
+|                      |               | nodes.                                             |
 +----------------------+---------------+----------------------------------------------------+
 | length_unit=unit     | *mandatory*   | Sets the unit of length for world_scale. Valid     |
 |                      |               | units are                                          |
@@ -144,6 +1052,7 @@ Supported options are
 
 int main(int argc, char** argv) try
 {
+	cheapest_route::phase_timer timer;
 	cheapest_route::command_line cmdline{argc, argv};
 	if(std::size(cmdline) == 0)
 	{ throw std::runtime_error{"Try cheapest_route help="}; }
@@ -157,8 +1066,11 @@ int main(int argc, char** argv) try
 		return 0;
 	}
 
-	cheapest_route::from<int64_t> origin_loc{cmdline["origin"]};
-	cheapest_route::to<int64_t> dest_loc{cmdline["destination"]};
+	auto const mode = get_or(cmdline, "mode", std::string{"route"});
+	if(mode != "route" && mode != "reachable_area" && mode != "compile_edge_weights" && mode != "source_partition"
+		&& mode != "compile_arc_flags")
+	{ throw std::runtime_error{"Unsupported mode"}; }
+
 	auto const world_scale = get_or(cmdline, "world_scale", cheapest_route::scaling_factors{1.0f, 1.0f, 1.0f});
 
 	auto const friction_strength = get_or(cmdline, "friction_strength", 1.0f);
@@ -168,30 +1080,183 @@ int main(int argc, char** argv) try
 	auto const wind_strength = get_or(cmdline, "wind_strength",
 									  cheapest_route::vec<double, 2, cheapest_route::quantity_type::vector>{1.0, 1.0});
 
+	cheapest_route::check_cost_expression_options(cmdline);
+	auto const cost_expr = cmdline.contains("cost_expr") ?
+		std::optional{cheapest_route::cost_expression{cmdline["cost_expr"]}} : std::nullopt;
+	auto const expression = cost_expr.has_value() ? &*cost_expr : nullptr;
+
 	std::filesystem::path cost_map_path{cmdline["cost_map"]};
-	auto const cost_map = cheapest_route::load_image(cost_map_path);
+	auto const cost_map_loading = get_or(cmdline, "cost_map_loading", std::string{"complete"});
+	if(cost_map_loading != "complete" && cost_map_loading != "progressive" && cost_map_loading != "tiled")
+	{ throw std::runtime_error{"Unsupported cost map loading"}; }
+
+	auto const lattice = cheapest_route::get_lattice(cmdline);
+
+	if(cost_map_loading == "progressive")
+	{
+		cheapest_route::find_route_progressively(cmdline, cost_map_path, world_scale, friction_strength, wind_strength,
+			expression);
+		return 0;
+	}
+
+	if(cost_map_loading == "tiled")
+	{
+		if(cmdline.contains("tile_task"))
+		{ cheapest_route::solve_tile(cmdline, cost_map_path, world_scale, friction_strength, wind_strength, expression); }
+		else
+		{ cheapest_route::find_route_tiled(cmdline, cost_map_path, world_scale); }
+		return 0;
+	}
+
+	auto const cost_map = cheapest_route::sampled_cost_map{cheapest_route::load_image(cost_map_path)};
+	timer.end_phase("load");
 	auto const domain = cheapest_route::search_domain{
 		static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
 	};
 
+	auto const cost_function =
+		cheapest_route::cost_function{cost_map.pixels(), world_scale, friction_strength, wind_strength, expression};
+	auto const batch_cost = cheapest_route::make_batch_cost_function(cost_function);
+
+	auto const edge_weights_path = get_if<std::filesystem::path>(cmdline, "edge_weights");
+	if(mode == "compile_edge_weights")
+	{
+		if(!edge_weights_path.has_value())
+		{ throw std::runtime_error{"compile_edge_weights requires edge_weights"}; }
+
+		auto const weights = compile_edge_weights(domain, cost_function);
+		store(weights.view(), edge_weights_key(cost_function), *edge_weights_path);
+		return 0;
+	}
+
+	auto const edge_weights = edge_weights_path.has_value() ?
+		std::optional{cheapest_route::load_edge_weights(*edge_weights_path, edge_weights_key(cost_function))}
+		: std::nullopt;
+
+	auto const passability = load_passability(cmdline, cost_map.pixels());
+	auto const passability_view = passability.has_value() ? std::optional{passability->view()} : std::nullopt;
+	auto const uniform_blocks = find_uniform_blocks(cmdline, cost_map.pixels());
+	auto const uniform_blocks_view = uniform_blocks.has_value() ?
+		std::optional{uniform_blocks->view()} : std::nullopt;
+
+	auto const arc_flags_path = get_if<std::filesystem::path>(cmdline, "arc_flags");
+	auto const arc_flags = arc_flags_path.has_value() && mode == "route" ?
+		std::optional{cheapest_route::load_arc_flags(*arc_flags_path,
+			arc_flags_key(cost_function, passability_view.has_value() ? &*passability_view : nullptr))}
+		: std::nullopt;
+
+	auto const search_options = cheapest_route::search_options{
+		.max_cost = get_or(cmdline, "max_cost", std::numeric_limits<double>::infinity()),
+		.bounds = get_if<cheapest_route::search_bounds>(cmdline, "search_bounds"),
+		.edge_weights = edge_weights.has_value() ? &edge_weights->view() : nullptr,
+		.passability = passability_view.has_value() ? &*passability_view : nullptr,
+		.uniform_blocks = uniform_blocks_view.has_value() ? &*uniform_blocks_view : nullptr,
+		.batch_cost = expression != nullptr ? &batch_cost : nullptr,
+		.arc_flags = arc_flags.has_value() ? &arc_flags->view() : nullptr
+	};
+
+	if(mode == "compile_arc_flags")
+	{
+		if(!arc_flags_path.has_value())
+		{ throw std::runtime_error{"compile_arc_flags requires arc_flags"}; }
+
+		auto const region_size = get_or(cmdline, "region_size", 64.0);
+		if(!(region_size >= 1.0) || region_size != std::floor(region_size))
+		{ throw std::runtime_error{"The region size must be a positive integer"}; }
+
+		// The flags alone take 4 bytes per lattice node and region, and there are 16 lattice nodes per pixel
+		auto const max_memory = get_or(cmdline, "max_arc_flag_memory", 4.0);
+		auto const thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+		auto const required_memory =
+			arc_flag_memory_usage(domain, static_cast<int64_t>(region_size), thread_count)/(1024.0*1024.0*1024.0);
+		if(required_memory > max_memory)
+		{
+			throw std::runtime_error{std::string{"compile_arc_flags would need "}.append(std::to_string(required_memory))
+				.append(" GiB of memory, which is more than max_arc_flag_memory. Use a larger region_size, or "
+					"raise max_arc_flag_memory.")};
+		}
+
+		auto const flags = compute_arc_flags(domain,
+			static_cast<int64_t>(region_size),
+			cost_function,
+			search_options,
+			thread_count);
+		store(flags.view(), arc_flags_key(cost_function, search_options.passability), *arc_flags_path);
+		return 0;
+	}
+
+	if(mode == "source_partition")
+	{
+		compute_source_partition(cmdline, domain, cost_function, search_options);
+		return 0;
+	}
+
+	cheapest_route::from<int64_t> origin_loc{cmdline["origin"]};
+
+	if(mode == "reachable_area")
+	{
+		compute_reachable_area(cmdline, origin_loc, cost_map.pixels(), cost_function, search_options);
+		return 0;
+	}
+
+	cheapest_route::to<int64_t> dest_loc{cmdline["destination"]};
+	if(auto const grid_file = get_if<std::filesystem::path>(cmdline, "sweep"); grid_file.has_value())
+	{
+		run_parameter_sweep(cmdline, *grid_file, origin_loc, dest_loc, cost_map.pixels(),
+			cheapest_route::sweep_parameters{world_scale, friction_strength, wind_strength}, search_options);
+		return 0;
+	}
+
+	if(cmdline.contains("alternatives"))
+	{
+		write_alternative_routes(cmdline, origin_loc, dest_loc, cost_map.pixels(), cost_function, search_options);
+		return 0;
+	}
+
 	cheapest_route::path_encoder const encode{cmdline["output_format"]};
 	cheapest_route::length_unit const lu{cmdline["length_unit"]};
+	auto const simplify_tolerance = cheapest_route::get_simplify_tolerance(cmdline);
 
-	auto const result = search(origin_loc,
-		dest_loc,
-		domain,
-		cheapest_route::cost_function{cost_map.pixels(), world_scale, friction_strength, wind_strength});
+	auto const route_cache = get_if<std::filesystem::path>(cmdline, "route_cache");
+	if(route_cache.has_value() && cmdline.contains("time_budget"))
+	{ throw std::runtime_error{"route_cache cannot be combined with time_budget"}; }
+
+	auto const waypoints = get_if<cheapest_route::waypoint_list>(cmdline, "waypoints");
+	if(waypoints.has_value() && (route_cache.has_value() || cmdline.contains("time_budget")))
+	{ throw std::runtime_error{"waypoints cannot be combined with route_cache or time_budget"}; }
+
+	timer.end_phase("setup");
+	auto result = lattice == "adaptive" ?
+		find_route_adaptive(cmdline, origin_loc, dest_loc, cost_map.pixels(), cost_function, search_options)
+		: route_cache.has_value() ?
+		find_route_using_cache(*route_cache, origin_loc, dest_loc, cost_function, search_options)
+		: waypoints.has_value() ?
+			find_route_via_waypoints(*waypoints, origin_loc, dest_loc, domain, cost_function, search_options)
+		: cmdline.contains("time_budget") ?
+			find_route_anytime(get_or(cmdline, "time_budget", 0.0),
+				get_or(cmdline, "heuristic_weight", 3.0),
+				origin_loc, dest_loc, domain, cost_function, search_options)
+		: search(origin_loc, dest_loc, domain, cost_function, search_options);
+	timer.end_phase("search");
 
 	auto output_file =
 		get_or<cheapest_route::output_file>(get_if<std::filesystem::path>(cmdline, "output_file"),
 			cheapest_route::output_file{cheapest_route::std_output_stream{stdout}});
 
-	std::vector<float> elevation_profile;
-	std::ranges::transform(result, std::back_inserter(elevation_profile),[pixels = cost_map.pixels()](auto const& item) {
-		return interp(pixels, item.loc.value()).elevation();
-	});
-
+	auto elevation_profile = get_elevation_profile(cost_map.pixels(), result);
+	simplify_path(result, elevation_profile, world_scale, simplify_tolerance);
 	encode(output_file.get(), lu, world_scale, domain, result, std::data(elevation_profile));
+
+	if(auto const phase_times = get_if<std::filesystem::path>(cmdline, "phase_times"); phase_times.has_value())
+	{
+		fflush(output_file.get());
+		timer.end_phase("output");
+
+		cheapest_route::output_file const dest{*phase_times};
+		if(dest.get() == nullptr)
+		{ throw std::runtime_error{std::string{"Failed to create "}.append(phase_times->string())}; }
+		write(dest.get(), timer);
+	}
 }
 catch(std::exception const& err)
 {
@@ -0,0 +1,445 @@
+//@	{"target":{"name":"cost_expression.o"}}
+
+#include "./cost_expression.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+	using opcode = cheapest_route::cost_expression::opcode;
+	using instruction = cheapest_route::cost_expression::instruction;
+
+	constexpr std::array<std::string_view, cheapest_route::cost_variable_count> variable_names{
+		"dx", "dy", "dz", "elevation", "friction", "wind_x", "wind_y"
+	};
+
+	struct function_info
+	{
+		std::string_view name;
+		opcode op;
+		size_t arg_count;
+	};
+
+	constexpr std::array functions{
+		function_info{"sqrt", opcode::sqrt, 1},
+		function_info{"abs", opcode::abs, 1},
+		function_info{"exp", opcode::exp, 1},
+		function_info{"log", opcode::log, 1},
+		function_info{"min", opcode::min, 2},
+		function_info{"max", opcode::max, 2},
+		function_info{"select", opcode::select, 3}
+	};
+
+	bool is_identifier_char(char ch)
+	{ return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_'; }
+
+	// Recursive descent parser that emits the bytecode in postfix order
+	class parser
+	{
+	public:
+		explicit parser(std::string_view source,
+			std::vector<instruction>& code,
+			std::vector<double>& constants):
+			m_source{source},
+			m_code{code},
+			m_constants{constants}
+		{}
+
+		uint32_t parse()
+		{
+			parse_comparison();
+			skip_whitespace();
+			if(m_pos != std::size(m_source))
+			{ throw_error("Unexpected character"); }
+			return m_used_variables;
+		}
+
+	private:
+		void parse_comparison()
+		{
+			parse_sum();
+			skip_whitespace();
+			static constexpr std::array<std::pair<std::string_view, opcode>, 6> operators{
+				std::pair{"<=", opcode::less_equal},
+				std::pair{">=", opcode::greater_equal},
+				std::pair{"==", opcode::equal},
+				std::pair{"!=", opcode::not_equal},
+				std::pair{"<", opcode::less},
+				std::pair{">", opcode::greater}
+			};
+
+			for(auto const& item : operators)
+			{
+				if(m_source.substr(m_pos).starts_with(item.first))
+				{
+					m_pos += std::size(item.first);
+					parse_sum();
+					emit(item.second, 0, 2);
+					return;
+				}
+			}
+		}
+
+		void parse_sum()
+		{
+			parse_product();
+			while(true)
+			{
+				skip_whitespace();
+				if(accept('+'))
+				{
+					parse_product();
+					emit(opcode::add, 0, 2);
+				}
+				else
+				if(accept('-'))
+				{
+					parse_product();
+					emit(opcode::subtract, 0, 2);
+				}
+				else
+				{ return; }
+			}
+		}
+
+		void parse_product()
+		{
+			parse_unary();
+			while(true)
+			{
+				skip_whitespace();
+				if(accept('*'))
+				{
+					parse_unary();
+					emit(opcode::multiply, 0, 2);
+				}
+				else
+				if(accept('/'))
+				{
+					parse_unary();
+					emit(opcode::divide, 0, 2);
+				}
+				else
+				{ return; }
+			}
+		}
+
+		void parse_unary()
+		{
+			skip_whitespace();
+			if(accept('-'))
+			{
+				parse_unary();
+				emit(opcode::negate, 0, 1);
+				return;
+			}
+			parse_power();
+		}
+
+		void parse_power()
+		{
+			parse_primary();
+			skip_whitespace();
+			if(!accept('^'))
+			{ return; }
+
+			parse_unary();
+			auto const& exponent = m_code.back();
+			if(exponent.op == opcode::push_constant && m_constants[exponent.arg] == 2.0)
+			{
+				m_code.pop_back();
+				--m_depth;
+				emit(opcode::square, 0, 1);
+				return;
+			}
+			emit(opcode::power, 0, 2);
+		}
+
+		void parse_primary()
+		{
+			skip_whitespace();
+			if(accept('('))
+			{
+				parse_comparison();
+				expect(')');
+				return;
+			}
+
+			if(m_pos == std::size(m_source))
+			{ throw_error("Unexpected end of expression"); }
+
+			if(auto const ch = m_source[m_pos]; (ch >= '0' && ch <= '9') || ch == '.')
+			{
+				double value{};
+				auto const begin = std::data(m_source) + m_pos;
+				auto const res = std::from_chars(begin, std::data(m_source) + std::size(m_source), value);
+				if(res.ec != std::errc{})
+				{ throw_error("Invalid number"); }
+				m_pos += static_cast<size_t>(res.ptr - begin);
+				m_constants.push_back(value);
+				emit(opcode::push_constant, static_cast<uint32_t>(std::size(m_constants) - 1), 0);
+				return;
+			}
+
+			auto const name = parse_identifier();
+			if(auto const i = std::ranges::find(variable_names, name); i != std::end(variable_names))
+			{
+				auto const var = static_cast<uint32_t>(i - std::begin(variable_names));
+				m_used_variables |= 1u << var;
+				emit(opcode::load, var, 0);
+				return;
+			}
+
+			auto const i = std::ranges::find(functions, name, &function_info::name);
+			if(i == std::end(functions))
+			{ throw_error(std::string{"Unknown name "}.append(name)); }
+
+			skip_whitespace();
+			expect('(');
+			for(size_t k = 0; k != i->arg_count; ++k)
+			{
+				if(k != 0)
+				{ expect(','); }
+				parse_comparison();
+				skip_whitespace();
+			}
+			expect(')');
+			emit(i->op, 0, i->arg_count);
+		}
+
+		std::string_view parse_identifier()
+		{
+			auto const begin = m_pos;
+			while(m_pos != std::size(m_source) && is_identifier_char(m_source[m_pos]))
+			{ ++m_pos; }
+
+			if(begin == m_pos)
+			{ throw_error("Unexpected character"); }
+
+			return m_source.substr(begin, m_pos - begin);
+		}
+
+		void skip_whitespace()
+		{
+			while(m_pos != std::size(m_source) && (m_source[m_pos] == ' ' || m_source[m_pos] == '\t'))
+			{ ++m_pos; }
+		}
+
+		bool accept(char ch)
+		{
+			if(m_pos != std::size(m_source) && m_source[m_pos] == ch)
+			{
+				++m_pos;
+				return true;
+			}
+			return false;
+		}
+
+		void expect(char ch)
+		{
+			skip_whitespace();
+			if(!accept(ch))
+			{ throw_error(std::string{"Expected "} + ch); }
+		}
+
+		// Appends an instruction that pops arg_count values and pushes the result
+		void emit(opcode op, uint32_t arg, size_t arg_count)
+		{
+			m_code.push_back(instruction{op, arg});
+			m_depth = m_depth + 1 - arg_count;
+			if(m_depth > cheapest_route::cost_expression::max_stack_depth)
+			{ throw std::runtime_error{"Cost expression is too deeply nested"}; }
+		}
+
+		[[noreturn]] void throw_error(std::string const& message) const
+		{
+			throw std::runtime_error{std::string{message}
+				.append(" at position ").append(std::to_string(m_pos)).append(" in cost expression")};
+		}
+
+		std::string_view m_source;
+		size_t m_pos{0};
+		size_t m_depth{0};
+		uint32_t m_used_variables{0};
+		std::vector<instruction>& m_code;
+		std::vector<double>& m_constants;
+	};
+
+	template<size_t LaneCount, class Op>
+	void apply(std::array<double, LaneCount>& a, Op op)
+	{
+		for(size_t k = 0; k != LaneCount; ++k)
+		{ a[k] = op(a[k]); }
+	}
+
+	template<size_t LaneCount, class Op>
+	void apply(std::array<double, LaneCount>& a, std::array<double, LaneCount> const& b, Op op)
+	{
+		for(size_t k = 0; k != LaneCount; ++k)
+		{ a[k] = op(a[k], b[k]); }
+	}
+
+	template<size_t LaneCount>
+	void run(std::span<instruction const> code,
+		std::span<double const> constants,
+		std::array<std::array<double, LaneCount>, cheapest_route::cost_variable_count> const& inputs,
+		std::array<double, LaneCount>& result)
+	{
+		std::array<std::array<double, LaneCount>, cheapest_route::cost_expression::max_stack_depth> stack;
+		size_t top = 0;
+		for(auto const& item : code)
+		{
+			switch(item.op)
+			{
+				case opcode::push_constant:
+					std::ranges::fill(stack[top], constants[item.arg]);
+					++top;
+					break;
+
+				case opcode::load:
+					stack[top] = inputs[item.arg];
+					++top;
+					break;
+
+				case opcode::add:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a + b; });
+					--top;
+					break;
+
+				case opcode::subtract:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a - b; });
+					--top;
+					break;
+
+				case opcode::multiply:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a*b; });
+					--top;
+					break;
+
+				case opcode::divide:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a/b; });
+					--top;
+					break;
+
+				case opcode::power:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return std::pow(a, b); });
+					--top;
+					break;
+
+				case opcode::square:
+					apply(stack[top - 1], [](double a) { return a*a; });
+					break;
+
+				case opcode::negate:
+					apply(stack[top - 1], [](double a) { return -a; });
+					break;
+
+				case opcode::less:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a < b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::less_equal:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a <= b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::greater:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a > b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::greater_equal:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a >= b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::equal:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a == b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::not_equal:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a != b ? 1.0 : 0.0; });
+					--top;
+					break;
+
+				case opcode::sqrt:
+					apply(stack[top - 1], [](double a) { return std::sqrt(a); });
+					break;
+
+				case opcode::abs:
+					apply(stack[top - 1], [](double a) { return std::abs(a); });
+					break;
+
+				case opcode::exp:
+					apply(stack[top - 1], [](double a) { return std::exp(a); });
+					break;
+
+				case opcode::log:
+					apply(stack[top - 1], [](double a) { return std::log(a); });
+					break;
+
+				case opcode::min:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return b < a ? b : a; });
+					--top;
+					break;
+
+				case opcode::max:
+					apply(stack[top - 2], stack[top - 1], [](double a, double b) { return a < b ? b : a; });
+					--top;
+					break;
+
+				case opcode::select:
+				{
+					auto& condition = stack[top - 3];
+					auto const& if_true = stack[top - 2];
+					auto const& if_false = stack[top - 1];
+					for(size_t k = 0; k != LaneCount; ++k)
+					{ condition[k] = condition[k] != 0.0 ? if_true[k] : if_false[k]; }
+					top -= 2;
+					break;
+				}
+			}
+		}
+		result = stack[0];
+	}
+}
+
+cheapest_route::cost_expression::cost_expression(std::string_view source):
+	m_source{source},
+	m_used_variables{parser{source, m_code, m_constants}.parse()}
+{}
+
+double cheapest_route::cost_expression::evaluate(std::array<double, cost_variable_count> const& inputs) const
+{
+	std::array<std::array<double, 1>, cost_variable_count> lanes;
+	for(size_t k = 0; k != cost_variable_count; ++k)
+	{ lanes[k][0] = inputs[k]; }
+
+	std::array<double, 1> result;
+	run(std::span{m_code}, std::span{m_constants}, lanes, result);
+	return result[0];
+}
+
+void cheapest_route::cost_expression::evaluate(batch_inputs const& inputs, lane_array& result) const
+{ run(std::span{m_code}, std::span{m_constants}, inputs, result); }
+
+void cheapest_route::check_cost_expression_options(command_line const& cmdline)
+{
+	if(!cmdline.contains("cost_expr"))
+	{ return; }
+
+	for(auto const key : symmetric_cost_options)
+	{
+		if(cmdline.contains(key))
+		{
+			throw std::runtime_error{std::string{"cost_expr cannot be combined with "}.append(key)
+				.append(", which requires costs that are the same in both directions")};
+		}
+	}
+}
@@ -0,0 +1,103 @@
+//@	{"dependencies_extra":[{"ref":"./cost_expression.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_COSTEXPRESSION_HPP
+#define CHEAPESTROUTE_COSTEXPRESSION_HPP
+
+#include "./cmdline.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cheapest_route
+{
+	// The inputs to a cost expression. dx, dy, and dz is the step, and elevation is the elevation at
+	// its midpoint, all in world units. friction, wind_x, and wind_y are the channels of the cost
+	// map at the midpoint.
+	enum class cost_variable : uint32_t{dx, dy, dz, elevation, friction, wind_x, wind_y};
+
+	constexpr size_t cost_variable_count = 7;
+
+	// A cost formula, compiled to a stack-based bytecode. Every instruction operates on a batch of
+	// lanes, one per edge, in a loop that the compiler can vectorize.
+	//
+	// The language has numbers, the variables listed in cost_variable, the operators + - * / ^,
+	// comparisons (< <= > >= == !=) that evaluate to 1 or 0, and the functions sqrt, abs, exp,
+	// log, min, max, and select(condition, if_true, if_false).
+	class cost_expression
+	{
+	public:
+		// The number of lanes in a batch. This is the number of neighbours of a lattice node.
+		static constexpr size_t batch_size = 32;
+
+		// The maximum number of intermediate values
+		static constexpr size_t max_stack_depth = 16;
+
+		using lane_array = std::array<double, batch_size>;
+		using batch_inputs = std::array<lane_array, cost_variable_count>;
+
+		explicit cost_expression(std::string_view source);
+
+		std::string const& source() const
+		{ return m_source; }
+
+		bool uses(cost_variable var) const
+		{ return m_used_variables & (1u << static_cast<uint32_t>(var)); }
+
+		double evaluate(std::array<double, cost_variable_count> const& inputs) const;
+
+		// Evaluates all lanes. Lanes that are not used must still hold finite values.
+		void evaluate(batch_inputs const& inputs, lane_array& result) const;
+
+		enum class opcode : uint32_t
+		{
+			push_constant,
+			load,
+			add,
+			subtract,
+			multiply,
+			divide,
+			power,
+			square,
+			negate,
+			less,
+			less_equal,
+			greater,
+			greater_equal,
+			equal,
+			not_equal,
+			sqrt,
+			abs,
+			exp,
+			log,
+			min,
+			max,
+			select
+		};
+
+		struct instruction
+		{
+			opcode op;
+			uint32_t arg;
+		};
+
+	private:
+		std::string m_source;
+		std::vector<instruction> m_code;
+		std::vector<double> m_constants;
+		uint32_t m_used_variables;
+	};
+
+	// Options whose results are only valid if every edge costs the same in both directions. An
+	// expression may read dx, dy, dz, wind_x, and wind_y with their sign, so it may be asymmetric.
+	constexpr std::array<char const*, 4> symmetric_cost_options{"route_cache", "edge_weights", "alternatives",
+		"arc_flags"};
+
+	// Throws if cmdline combines cost_expr with any of symmetric_cost_options
+	void check_cost_expression_options(command_line const& cmdline);
+}
+
+#endif
@@ -0,0 +1,58 @@
+//@	{"target":{"name":"cost_expression.test"}}
+
+#include "./cost_expression.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+	cheapest_route::command_line make_command_line(std::vector<std::string> args)
+	{
+		args.insert(std::begin(args), "cheapest_route");
+		std::vector<char*> argv;
+		for(auto& item : args)
+		{ argv.push_back(std::data(item)); }
+		return cheapest_route::command_line{static_cast<int>(std::size(argv)), std::data(argv)};
+	}
+}
+
+int main()
+{
+	// Going with the wind is cheaper than going against it
+	auto const asymmetric = std::string{"friction*sqrt(dx^2 + dy^2) + max(wind_x*dx, 0)"};
+	cheapest_route::cost_expression const expr{asymmetric};
+	using inputs = std::array<double, cheapest_route::cost_variable_count>;
+	auto const forward = expr.evaluate(inputs{1.0, 0.0, 0.0, 0.0, 1.0, 2.0, 0.0});
+	auto const backward = expr.evaluate(inputs{-1.0, 0.0, 0.0, 0.0, 1.0, 2.0, 0.0});
+	printf("%.8g %.8g\n", forward, backward);
+	assert(forward != backward);
+
+	for(auto const key : cheapest_route::symmetric_cost_options)
+	{
+		auto const cmdline = make_command_line({std::string{"cost_expr="}.append(asymmetric),
+			std::string{key}.append("=file")});
+		try
+		{
+			check_cost_expression_options(cmdline);
+			abort();
+		}
+		catch(std::runtime_error const& err)
+		{ printf("%s\n", err.what()); }
+	}
+
+	// Compiling edge weights requires edge_weights
+	try
+	{
+		check_cost_expression_options(make_command_line({std::string{"cost_expr="}.append(asymmetric),
+			"mode=compile_edge_weights", "edge_weights=file"}));
+		abort();
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+
+	check_cost_expression_options(make_command_line({std::string{"cost_expr="}.append(asymmetric)}));
+	check_cost_expression_options(make_command_line({"route_cache=file", "edge_weights=file"}));
+}
@@ -0,0 +1,62 @@
+#ifndef CHEAPESTROUTE_COSTFUNCTION_HPP
+#define CHEAPESTROUTE_COSTFUNCTION_HPP
+
+#include "./image_loader.hpp"
+#include "./cost_model.hpp"
+#include "./tiled_image.hpp"
+
+#include "lib/memory_layout.hpp"
+#include "pixel_store/image.hpp"
+
+#include <span>
+#include <type_traits>
+
+namespace cheapest_route
+{
+	// The cost map is sampled using the same layout as the search lattice
+	using cost_map_span = std::conditional_t<grid_layout == memory_layout::tiled,
+		tiled_image_span<cost_values const>,
+		pixel_store::image_span<cost_values const>>;
+
+	inline std::span<cost_values const> pixel_storage(pixel_store::image_span<cost_values const> img)
+	{ return std::span{img.data(), static_cast<size_t>(img.width())*img.height()}; }
+
+	class sampled_cost_map
+	{
+	public:
+		using storage_type = std::conditional_t<grid_layout == memory_layout::tiled,
+			tiled_image<cost_values>,
+			image_type>;
+
+		explicit sampled_cost_map(image_type&& src):m_pixels{make_storage(std::move(src))}
+		{}
+
+		cost_map_span pixels() const
+		{ return m_pixels.pixels(); }
+
+		uint32_t width() const
+		{ return m_pixels.width(); }
+
+		uint32_t height() const
+		{ return m_pixels.height(); }
+
+	private:
+		template<class Storage = storage_type>
+		static Storage make_storage(image_type&& src)
+		{
+			if constexpr(std::is_same_v<Storage, image_type>)
+			{ return std::move(src); }
+			else
+			{
+				auto const loaded = std::move(src);
+				return Storage{loaded.pixels()};
+			}
+		}
+
+		storage_type m_pixels;
+	};
+
+	using cost_function = basic_cost_function<cost_map_span>;
+}
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef CHEAPESTROUTE_COSTMODEL_HPP
+#define CHEAPESTROUTE_COSTMODEL_HPP
+
+#include "./cost_values.hpp"
+#include "./cost_expression.hpp"
+#include "./scaling_factors.hpp"
+
+#include "lib/search.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+
+namespace cheapest_route
+{
+	// ImageSpan is any view of cost_values with width(), height(), and operator()(x, y)
+	template<class ImageSpan>
+	cost_values interp(ImageSpan img, vec2f_t loc)
+	{
+		auto const x_0  = static_cast<int64_t>(loc[0]);
+		auto const y_0  = static_cast<int64_t>(loc[1]);
+
+		auto const w = static_cast<int64_t>(img.width());
+		auto const h = static_cast<int64_t>(img.height());
+
+		auto const x_1  = std::min(x_0 + 1, w - 1);
+		auto const y_1  = std::min(y_0 + 1, h - 1);
+
+		auto const z_00 = img(x_0, y_0);
+		auto const z_01 = img(x_0, y_1);
+		auto const z_10 = img(x_1, y_0);
+		auto const z_11 = img(x_1, y_1);
+
+		auto const xi = loc - vec2f_t{static_cast<double>(x_0), static_cast<double>(y_0)};
+
+		auto const z_x0 = (1.0f - static_cast<float>(xi[0])) * z_00 + static_cast<float>(xi[0]) * z_10;
+		auto const z_x1 = (1.0f - static_cast<float>(xi[0])) * z_01 + static_cast<float>(xi[0]) * z_11;
+		return (1.0f - static_cast<float>(xi[1])) * z_x0 + static_cast<float>(xi[1]) * z_x1;
+	}
+
+	template<class ImageSpan>
+	struct basic_cost_function
+	{
+		ImageSpan image;
+		scaling_factors world_scale;
+		float friction_strength;
+		cheapest_route::vec<double, 2, cheapest_route::quantity_type::vector> wind_strength;
+
+		// Replaces the built-in formula, together with friction_strength and wind_strength
+		cost_expression const* expression = nullptr;
+
+		double operator()(from<double> x1, to<double> x2) const
+		{
+			if(expression != nullptr)
+			{ return expression->evaluate(expression_inputs(x1, x2, interp(image, x1.value()))); }
+
+			auto const dx = x2 - x1;
+			auto const c1 = interp(image, x1.value());
+			auto const c2 = interp(image, x2.value());
+
+			auto const dr = world_scale*vec<float, 4>{static_cast<float>(dx[0]),
+				static_cast<float>(dx[1]),
+				c2.elevation() - c1.elevation(),
+				0.0f};
+
+			auto const c = interp(image, midpoint(x2, x1).value());
+			return friction_strength*c.friction()*std::sqrt(dot(dr, dr))
+				+ std::abs(dot(scale(c.wind(), wind_strength), dx));
+		}
+
+		void evaluate_batch(from<double> x1, std::span<to<double> const> x2, std::span<double> costs) const
+		{
+			if(expression == nullptr)
+			{
+				for(size_t k = 0; k != std::size(x2); ++k)
+				{ costs[k] = (*this)(x1, x2[k]); }
+				return;
+			}
+
+			auto const c1 = interp(image, x1.value());
+			cost_expression::batch_inputs inputs{};
+			cost_expression::lane_array result;
+			for(size_t offset = 0; offset < std::size(x2); offset += cost_expression::batch_size)
+			{
+				auto const count = std::min(std::size(x2) - offset, cost_expression::batch_size);
+				for(size_t k = 0; k != count; ++k)
+				{
+					auto const values = expression_inputs(x1, x2[offset + k], c1);
+					for(size_t l = 0; l != cost_variable_count; ++l)
+					{ inputs[l][k] = values[l]; }
+				}
+				expression->evaluate(inputs, result);
+				std::copy_n(std::begin(result), count, std::begin(costs) + static_cast<ptrdiff_t>(offset));
+			}
+		}
+
+	private:
+		// Only interpolates the channels that the expression uses
+		std::array<double, cost_variable_count> expression_inputs(from<double> x1,
+			to<double> x2,
+			cost_values const& c1) const
+		{
+			std::array<double, cost_variable_count> ret{};
+			auto const dx = x2 - x1;
+			ret[static_cast<size_t>(cost_variable::dx)] = world_scale.x()*dx[0];
+			ret[static_cast<size_t>(cost_variable::dy)] = world_scale.y()*dx[1];
+			if(expression->uses(cost_variable::dz))
+			{
+				auto const c2 = interp(image, x2.value());
+				ret[static_cast<size_t>(cost_variable::dz)] = world_scale.z()*(c2.elevation() - c1.elevation());
+			}
+
+			if(expression->uses(cost_variable::elevation) || expression->uses(cost_variable::friction)
+				|| expression->uses(cost_variable::wind_x) || expression->uses(cost_variable::wind_y))
+			{
+				auto const c = interp(image, midpoint(x2, x1).value());
+				ret[static_cast<size_t>(cost_variable::elevation)] = world_scale.z()*c.elevation();
+				ret[static_cast<size_t>(cost_variable::friction)] = c.friction();
+				ret[static_cast<size_t>(cost_variable::wind_x)] = c.wind()[0];
+				ret[static_cast<size_t>(cost_variable::wind_y)] = c.wind()[1];
+			}
+			return ret;
+		}
+	};
+
+	// True if the friction and the wind vary by at most threshold times their largest magnitude
+	// within cell, and the slope, measured in world units, varies by at most threshold
+	template<class ImageSpan>
+	bool is_smooth(ImageSpan img, search_bounds const& cell, scaling_factors world_scale, float threshold)
+	{
+		struct range
+		{
+			float min = std::numeric_limits<float>::infinity();
+			float max = -std::numeric_limits<float>::infinity();
+
+			void add(float value)
+			{
+				min = std::min(min, value);
+				max = std::max(max, value);
+			}
+
+			float size() const
+			{ return max - min; }
+
+			float magnitude() const
+			{ return std::max(std::abs(min), std::abs(max)); }
+		};
+
+		range slope_x;
+		range slope_y;
+		range friction;
+		range wind_x;
+		range wind_y;
+		auto const x1 = cell.horz_interval.max;
+		auto const y1 = cell.vert_interval.max;
+		for(auto y = cell.vert_interval.min; y != y1; ++y)
+		{
+			for(auto x = cell.horz_interval.min; x != x1; ++x)
+			{
+				auto const val = img(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+				friction.add(val.friction());
+				wind_x.add(val.wind()[0]);
+				wind_y.add(val.wind()[1]);
+				if(x + 1 != x1)
+				{
+					auto const dz = img(static_cast<uint32_t>(x + 1), static_cast<uint32_t>(y)).elevation() - val.elevation();
+					slope_x.add(world_scale.z()*dz/world_scale.x());
+				}
+
+				if(y + 1 != y1)
+				{
+					auto const dz = img(static_cast<uint32_t>(x), static_cast<uint32_t>(y + 1)).elevation() - val.elevation();
+					slope_y.add(world_scale.z()*dz/world_scale.y());
+				}
+			}
+		}
+
+		return slope_x.size() <= threshold && slope_y.size() <= threshold
+			&& friction.size() <= threshold*friction.magnitude()
+			&& wind_x.size() <= threshold*wind_x.magnitude()
+			&& wind_y.size() <= threshold*wind_y.magnitude();
+	}
+
+	// A lower bound of the cost of moving one pixel. The elevation and the wind can only make a
+	// step more expensive, so the bound is given by the lowest friction.
+	template<class ImageSpan>
+	double min_cost_per_length(basic_cost_function<ImageSpan> const& f)
+	{
+		// Nothing is known about a custom expression
+		if(f.expression != nullptr)
+		{ return 0.0; }
+
+		auto min_friction = std::numeric_limits<float>::infinity();
+		for(uint32_t y = 0; y != f.image.height(); ++y)
+		{
+			for(uint32_t x = 0; x != f.image.width(); ++x)
+			{ min_friction = std::min(min_friction, f.image(x, y).friction()); }
+		}
+
+		return std::max(static_cast<double>(f.friction_strength)*min_friction
+			*std::min(f.world_scale.x(), f.world_scale.y()), 0.0);
+	}
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CHEAPESTROUTE_COSTVALUES_HPP
+#define CHEAPESTROUTE_COSTVALUES_HPP
+
+#include "lib/vec.hpp"
+
+namespace cheapest_route
+{
+	struct cost_values
+	{
+	public:
+		constexpr cost_values():m_values{1.0f, 1.0f, 0.0f, 0.0f}
+		{}
+
+		constexpr explicit cost_values(float elevation, float friction, float wind_x, float wind_y):
+			m_values{elevation, friction, wind_x, wind_y}
+		{}
+
+		constexpr float elevation() const
+		{ return m_values[0]; }
+
+		constexpr float friction() const
+		{ return m_values[1]; }
+
+		constexpr auto wind() const
+		{
+			return vec<double, 2, quantity_type::vector>{m_values[2], m_values[3]};
+		}
+
+		constexpr cost_values& operator*=(float scalar)
+		{
+			m_values *= scalar;
+			return *this;
+		}
+
+		constexpr cost_values& operator+=(cost_values a)
+		{
+			m_values += a.m_values;
+			return *this;
+		}
+
+	private:
+		vec4f_t m_values;
+	};
+
+	constexpr inline cost_values operator*(float scalar, cost_values a)
+	{
+		a *= scalar;
+		return a;
+	}
+
+	constexpr inline cost_values operator+(cost_values a, cost_values b)
+	{
+		a += b;
+		return a;
+	}
+}
+
+#endif
@@ -0,0 +1,94 @@
+//@	{"target":{"name":"edge_weight_file.o"}}
+
+#include "./edge_weight_file.hpp"
+#include "./io_utils.hpp"
+#include "./hasher.hpp"
+
+#include "lib/search_tree.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace
+{
+	constexpr std::array<char, 8> magic{'C', 'H', 'R', 'T', 'E', 'D', 'G', 'E'};
+	constexpr uint32_t format_version = 2;
+
+	struct file_header
+	{
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t header_size;
+		cheapest_route::cost_function_key key;
+		int64_t width;
+		int64_t height;
+		uint64_t node_count;
+		uint32_t directions_per_node;
+		cheapest_route::memory_layout layout;
+		uint64_t reserved;
+	};
+
+	static_assert(sizeof(file_header) == 112);
+}
+
+cheapest_route::cost_function_key
+cheapest_route::edge_weights_key(cost_function const& f)
+{
+	hasher h;
+	h.add(format_version);
+	return cost_function_key{add(h, f).value(), get_cost_parameters(f)};
+}
+
+void cheapest_route::store(edge_weights_view const& weights,
+	cost_function_key const& key,
+	std::filesystem::path const& filename)
+{
+	file_header const header{
+		magic,
+		format_version,
+		sizeof(file_header),
+		key,
+		weights.domain.width(),
+		weights.domain.height(),
+		std::size(weights.weights),
+		static_cast<uint32_t>(stored_directions),
+		grid_layout,
+		0
+	};
+
+	output_file const dest{filename};
+	if(dest.get() == nullptr)
+	{ throw std::runtime_error{std::string{"Failed to create "}.append(filename.string())}; }
+
+	if(fwrite(&header, sizeof(header), 1, dest.get()) != 1
+		|| fwrite(std::data(weights.weights), sizeof(edge_weight_set), std::size(weights.weights), dest.get())
+			!= std::size(weights.weights))
+	{ throw std::runtime_error{std::string{"Failed to write "}.append(filename.string())}; }
+}
+
+cheapest_route::edge_weight_file
+cheapest_route::load_edge_weights(std::filesystem::path const& filename, cost_function_key const& key)
+{
+	mapped_file file{filename};
+	auto const data = file.data();
+	if(std::size(data) < sizeof(file_header))
+	{ throw std::runtime_error{std::string{"Unsupported edge weight file "}.append(filename.string())}; }
+
+	file_header header;
+	memcpy(&header, std::data(data), sizeof(header));
+	auto const domain = search_domain{header.width, header.height};
+	if(header.magic != magic || header.version != format_version || header.header_size != sizeof(file_header)
+		|| header.directions_per_node != stored_directions || header.layout != grid_layout
+		|| header.node_count != lattice_node_count(domain)
+		|| std::size(data) != sizeof(file_header) + header.node_count*sizeof(edge_weight_set))
+	{ throw std::runtime_error{std::string{"Unsupported edge weight file "}.append(filename.string())}; }
+
+	if(header.key != key)
+	{
+		throw std::runtime_error{std::string{"The edge weights in "}.append(filename.string())
+			.append(" were compiled from a different cost map or with different parameters")};
+	}
+
+	auto const weights = reinterpret_cast<edge_weight_set const*>(std::data(data) + sizeof(file_header));
+	return edge_weight_file{std::move(file), edge_weights_view{domain, std::span{weights, header.node_count}}};
+}
@@ -0,0 +1,42 @@
+//@	{"dependencies_extra":[{"ref":"./edge_weight_file.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_EDGEWEIGHTFILE_HPP
+#define CHEAPESTROUTE_EDGEWEIGHTFILE_HPP
+
+#include "./cost_function.hpp"
+#include "./hasher.hpp"
+#include "./mapped_file.hpp"
+
+#include "lib/edge_weights.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace cheapest_route
+{
+	// Identifies a set of edge weights by everything that affects its contents
+	cost_function_key edge_weights_key(cost_function const& f);
+
+	class edge_weight_file
+	{
+	public:
+		explicit edge_weight_file(mapped_file&& file, edge_weights_view const& view):
+			m_file{std::move(file)},
+			m_view{view}
+		{}
+
+		edge_weights_view const& view() const
+		{ return m_view; }
+
+	private:
+		mapped_file m_file;
+		edge_weights_view m_view;
+	};
+
+	void store(edge_weights_view const& weights, cost_function_key const& key, std::filesystem::path const& filename);
+
+	// Throws if the file was compiled from a different cost function
+	edge_weight_file load_edge_weights(std::filesystem::path const& filename, cost_function_key const& key);
+}
+
+#endif
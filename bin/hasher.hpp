@@ -0,0 +1,129 @@
+#ifndef CHEAPESTROUTE_HASHER_HPP
+#define CHEAPESTROUTE_HASHER_HPP
+
+#include "./cost_function.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace cheapest_route
+{
+	// Processes 64-bit words with the single-lane rounds and the final avalanche of xxHash64. This
+	// is not compatible with XXH64, but every input bit affects every output bit.
+	class hasher
+	{
+	public:
+		hasher& add(std::span<std::byte const> data)
+		{
+			auto const n_words = std::size(data)/sizeof(uint64_t);
+			for(size_t k = 0; k != n_words; ++k)
+			{
+				uint64_t word;
+				memcpy(&word, std::data(data) + k*sizeof(uint64_t), sizeof(uint64_t));
+				mix(word);
+			}
+
+			uint64_t tail = 0;
+			memcpy(&tail, std::data(data) + n_words*sizeof(uint64_t), std::size(data) - n_words*sizeof(uint64_t));
+			mix(tail);
+			mix(std::size(data));
+			return *this;
+		}
+
+		template<size_t Extent>
+		hasher& add(std::span<std::byte const, Extent> data)
+		{ return add(std::span<std::byte const>{data}); }
+
+		template<class T>
+		requires(std::is_trivially_copyable_v<T>)
+		hasher& add(T const& value)
+		{ return add(std::as_bytes(std::span{&value, 1})); }
+
+		uint64_t value() const
+		{
+			auto ret = m_state;
+			ret ^= ret >> 33;
+			ret *= prime_2;
+			ret ^= ret >> 29;
+			ret *= prime_3;
+			ret ^= ret >> 32;
+			return ret;
+		}
+
+	private:
+		static constexpr uint64_t prime_1 = 0x9e3779b185ebca87;
+		static constexpr uint64_t prime_2 = 0xc2b2ae3d27d4eb4f;
+		static constexpr uint64_t prime_3 = 0x165667b19e3779f9;
+		static constexpr uint64_t prime_4 = 0x85ebca77c2b2ae63;
+		static constexpr uint64_t prime_5 = 0x27d4eb2f165667c5;
+
+		void mix(uint64_t word)
+		{
+			m_state ^= std::rotl(word*prime_2, 31)*prime_1;
+			m_state = std::rotl(m_state, 27)*prime_1 + prime_4;
+		}
+
+		uint64_t m_state{prime_5};
+	};
+
+	// Adds everything that affects the value of f
+	inline hasher& add(hasher& h, cost_function const& f)
+	{
+		auto const& image = f.image;
+		h.add(grid_layout)
+			.add(image.width())
+			.add(image.height())
+			.add(std::as_bytes(pixel_storage(image)))
+			.add(f.world_scale.values())
+			.add(f.friction_strength)
+			.add(f.wind_strength.value());
+		if(f.expression != nullptr)
+		{ h.add(std::as_bytes(std::span{f.expression->source()})); }
+		return h;
+	}
+
+	// The scalar parameters of a cost function, and the size of its cost map
+	struct cost_parameters
+	{
+		uint32_t image_width;
+		uint32_t image_height;
+		std::array<float, 3> world_scale;
+		float friction_strength;
+		std::array<double, 2> wind_strength;
+		uint64_t expression_hash;
+
+		bool operator==(cost_parameters const&) const = default;
+	};
+
+	inline cost_parameters get_cost_parameters(cost_function const& f)
+	{
+		auto const world_scale = f.world_scale.values();
+		return cost_parameters{
+			f.image.width(),
+			f.image.height(),
+			std::array{world_scale[0], world_scale[1], world_scale[2]},
+			f.friction_strength,
+			std::array{f.wind_strength[0], f.wind_strength[1]},
+			f.expression != nullptr ? hasher{}.add(std::as_bytes(std::span{f.expression->source()})).value() : 0
+		};
+	}
+
+	// Identifies files derived from a cost function. The parameters are stored next to the hash
+	// and compared on load, so that a file made with other parameters is never used, even if the
+	// hashes collide.
+	struct cost_function_key
+	{
+		uint64_t hash;
+		cost_parameters parameters;
+
+		bool operator==(cost_function_key const&) const = default;
+	};
+
+	static_assert(sizeof(cost_function_key) == 56);
+}
+
+#endif
@@ -0,0 +1,43 @@
+//@	{"target":{"name":"hasher.test"}}
+
+#include "./hasher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	uint64_t hash(std::array<float, 3> const& values)
+	{ return cheapest_route::hasher{}.add(std::as_bytes(std::span{values})).value(); }
+}
+
+int main()
+{
+	// These collided when words were mixed with a single FNV step
+	printf("%016lx %016lx\n", hash(std::array{0.5f, 1.0f, 0.5f}), hash(std::array{8.0f, 4.0f, 2.0f}));
+	assert(hash(std::array{0.5f, 1.0f, 0.5f}) != hash(std::array{8.0f, 4.0f, 2.0f}));
+
+	// Small friction maps made of typical values
+	std::vector<float> values;
+	for(int k = 0; k != 48; ++k)
+	{ values.push_back(static_cast<float>(k)/4.0f); }
+
+	std::vector<uint64_t> hashes;
+	for(auto const a : values)
+	{
+		for(auto const b : values)
+		{
+			for(auto const c : values)
+			{ hashes.push_back(hash(std::array{a, b, c})); }
+		}
+	}
+	std::ranges::sort(hashes);
+	assert(std::ranges::adjacent_find(hashes) == std::end(hashes));
+
+	// The size is part of the hash
+	assert(cheapest_route::hasher{}.add(std::array<uint64_t, 1>{}).value()
+		!= cheapest_route::hasher{}.add(std::array<uint64_t, 2>{}).value());
+}
@@ -13,79 +13,154 @@
 #include <OpenEXR/ImfHeader.h>
 #include <OpenEXR/ImfFrameBuffer.h>
 
-cheapest_route::image_type cheapest_route::load_image(std::filesystem::path const& filename)
+#include <algorithm>
+#include <span>
+
+struct cheapest_route::image_row_reader::impl
 {
-	Imf::InputFile src{filename.c_str()};
+	explicit impl(std::filesystem::path const& filename):
+		src{filename.c_str()},
+		box{src.header().dataWindow()}
+	{
+		auto const& channels = src.header().channels();
 
-	auto box = src.header().dataWindow();
+		auto const red = channels.findChannel("R");
+		auto const green = channels.findChannel("G");
+		auto const blue = channels.findChannel("B");
+		auto const alpha = channels.findChannel("A");
+		auto const luminance = channels.findChannel("Y");
 
-	auto w = box.max.x - box.min.x + 1;
-	auto h = box.max.y - box.min.y + 1;
+		auto const has_rgba = red != nullptr && green != nullptr && blue != nullptr && alpha != nullptr;
+		auto const has_luminance = luminance != nullptr;
 
-	constexpr auto elem_size = sizeof(cost_values);
+		if(has_rgba && has_luminance)
+		{
+			throw std::runtime_error{"Ambigous channel set. Input image should use either RGBA or Y."};
+		}
 
-	auto const& channels = src.header().channels();
+		if(!has_rgba && !has_luminance)
+		{
+			throw std::runtime_error{"Unsupported channel set. Input image should use either RGBA or Y."};
+		}
 
-	auto const red = channels.findChannel("R");
-	auto const green = channels.findChannel("G");
-	auto const blue = channels.findChannel("B");
-	auto const alpha = channels.findChannel("A");
-	auto const luminance = channels.findChannel("Y");
+		channel_names = has_rgba ? std::span<char const* const>{rgba} : std::span<char const* const>{luminance_only};
+	}
 
-	auto const has_rgba = red != nullptr && green != nullptr && blue != nullptr && alpha != nullptr;
-	auto const has_luminance = luminance != nullptr;
+	static constexpr char const* rgba[] = {"R", "G", "B", "A"};
+	static constexpr char const* luminance_only[] = {"Y"};
 
-	if(has_rgba && has_luminance)
-	{
-		throw std::runtime_error{"Ambigous channel set. Input image should use either RGBA or Y."};
-	}
+	Imf::InputFile src;
+	Imath::Box2i box;
+	std::span<char const* const> channel_names;
+};
+
+cheapest_route::image_row_reader::image_row_reader(std::filesystem::path const& filename):
+	m_impl{std::make_unique<impl>(filename)}
+{}
 
-	if(!has_rgba && has_luminance)
+cheapest_route::image_row_reader::image_row_reader(image_row_reader&&) noexcept = default;
+
+cheapest_route::image_row_reader& cheapest_route::image_row_reader::operator=(image_row_reader&&) noexcept = default;
+
+cheapest_route::image_row_reader::~image_row_reader() = default;
+
+uint32_t cheapest_route::image_row_reader::width() const
+{ return static_cast<uint32_t>(m_impl->box.max.x - m_impl->box.min.x + 1); }
+
+uint32_t cheapest_route::image_row_reader::height() const
+{ return static_cast<uint32_t>(m_impl->box.max.y - m_impl->box.min.y + 1); }
+
+namespace
+{
+	// Decodes the rows in [begin, end) into a buffer with full rows of row_size bytes. base is
+	// the address of pixel (0, 0), which does not have to be within the buffer.
+	template<class Impl>
+	void decode_rows(Impl& src, char* base, size_t row_size, uint32_t begin, uint32_t end)
 	{
-		image_type ret{static_cast<uint32_t>(w), static_cast<uint32_t>(h)};
+		constexpr auto elem_size = sizeof(cheapest_route::cost_values);
+		auto const& box = src.box;
+
+		// Slices are addressed in data window coordinates
+		auto const origin = base
+			- static_cast<ptrdiff_t>(box.min.x)*static_cast<ptrdiff_t>(elem_size)
+			- static_cast<ptrdiff_t>(box.min.y)*static_cast<ptrdiff_t>(row_size);
 
 		Imf::FrameBuffer fb;
-		fb.insert("Y",
-				Imf::Slice{Imf::FLOAT,
-							(char*)(ret.pixels().data()) + 0 * sizeof(float),
-							elem_size,
-							elem_size * w});
-
-		src.setFrameBuffer(fb);
-		src.readPixels(box.min.y, box.max.y);
-		return ret;
+		for(size_t k = 0; k != std::size(src.channel_names); ++k)
+		{
+			fb.insert(src.channel_names[k],
+				Imf::Slice{Imf::FLOAT, origin + k*sizeof(float), elem_size, row_size});
+		}
+
+		src.src.setFrameBuffer(fb);
+		src.src.readPixels(box.min.y + static_cast<int>(begin), box.min.y + static_cast<int>(end) - 1);
 	}
 
-	if(has_rgba && !has_luminance)
-	{
-		image_type ret{static_cast<uint32_t>(w), static_cast<uint32_t>(h)};
+	constexpr uint32_t rows_per_strip = 16;
+}
 
-		Imf::FrameBuffer fb;
-		fb.insert("R",
-				Imf::Slice{Imf::FLOAT,
-							(char*)(ret.pixels().data()) + 0 * sizeof(float),
-							elem_size,
-							elem_size * w});
-		fb.insert("G",
-			Imf::Slice{Imf::FLOAT,
-						(char*)(ret.pixels().data()) + 1 * sizeof(float),
-						elem_size,
-						elem_size * w});
-		fb.insert("B",
-			Imf::Slice{Imf::FLOAT,
-						(char*)(ret.pixels().data()) + 2 * sizeof(float),
-						elem_size,
-						elem_size * w});
-		fb.insert("A",
-			Imf::Slice{Imf::FLOAT,
-						(char*)(ret.pixels().data()) + 3 * sizeof(float),
-						elem_size,
-						elem_size * w});
-
-		src.setFrameBuffer(fb);
-		src.readPixels(box.min.y, box.max.y);
-		return ret;
+void cheapest_route::image_row_reader::read_rows(pixel_store::image_span<cost_values> dest, uint32_t begin, uint32_t end)
+{
+	if(dest.width() != width() || dest.height() != height())
+	{ throw std::runtime_error{"The destination does not have the size of the image"}; }
+
+	if(begin >= end)
+	{ return; }
+
+	decode_rows(*m_impl, reinterpret_cast<char*>(dest.data()), sizeof(cost_values)*dest.width(), begin, end);
+}
+
+void cheapest_route::image_row_reader::read_region(pixel_store::image_span<cost_values> dest, uint32_t x0, uint32_t y0)
+{
+	if(static_cast<uint64_t>(x0) + dest.width() > width() || static_cast<uint64_t>(y0) + dest.height() > height())
+	{ throw std::runtime_error{"The region is outside the image"}; }
+
+	auto const row_size = sizeof(cost_values)*width();
+	image_type strip{width(), std::min(rows_per_strip, std::max(dest.height(), 1u))};
+	for(uint32_t y = 0; y < dest.height(); y += strip.height())
+	{
+		auto const rows = std::min(strip.height(), dest.height() - y);
+		auto const base = reinterpret_cast<char*>(strip.pixels().data())
+			- static_cast<ptrdiff_t>(y0 + y)*static_cast<ptrdiff_t>(row_size);
+		decode_rows(*m_impl, base, row_size, y0 + y, y0 + y + rows);
+		for(uint32_t k = 0; k != rows; ++k)
+		{
+			for(uint32_t x = 0; x != dest.width(); ++x)
+			{ dest(x, y + k) = strip(x0 + x, k); }
+		}
 	}
+}
+
+cheapest_route::image_type cheapest_route::load_image(std::filesystem::path const& filename)
+{
+	image_row_reader src{filename};
+	image_type ret{src.width(), src.height()};
+	src.read_rows(ret.pixels(), 0, src.height());
+	return ret;
+}
+
+pixel_store::image<float> cheapest_route::load_channel(std::filesystem::path const& filename, char const* channel_name)
+{
+	Imf::InputFile src{filename.c_str()};
+
+	auto box = src.header().dataWindow();
+
+	auto w = box.max.x - box.min.x + 1;
+	auto h = box.max.y - box.min.y + 1;
+
+	if(src.header().channels().findChannel(channel_name) == nullptr)
+	{ throw std::runtime_error{std::string{"Channel "}.append(channel_name).append(" not found")}; }
+
+	pixel_store::image<float> ret{static_cast<uint32_t>(w), static_cast<uint32_t>(h)};
+
+	Imf::FrameBuffer fb;
+	fb.insert(channel_name,
+		Imf::Slice{Imf::FLOAT,
+			(char*)(ret.pixels().data()),
+			sizeof(float),
+			sizeof(float) * w});
 
-	throw std::runtime_error{"Unsupported channel set. Input image should use either RGBA or Y."};
-}
\ No newline at end of file
+	src.setFrameBuffer(fb);
+	src.readPixels(box.min.y, box.max.y);
+	return ret;
+}
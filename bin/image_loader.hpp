@@ -3,60 +3,47 @@
 #ifndef CHEAPESTROUTE_IMAGELOADER_HPP
 #define CHEAPESTROUTE_IMAGELOADER_HPP
 
-#include "lib/vec.hpp"
+#include "./cost_values.hpp"
 
 #include "pixel_store/image.hpp"
 #include <filesystem>
+#include <memory>
 
 namespace cheapest_route
 {
-	struct cost_values
+	using image_type = pixel_store::image<cost_values>;
+
+	image_type load_image(std::filesystem::path const& filename);
+
+	// Decodes an image a few rows at a time, so the first rows can be used before the entire
+	// image has been decoded
+	class image_row_reader
 	{
 	public:
-		constexpr cost_values():m_values{1.0f, 1.0f, 0.0f, 0.0f}
-		{}
+		explicit image_row_reader(std::filesystem::path const& filename);
 
-		constexpr float elevation() const
-		{ return m_values[0]; }
+		image_row_reader(image_row_reader&&) noexcept;
 
-		constexpr float friction() const
-		{ return m_values[1]; }
+		image_row_reader& operator=(image_row_reader&&) noexcept;
 
-		constexpr auto wind() const
-		{
-			return vec<double, 2, quantity_type::vector>{m_values[2], m_values[3]};
-		}
+		~image_row_reader();
 
-		constexpr cost_values& operator*=(float scalar)
-		{
-			m_values *= scalar;
-			return *this;
-		}
+		uint32_t width() const;
 
-		constexpr cost_values& operator+=(cost_values a)
-		{
-			m_values += a.m_values;
-			return *this;
-		}
+		uint32_t height() const;
 
-	private:
-		vec4f_t m_values;
-	};
+		// Decodes the rows in [begin, end) into dest, which must have the size of the image
+		void read_rows(pixel_store::image_span<cost_values> dest, uint32_t begin, uint32_t end);
 
-	constexpr inline cost_values operator*(float scalar, cost_values a)
-	{
-		a *= scalar;
-		return a;
-	}
+		// Decodes the part of the image that starts at (x0, y0), and has the size of dest. Only a few
+		// rows of the image are kept in memory at a time.
+		void read_region(pixel_store::image_span<cost_values> dest, uint32_t x0, uint32_t y0);
 
-	constexpr inline cost_values operator+(cost_values a, cost_values b)
-	{
-		a += b;
-		return a;
-	}
-
-	using image_type = pixel_store::image<cost_values>;
+	private:
+		struct impl;
+		std::unique_ptr<impl> m_impl;
+	};
 
-	image_type load_image(std::filesystem::path const& filename);
+	pixel_store::image<float> load_channel(std::filesystem::path const& filename, char const* channel_name);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+//@	{
+//@	 "target":{"name":"image_writer.o"},
+//@	 "dependencies":[{"ref":"OpenEXR", "origin":"pkg-config"}]
+//@	}
+
+#include "./image_writer.hpp"
+
+#include <OpenEXR/ImfOutputFile.h>
+#include <OpenEXR/ImfChannelList.h>
+#include <OpenEXR/ImfHeader.h>
+#include <OpenEXR/ImfFrameBuffer.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+void cheapest_route::store_image(std::filesystem::path const& filename,
+	std::span<image_channel const> channels)
+{
+	if(std::size(channels) == 0)
+	{ throw std::runtime_error{"An image must have at least one channel"}; }
+
+	auto const w = channels[0].pixels.width();
+	auto const h = channels[0].pixels.height();
+
+	Imf::Header header{static_cast<int>(w), static_cast<int>(h)};
+	Imf::FrameBuffer fb;
+	for(auto const& channel : channels)
+	{
+		if(channel.pixels.width() != w || channel.pixels.height() != h)
+		{ throw std::runtime_error{"All channels must have the same size"}; }
+
+		header.channels().insert(channel.name, Imf::Channel{Imf::FLOAT});
+		fb.insert(channel.name,
+			Imf::Slice{Imf::FLOAT,
+				(char*)(channel.pixels.data()),
+				sizeof(float),
+				sizeof(float) * w});
+	}
+
+	Imf::OutputFile dest{filename.c_str(), header};
+	dest.setFrameBuffer(fb);
+	dest.writePixels(static_cast<int>(h));
+}
+
+struct cheapest_route::image_row_writer::impl
+{
+	static Imf::Header make_header(uint32_t width, uint32_t height, std::span<char const* const> channel_names)
+	{
+		Imf::Header ret{static_cast<int>(width), static_cast<int>(height)};
+		for(auto const name : channel_names)
+		{ ret.channels().insert(name, Imf::Channel{Imf::FLOAT}); }
+		return ret;
+	}
+
+	explicit impl(std::filesystem::path const& filename,
+		uint32_t w,
+		uint32_t h,
+		std::span<char const* const> names):
+		dest{filename.c_str(), make_header(w, h, names)},
+		channel_names(std::begin(names), std::end(names)),
+		width{w},
+		height{h}
+	{}
+
+	Imf::OutputFile dest;
+	std::vector<std::string> channel_names;
+	uint32_t width;
+	uint32_t height;
+};
+
+cheapest_route::image_row_writer::image_row_writer(std::filesystem::path const& filename,
+	uint32_t width,
+	uint32_t height,
+	std::span<char const* const> channel_names)
+{
+	if(std::size(channel_names) == 0)
+	{ throw std::runtime_error{"An image must have at least one channel"}; }
+
+	m_impl = std::make_unique<impl>(filename, width, height, channel_names);
+}
+
+cheapest_route::image_row_writer::image_row_writer(image_row_writer&&) noexcept = default;
+
+cheapest_route::image_row_writer& cheapest_route::image_row_writer::operator=(image_row_writer&&) noexcept = default;
+
+cheapest_route::image_row_writer::~image_row_writer() = default;
+
+uint32_t cheapest_route::image_row_writer::next_row() const
+{ return static_cast<uint32_t>(m_impl->dest.currentScanLine()); }
+
+void cheapest_route::image_row_writer::write_rows(std::span<image_channel const> channels)
+{
+	if(std::size(channels) != std::size(m_impl->channel_names))
+	{ throw std::runtime_error{"Wrong number of channels"}; }
+
+	auto const rows = channels[0].pixels.height();
+	auto const row = next_row();
+	if(rows > m_impl->height - row)
+	{ throw std::runtime_error{"Too many rows"}; }
+
+	auto const row_size = sizeof(float)*m_impl->width;
+	Imf::FrameBuffer fb;
+	for(size_t k = 0; k != std::size(channels); ++k)
+	{
+		auto const& channel = channels[k];
+		if(channel.pixels.width() != m_impl->width || channel.pixels.height() != rows
+			|| m_impl->channel_names[k] != channel.name)
+		{ throw std::runtime_error{"The channels do not match the image"}; }
+
+		// Slices are addressed in image coordinates
+		fb.insert(channel.name,
+			Imf::Slice{Imf::FLOAT,
+				(char*)(channel.pixels.data()) - static_cast<ptrdiff_t>(row)*static_cast<ptrdiff_t>(row_size),
+				sizeof(float),
+				row_size});
+	}
+
+	m_impl->dest.setFrameBuffer(fb);
+	m_impl->dest.writePixels(static_cast<int>(rows));
+}
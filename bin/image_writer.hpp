@@ -0,0 +1,51 @@
+//@	{"dependencies_extra":[{"ref":"./image_writer.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_IMAGEWRITER_HPP
+#define CHEAPESTROUTE_IMAGEWRITER_HPP
+
+#include "pixel_store/image.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace cheapest_route
+{
+	struct image_channel
+	{
+		char const* name;
+		pixel_store::image_span<float const> pixels;
+	};
+
+	void store_image(std::filesystem::path const& filename, std::span<image_channel const> channels);
+
+	// Writes an image a block of rows at a time, from the top, so the entire image does not have
+	// to be in memory
+	class image_row_writer
+	{
+	public:
+		explicit image_row_writer(std::filesystem::path const& filename,
+			uint32_t width,
+			uint32_t height,
+			std::span<char const* const> channel_names);
+
+		image_row_writer(image_row_writer&&) noexcept;
+
+		image_row_writer& operator=(image_row_writer&&) noexcept;
+
+		~image_row_writer();
+
+		// The first row that has not been written yet
+		uint32_t next_row() const;
+
+		// Writes the next rows. channels must be given in the same order as in the constructor,
+		// and have the width of the image.
+		void write_rows(std::span<image_channel const> channels);
+
+	private:
+		struct impl;
+		std::unique_ptr<impl> m_impl;
+	};
+}
+#endif
@@ -1,7 +1,11 @@
 #ifndef CHEAPESTROUTE_IO_UTILS_HPP
 #define CHEAPESTROUTE_IO_UTILS_HPP
 
+#include <cstdlib>
 #include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <variant>
 
 namespace cheapest_route
@@ -57,12 +61,40 @@ namespace cheapest_route
 		{}
 
 		auto get() const
+		{ return m_file.get(); }
+
+	private:
+		file_handle m_file;
+	};
+
+	// A new directory below the system temporary directory, that is removed together with its
+	// contents when the object is destroyed
+	class temporary_directory
+	{
+	public:
+		explicit temporary_directory(std::string_view prefix)
 		{
-			m_file.get();
+			auto name = (std::filesystem::temp_directory_path()/prefix).string().append("XXXXXX");
+			if(mkdtemp(std::data(name)) == nullptr)
+			{ throw std::runtime_error{"Failed to create a temporary directory"}; }
+			m_path = std::move(name);
 		}
 
+		temporary_directory(temporary_directory const&) = delete;
+
+		temporary_directory& operator=(temporary_directory const&) = delete;
+
+		~temporary_directory()
+		{
+			std::error_code ec;
+			std::filesystem::remove_all(m_path, ec);
+		}
+
+		std::filesystem::path const& path() const
+		{ return m_path; }
+
 	private:
-		file_handle m_file;
+		std::filesystem::path m_path;
 	};
 };
 
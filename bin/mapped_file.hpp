@@ -0,0 +1,75 @@
+#ifndef CHEAPESTROUTE_MAPPEDFILE_HPP
+#define CHEAPESTROUTE_MAPPEDFILE_HPP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace cheapest_route
+{
+	// A read-only memory mapping of a complete file
+	class mapped_file
+	{
+	public:
+		explicit mapped_file(std::filesystem::path const& path):m_data{nullptr}, m_size{0}
+		{
+			auto const fd = ::open(path.c_str(), O_RDONLY);
+			if(fd == -1)
+			{ throw std::runtime_error{std::string{"Failed to open "}.append(path.string())}; }
+
+			struct stat info{};
+			if(::fstat(fd, &info) == -1)
+			{
+				::close(fd);
+				throw std::runtime_error{std::string{"Failed to query the size of "}.append(path.string())};
+			}
+
+			m_size = static_cast<size_t>(info.st_size);
+			if(m_size != 0)
+			{
+				auto const ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+				if(ptr == MAP_FAILED)
+				{
+					::close(fd);
+					throw std::runtime_error{std::string{"Failed to map "}.append(path.string())};
+				}
+				m_data = static_cast<std::byte const*>(ptr);
+			}
+			::close(fd);
+		}
+
+		mapped_file(mapped_file&& other) noexcept:
+			m_data{std::exchange(other.m_data, nullptr)},
+			m_size{std::exchange(other.m_size, 0)}
+		{}
+
+		mapped_file& operator=(mapped_file&& other) noexcept
+		{
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			return *this;
+		}
+
+		~mapped_file()
+		{
+			if(m_data != nullptr)
+			{ ::munmap(const_cast<std::byte*>(m_data), m_size); }
+		}
+
+		std::span<std::byte const> data() const
+		{ return std::span{m_data, m_size}; }
+
+	private:
+		std::byte const* m_data;
+		size_t m_size;
+	};
+}
+
+#endif
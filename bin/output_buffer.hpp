@@ -0,0 +1,103 @@
+#ifndef CHEAPESTROUTE_OUTPUTBUFFER_HPP
+#define CHEAPESTROUTE_OUTPUTBUFFER_HPP
+
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <stdexcept>
+
+namespace cheapest_route
+{
+	// Floating-point values are written the same way as printf("%.8e"). Pending data is not
+	// written by the destructor, so flush must be called explicitly.
+	class output_buffer
+	{
+	public:
+		static constexpr size_t capacity = 1024*1024;
+
+		explicit output_buffer(FILE* f):
+			m_file{f},
+			m_buffer{std::make_unique_for_overwrite<char[]>(capacity)},
+			m_size{0}
+		{}
+
+		output_buffer& write(std::string_view str)
+		{
+			if(std::size(str) > capacity - m_size)
+			{
+				flush();
+				if(std::size(str) > capacity)
+				{
+					write_to_file(std::data(str), std::size(str));
+					return *this;
+				}
+			}
+			memcpy(m_buffer.get() + m_size, std::data(str), std::size(str));
+			m_size += std::size(str);
+			return *this;
+		}
+
+		output_buffer& write(char ch)
+		{
+			reserve(1);
+			m_buffer[m_size] = ch;
+			++m_size;
+			return *this;
+		}
+
+		output_buffer& write(double value)
+		{
+			reserve(max_number_length);
+			auto const begin = m_buffer.get() + m_size;
+			auto const res = std::to_chars(begin, begin + max_number_length, value, std::chars_format::scientific, 8);
+			m_size += static_cast<size_t>(res.ptr - begin);
+			return *this;
+		}
+
+		output_buffer& write(int64_t value)
+		{
+			reserve(max_number_length);
+			auto const begin = m_buffer.get() + m_size;
+			auto const res = std::to_chars(begin, begin + max_number_length, value);
+			m_size += static_cast<size_t>(res.ptr - begin);
+			return *this;
+		}
+
+		output_buffer& write_bytes(void const* data, size_t n)
+		{
+			return write(std::string_view{static_cast<char const*>(data), n});
+		}
+
+		void flush()
+		{
+			write_to_file(m_buffer.get(), m_size);
+			m_size = 0;
+			if(fflush(m_file) != 0)
+			{ throw std::runtime_error{"Failed to write output"}; }
+		}
+
+	private:
+		static constexpr size_t max_number_length = 32;
+
+		void reserve(size_t n)
+		{
+			if(n > capacity - m_size)
+			{ flush(); }
+		}
+
+		void write_to_file(char const* data, size_t n)
+		{
+			if(fwrite(data, 1, n, m_file) != n)
+			{ throw std::runtime_error{"Failed to write output"}; }
+		}
+
+		FILE* m_file;
+		std::unique_ptr<char[]> m_buffer;
+		size_t m_size;
+	};
+}
+
+#endif
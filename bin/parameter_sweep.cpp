@@ -0,0 +1,271 @@
+//@	{"target":{"name":"parameter_sweep.o"}}
+
+#include "./parameter_sweep.hpp"
+#include "./path_encoder.hpp"
+#include "./output_buffer.hpp"
+#include "./io_utils.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	std::vector<std::string> split_values(std::string_view str)
+	{
+		std::vector<std::string> ret;
+		std::istringstream input{std::string{str}};
+		std::string value;
+		while(input >> value)
+		{ ret.push_back(std::move(value)); }
+		return ret;
+	}
+
+	float parse_friction_strength(std::string const& str)
+	{
+		auto const ret = std::stof(str);
+		if(ret <= 0.0f)
+		{ throw std::runtime_error{"The friction strength must be strictly positive"}; }
+		return ret;
+	}
+
+	double path_length(cheapest_route::sweep_result const& res)
+	{
+		auto const& route = res.route;
+		auto const& world_scale = res.parameters.world_scale;
+		auto ret = 0.0;
+		for(size_t k = 1; k < std::size(route); ++k)
+		{
+			auto const dx = route[k].loc - route[k - 1].loc;
+			auto const dr = world_scale*cheapest_route::vec<float, 4>{static_cast<float>(dx[0]),
+				static_cast<float>(dx[1]),
+				res.elevation_profile[k] - res.elevation_profile[k - 1],
+				0.0f};
+			ret += std::sqrt(static_cast<double>(dot(dr, dr)));
+		}
+		return ret;
+	}
+
+	void write_json_string(cheapest_route::output_buffer& buffer, std::string_view str)
+	{
+		buffer.write('"');
+		for(auto ch : str)
+		{
+			switch(ch)
+			{
+				case '"':
+					buffer.write(std::string_view{"\\\""});
+					break;
+
+				case '\\':
+					buffer.write(std::string_view{"\\\\"});
+					break;
+
+				case '\n':
+					buffer.write(std::string_view{"\\n"});
+					break;
+
+				case '\t':
+					buffer.write(std::string_view{"\\t"});
+					break;
+
+				case '\r':
+					buffer.write(std::string_view{"\\r"});
+					break;
+
+				default:
+					if(static_cast<unsigned char>(ch) < 0x20)
+					{
+						constexpr std::string_view hex_digits{"0123456789abcdef"};
+						buffer.write(std::string_view{"\\u00"})
+							.write(hex_digits[static_cast<unsigned char>(ch) >> 4])
+							.write(hex_digits[static_cast<unsigned char>(ch) & 0xf]);
+					}
+					else
+					{ buffer.write(ch); }
+			}
+		}
+		buffer.write('"');
+	}
+}
+
+std::vector<cheapest_route::sweep_parameters>
+cheapest_route::load_parameter_grid(std::filesystem::path const& filename, sweep_parameters const& defaults)
+{
+	std::ifstream input{filename};
+	if(!input)
+	{ throw std::runtime_error{std::string{"Failed to open "}.append(filename.string())}; }
+
+	std::vector<scaling_factors> world_scale{defaults.world_scale};
+	std::vector<float> friction_strength{defaults.friction_strength};
+	std::vector<vec<double, 2, quantity_type::vector>> wind_strength{defaults.wind_strength};
+
+	std::string line;
+	while(std::getline(input, line))
+	{
+		if(line.find_first_not_of(" \t\r") == std::string::npos)
+		{ continue; }
+
+		auto const eq = line.find('=');
+		if(eq == std::string::npos)
+		{ throw std::runtime_error{std::string{"Bad parameter grid line: "}.append(line)}; }
+
+		auto const name = split_values(std::string_view{line}.substr(0, eq));
+		auto const values = split_values(std::string_view{line}.substr(eq + 1));
+		if(std::size(name) != 1 || std::size(values) == 0)
+		{ throw std::runtime_error{std::string{"Bad parameter grid line: "}.append(line)}; }
+
+		if(name[0] == "world_scale")
+		{
+			world_scale.clear();
+			for(auto const& item : values)
+			{ world_scale.push_back(scaling_factors{item}); }
+		}
+		else
+		if(name[0] == "friction_strength")
+		{
+			friction_strength.clear();
+			for(auto const& item : values)
+			{ friction_strength.push_back(parse_friction_strength(item)); }
+		}
+		else
+		if(name[0] == "wind_strength")
+		{
+			wind_strength.clear();
+			for(auto const& item : values)
+			{ wind_strength.push_back(vec<double, 2, quantity_type::vector>{item}); }
+		}
+		else
+		{ throw std::runtime_error{std::string{"Parameter "}.append(name[0]).append(" cannot be swept")}; }
+	}
+
+	std::vector<sweep_parameters> ret;
+	ret.reserve(std::size(world_scale)*std::size(friction_strength)*std::size(wind_strength));
+	for(auto const& scale_item : world_scale)
+	{
+		for(auto const friction_item : friction_strength)
+		{
+			for(auto const& wind_item : wind_strength)
+			{ ret.push_back(sweep_parameters{scale_item, friction_item, wind_item}); }
+		}
+	}
+	return ret;
+}
+
+std::vector<cheapest_route::sweep_result> cheapest_route::run_sweep(from<int64_t> origin,
+	to<int64_t> destination,
+	cost_map_span cost_map,
+	std::span<sweep_parameters const> grid,
+	search_options const& options,
+	size_t thread_count)
+{
+	auto const domain = search_domain{
+		static_cast<int64_t>(cost_map.width()), static_cast<int64_t>(cost_map.height())
+	};
+
+	if(std::size(grid) == 0)
+	{ return std::vector<sweep_result>{}; }
+
+	std::vector<sweep_result> ret(std::size(grid),
+		sweep_result{grid[0], path{}, std::vector<float>{}, 0.0, std::string{}});
+	std::atomic<size_t> next_item{0};
+	{
+		std::vector<std::jthread> workers;
+		for(size_t k = 0; k != std::min(std::max(thread_count, size_t{1}), std::size(grid)); ++k)
+		{
+			workers.emplace_back([&]() {
+				search_context context;
+				while(true)
+				{
+					auto const index = next_item++;
+					if(index >= std::size(grid))
+					{ return; }
+
+					auto& res = ret[index];
+					res.parameters = grid[index];
+					try
+					{
+						auto const f = cost_function{cost_map,
+							res.parameters.world_scale,
+							res.parameters.friction_strength,
+							res.parameters.wind_strength};
+						res.route = search(origin, destination, domain, f, options, context);
+						res.elevation_profile.reserve(std::size(res.route));
+						for(auto const& item : res.route)
+						{ res.elevation_profile.push_back(interp(cost_map, item.loc.value()).elevation()); }
+						res.length = path_length(res);
+					}
+					catch(std::exception const& err)
+					{ res.error = err.what(); }
+				}
+			});
+		}
+	}
+	return ret;
+}
+
+void cheapest_route::write_sweep_results(FILE* f,
+	length_unit lu,
+	from<int64_t> origin,
+	to<int64_t> destination,
+	search_domain domain,
+	std::span<sweep_result const> results)
+{
+	output_buffer buffer{f};
+	buffer.write(R"json({
+	"cheapest_route_sweep": {
+		"domain_size": {
+			"width": )json")
+		.write(domain.width())
+		.write(R"json(,
+			"height": )json")
+		.write(domain.height())
+		.write(R"json(
+		},
+		"length_unit": ")json")
+		.write(lu.name())
+		.write("\",\n\t\t\"origin\": [")
+		.write(origin[0]).write(", ").write(origin[1])
+		.write("],\n\t\t\"destination\": [")
+		.write(destination[0]).write(", ").write(destination[1])
+		.write("],\n\t\t\"results\": [");
+
+	for(size_t k = 0; k != std::size(results); ++k)
+	{
+		auto const& item = results[k];
+		auto const& params = item.parameters;
+		buffer.write(k == 0 ? "\n\t\t\t{\n" : ",\n\t\t\t{\n")
+			.write("\t\t\t\t\"world_scale\": [")
+			.write(static_cast<double>(params.world_scale.x())).write(", ")
+			.write(static_cast<double>(params.world_scale.y())).write(", ")
+			.write(static_cast<double>(params.world_scale.z()))
+			.write("],\n\t\t\t\t\"friction_strength\": ")
+			.write(static_cast<double>(params.friction_strength))
+			.write(",\n\t\t\t\t\"wind_strength\": [")
+			.write(params.wind_strength[0]).write(", ").write(params.wind_strength[1])
+			.write("],\n");
+
+		if(!item.error.empty())
+		{
+			buffer.write("\t\t\t\t\"error\": ");
+			write_json_string(buffer, item.error);
+		}
+		else
+		{
+			buffer.write("\t\t\t\t\"cost\": ")
+				.write(item.route.back().integrated_cost)
+				.write(",\n\t\t\t\t\"length\": ")
+				.write(item.length)
+				.write(",\n\t\t\t\t\"path\": ");
+			write_json_path(buffer, path_with_elevation{&item.route, std::data(item.elevation_profile)}, "\t\t\t\t");
+		}
+		buffer.write("\n\t\t\t}");
+	}
+
+	buffer.write(R"json(
+		]
+	}
+})json");
+	buffer.flush();
+}
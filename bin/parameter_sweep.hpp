@@ -0,0 +1,61 @@
+//@	{"dependencies_extra":[{"ref":"./parameter_sweep.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_PARAMETERSWEEP_HPP
+#define CHEAPESTROUTE_PARAMETERSWEEP_HPP
+
+#include "./cost_function.hpp"
+#include "./length_unit.hpp"
+
+#include "lib/search.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cheapest_route
+{
+	struct sweep_parameters
+	{
+		scaling_factors world_scale;
+		float friction_strength;
+		vec<double, 2, quantity_type::vector> wind_strength;
+	};
+
+	// Reads a parameter grid. Each line holds one parameter followed by the values to try, as in
+	//
+	// friction_strength=0.01 0.02 0.05
+	// wind_strength=(1,1) (2,0.5)
+	//
+	// Values are separated by whitespace. Parameters that are not listed keep the value from
+	// defaults. The result contains every combination of the listed values.
+	std::vector<sweep_parameters> load_parameter_grid(std::filesystem::path const& filename,
+		sweep_parameters const& defaults);
+
+	struct sweep_result
+	{
+		sweep_parameters parameters;
+		path route;
+		std::vector<float> elevation_profile;
+		double length;
+		std::string error;
+	};
+
+	// Searches for the cheapest route for every combination in grid, using thread_count threads
+	std::vector<sweep_result> run_sweep(from<int64_t> origin,
+		to<int64_t> destination,
+		cost_map_span cost_map,
+		std::span<sweep_parameters const> grid,
+		search_options const& options,
+		size_t thread_count);
+
+	void write_sweep_results(FILE* f,
+		length_unit lu,
+		from<int64_t> origin,
+		to<int64_t> destination,
+		search_domain domain,
+		std::span<sweep_result const> results);
+}
+
+#endif
@@ -1,9 +1,13 @@
 //@	{"target":{"name":"./path_encoder.o"}}
 
 #include "./path_encoder.hpp"
+#include "./output_buffer.hpp"
 
 #include <stdexcept>
 #include <algorithm>
+#include <bit>
+#include <array>
+#include <cstring>
 
 namespace
 {
@@ -11,8 +15,7 @@ namespace
 		cheapest_route::length_unit lu,
 		cheapest_route::scaling_factors factors,
 		cheapest_route::search_domain domain,
-		cheapest_route::path const& nodes,
-		float const*)
+		std::span<cheapest_route::path_with_elevation const> paths)
 	{
 		using cheapest_route::vec4f_t;
 		auto const unit_factor = 90.0*lu.factor()/0.0254;
@@ -22,93 +25,190 @@ namespace
 			* factors.values()*vec4f_t{static_cast<float>(domain.width()), static_cast<float>(domain.height()), 0.0f, 0.0f}
 			+ vec4f_t{0.5f, 0.5f, 0.0f, 0.0f};
 
-		fprintf(f,R"xml(<svg width="%d" height="%d" xmlns="http://www.w3.org/2000/svg">
-<g transform="scale(%.8e %.8e)">
-<polyline stroke="blue" points=")xml",
-			static_cast<int>(dom_scaled[0]), static_cast<int>(dom_scaled[1]),
-			factors.x(), factors.y()
-		);
-		std::ranges::for_each(nodes, [f, unit_factor](auto const& item){
-			auto const val = unit_factor*cheapest_route::vec<double, 2>{item.loc};
-			fprintf(f, "%.8e,%.8e ", val[0], val[1]);
+		cheapest_route::output_buffer buffer{f};
+		buffer.write(R"xml(<svg width=")xml")
+			.write(static_cast<int64_t>(dom_scaled[0]))
+			.write(R"xml(" height=")xml")
+			.write(static_cast<int64_t>(dom_scaled[1]))
+			.write(R"xml(" xmlns="http://www.w3.org/2000/svg">
+<g transform="scale()xml")
+			.write(static_cast<double>(factors.x()))
+			.write(' ')
+			.write(static_cast<double>(factors.y()))
+			.write(R"xml()">
+)xml");
+
+		std::ranges::for_each(paths, [&buffer, unit_factor](auto const& item){
+			buffer.write(R"xml(<polyline stroke="blue" points=")xml");
+			std::ranges::for_each(*item.nodes, [&buffer, unit_factor](auto const& item){
+				auto const val = unit_factor*cheapest_route::vec<double, 2>{item.loc};
+				buffer.write(val[0]).write(',').write(val[1]).write(' ');
+			});
+			buffer.write(R"xml(" fill="none"/>
+)xml");
 		});
-		fputs(R"(" fill="none"/>
-</g>
-</svg>)", f);
+		buffer.write(R"(</g>
+</svg>)");
+		buffer.flush();
 	}
 
 	void encode_txt(FILE* f,
 		cheapest_route::length_unit,
 		cheapest_route::scaling_factors world_scale,
 		cheapest_route::search_domain,
-		cheapest_route::path const& nodes,
-		float const* elevation_profile
+		std::span<cheapest_route::path_with_elevation const> paths
 	)
 	{
-		for(size_t k = 0 ; k != std::size(nodes); ++k)
+		cheapest_route::output_buffer buffer{f};
+		for(size_t l = 0; l != std::size(paths); ++l)
+		{
+			// Separate paths by an empty line
+			if(l != 0)
+			{ buffer.write('\n'); }
+
+			auto const& nodes = *paths[l].nodes;
+			auto const elevation_profile = paths[l].elevation_profile;
+			for(size_t k = 0 ; k != std::size(nodes); ++k)
+			{
+				auto const& item = nodes[k];
+				auto const loc_scaled = world_scale*cheapest_route::vec<float, 4>{static_cast<float>(item.loc[0]),
+					static_cast<float>(item.loc[1]),
+					elevation_profile[k],
+					0.0f};
+				buffer.write(static_cast<double>(loc_scaled[0])).write(' ')
+					.write(static_cast<double>(loc_scaled[1])).write(' ')
+					.write(static_cast<double>(loc_scaled[2])).write(' ')
+					.write(item.integrated_cost).write('\n');
+			}
+		}
+		buffer.flush();
+	}
+
+	template<class Func>
+	void write_json_array(cheapest_route::output_buffer& buffer, size_t n, Func&& get_value)
+	{
+		buffer.write('[');
+		for(size_t k = 0; k != n; ++k)
 		{
-			auto const& item = nodes[k];
-			auto const loc_scaled = world_scale*cheapest_route::vec<float, 4>{static_cast<float>(item.loc[0]),
-				static_cast<float>(item.loc[1]),
-				elevation_profile[k],
-				0.0f};
-			fprintf(f, "%.8e %.8e %.8e %.8e\n", loc_scaled[0], loc_scaled[1], loc_scaled[2], item.integrated_cost);
+			if(k != 0)
+			{ buffer.write(", "); }
+			buffer.write(static_cast<double>(get_value(k)));
 		}
+		buffer.write(']');
 	}
 
 	void encode_json(FILE* f,
 		cheapest_route::length_unit lu,
 		cheapest_route::scaling_factors world_scale,
 		cheapest_route::search_domain domain,
-		cheapest_route::path const& nodes,
-		float const* elevation_profile)
+		std::span<cheapest_route::path_with_elevation const> paths)
 	{
-		std::string x_vals;
-		std::string y_vals;
-		std::string z_vals;
-		std::string integrated_cost;
-
-		auto gen_item = [](size_t k, double value) {
-			char buffer[20];
-			sprintf(buffer, "%.8e", value);
-			return std::string{k == 0 ? "" : ", "}.append(buffer);
-		};
-
-		for(size_t k = 0; k!= std::size(nodes); ++k)
-		{
-			x_vals += gen_item(k, nodes[k].loc[0]);
-			y_vals += gen_item(k, nodes[k].loc[1]);
-			z_vals += gen_item(k, elevation_profile[k]);
-			integrated_cost += gen_item(k, nodes[k].integrated_cost);
-		}
-
-		fprintf(f, R"json({
+		cheapest_route::output_buffer buffer{f};
+		buffer.write(R"json({
 	"cheapest_route": {
 		"domain_size": {
-			"width": %ld,
-			"height": %ld
+			"width": )json")
+			.write(domain.width())
+			.write(R"json(,
+			"height": )json")
+			.write(domain.height())
+			.write(R"json(
 		},
-		"length_unit": "%s",
-		"world_scale": "%.8e %.8e %.8e %.8e",
-		"path": {
-			"x": [%s],
-			"y": [%s],
-			"z": [%s],
-			"integrated_cost": [%s]
+		"length_unit": ")json")
+			.write(lu.name())
+			.write(R"json(",
+		"world_scale": ")json")
+			.write(static_cast<double>(world_scale.x())).write(' ')
+			.write(static_cast<double>(world_scale.y())).write(' ')
+			.write(static_cast<double>(world_scale.z())).write(' ')
+			.write(0.0)
+			.write("\",\n");
+
+		// A single path is written as an object, to be compatible with older readers
+		if(std::size(paths) == 1)
+		{
+			buffer.write("\t\t\"path\": ");
+			cheapest_route::write_json_path(buffer, paths[0], "\t\t");
 		}
+		else
+		{
+			buffer.write("\t\t\"paths\": [");
+			for(size_t k = 0; k != std::size(paths); ++k)
+			{
+				buffer.write(k == 0 ? "\n\t\t\t" : ",\n\t\t\t");
+				cheapest_route::write_json_path(buffer, paths[k], "\t\t\t");
+			}
+			buffer.write("\n\t\t]");
+		}
+		buffer.write(R"json(
 	}
-})json",
-			domain.width(),
-			domain.height(),
-			lu.name(),
-			world_scale.x(), world_scale.y(), world_scale.z(), 0.0,
-			x_vals.c_str(),
-			y_vals.c_str(),
-			z_vals.c_str(),
-			integrated_cost.c_str()
-		);
+})json");
+		buffer.flush();
 	}
 
+	template<class T>
+	requires(std::is_arithmetic_v<T>)
+	void write_le(cheapest_route::output_buffer& buffer, T value)
+	{
+		std::array<char, sizeof(T)> bytes;
+		memcpy(std::data(bytes), &value, sizeof(T));
+		if constexpr(std::endian::native == std::endian::big)
+		{ std::ranges::reverse(bytes); }
+		buffer.write_bytes(std::data(bytes), std::size(bytes));
+	}
+
+	template<class Func>
+	void write_binary_column(cheapest_route::output_buffer& buffer, size_t n, Func&& get_value)
+	{
+		for(size_t k = 0; k != n; ++k)
+		{ write_le(buffer, static_cast<double>(get_value(k))); }
+	}
+
+	constexpr size_t binary_header_size = 80;
+
+	void write_binary_record(cheapest_route::output_buffer& buffer,
+		cheapest_route::scaling_factors world_scale,
+		cheapest_route::search_domain domain,
+		std::array<char, 16> const& unit_name,
+		cheapest_route::path_with_elevation const& item)
+	{
+		auto const& nodes = *item.nodes;
+		auto const elevation_profile = item.elevation_profile;
+		auto const n = std::size(nodes);
+		buffer.write("CHRTPATH");
+		write_le(buffer, uint32_t{1});
+		write_le(buffer, static_cast<uint32_t>(binary_header_size));
+		write_le(buffer, static_cast<uint64_t>(n));
+		write_le(buffer, static_cast<int64_t>(domain.width()));
+		write_le(buffer, static_cast<int64_t>(domain.height()));
+		write_le(buffer, static_cast<double>(world_scale.x()));
+		write_le(buffer, static_cast<double>(world_scale.y()));
+		write_le(buffer, static_cast<double>(world_scale.z()));
+		buffer.write_bytes(std::data(unit_name), std::size(unit_name));
+
+		write_binary_column(buffer, n, [&nodes](size_t k){ return nodes[k].loc[0]; });
+		write_binary_column(buffer, n, [&nodes](size_t k){ return nodes[k].loc[1]; });
+		write_binary_column(buffer, n, [elevation_profile](size_t k){ return elevation_profile[k]; });
+		write_binary_column(buffer, n, [&nodes](size_t k){ return nodes[k].integrated_cost; });
+	}
+
+	void encode_binary(FILE* f,
+		cheapest_route::length_unit lu,
+		cheapest_route::scaling_factors world_scale,
+		cheapest_route::search_domain domain,
+		std::span<cheapest_route::path_with_elevation const> paths)
+	{
+		std::array<char, 16> unit_name{};
+		std::string_view const unit_name_src{lu.name()};
+		if(std::size(unit_name_src) >= std::size(unit_name))
+		{ throw std::runtime_error{"Length unit name is too long for the binary format"}; }
+		std::ranges::copy(unit_name_src, std::begin(unit_name));
+
+		cheapest_route::output_buffer buffer{f};
+		for(auto const& item : paths)
+		{ write_binary_record(buffer, world_scale, domain, unit_name, item); }
+		buffer.flush();
+	}
 }
 
 cheapest_route::path_encoder::path_encoder(std::string_view str)
@@ -122,7 +222,28 @@ cheapest_route::path_encoder::path_encoder(std::string_view str)
 	if(str == "json")
 	{ encode = encode_json; }
 	else
+	if(str == "bin")
+	{ encode = encode_binary; }
+	else
 	{
 		throw std::runtime_error{"Unsupported output format"};
 	}
 }
+
+void cheapest_route::write_json_path(output_buffer& buffer,
+	path_with_elevation const& item,
+	std::string_view indent)
+{
+	auto const& nodes = *item.nodes;
+	auto const elevation_profile = item.elevation_profile;
+	auto const n = std::size(nodes);
+	buffer.write("{\n").write(indent).write("\t\"x\": ");
+	write_json_array(buffer, n, [&nodes](size_t k){ return nodes[k].loc[0]; });
+	buffer.write(",\n").write(indent).write("\t\"y\": ");
+	write_json_array(buffer, n, [&nodes](size_t k){ return nodes[k].loc[1]; });
+	buffer.write(",\n").write(indent).write("\t\"z\": ");
+	write_json_array(buffer, n, [elevation_profile](size_t k){ return elevation_profile[k]; });
+	buffer.write(",\n").write(indent).write("\t\"integrated_cost\": ");
+	write_json_array(buffer, n, [&nodes](size_t k){ return nodes[k].integrated_cost; });
+	buffer.write('\n').write(indent).write('}');
+}
@@ -9,9 +9,22 @@
 #include "lib/search.hpp"
 
 #include <cstdio>
+#include <span>
+#include <string_view>
 
 namespace cheapest_route
 {
+	struct path_with_elevation
+	{
+		path const* nodes;
+		float const* elevation_profile;
+	};
+
+	class output_buffer;
+
+	// Writes item as a json object with the arrays x, y, z, and integrated_cost
+	void write_json_path(output_buffer& buffer, path_with_elevation const& item, std::string_view indent);
+
 	class path_encoder
 	{
 	public:
@@ -23,15 +36,24 @@ namespace cheapest_route
 			search_domain domain,
 			path const& nodes,
 			float const* elevation_profile) const
-		{ encode(f, lu, factors, domain, nodes, elevation_profile); }
+		{
+			path_with_elevation const item{&nodes, elevation_profile};
+			encode(f, lu, factors, domain, std::span{&item, 1});
+		}
+
+		void operator()(FILE* f,
+			length_unit lu,
+			scaling_factors factors,
+			search_domain domain,
+			std::span<path_with_elevation const> paths) const
+		{ encode(f, lu, factors, domain, paths); }
 
 	private:
 		using func = void (*)(FILE* f,
 			length_unit lu,
 			scaling_factors factors,
 			search_domain domain,
-			path const& nodes,
-			float const* elevation_profile);
+			std::span<path_with_elevation const> paths);
 		func encode;
 	};
 }
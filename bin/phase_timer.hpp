@@ -0,0 +1,50 @@
+#ifndef CHEAPESTROUTE_PHASETIMER_HPP
+#define CHEAPESTROUTE_PHASETIMER_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	// Measures the wall time of consecutive phases
+	class phase_timer
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		struct phase
+		{
+			char const* name;
+			double duration;
+		};
+
+		phase_timer():m_phase_start{clock::now()}
+		{}
+
+		// Ends the current phase, and starts the next one
+		void end_phase(char const* name)
+		{
+			auto const now = clock::now();
+			m_phases.push_back(phase{name, std::chrono::duration<double>(now - m_phase_start).count()});
+			m_phase_start = now;
+		}
+
+		std::span<phase const> phases() const
+		{ return m_phases; }
+
+	private:
+		clock::time_point m_phase_start;
+		std::vector<phase> m_phases;
+	};
+
+	// Writes one line per phase, with its name and duration in seconds
+	inline void write(FILE* dest, phase_timer const& timer)
+	{
+		for(auto const& item : timer.phases())
+		{ fprintf(dest, "%s %.9g\n", item.name, item.duration); }
+	}
+}
+
+#endif
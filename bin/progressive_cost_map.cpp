@@ -0,0 +1,77 @@
+//@	{"target":{"name":"progressive_cost_map.o"}}
+
+#include "./progressive_cost_map.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	uint32_t block_count(uint32_t height)
+	{
+		return (height + cheapest_route::progressive_cost_map::rows_per_block - 1)
+			/cheapest_route::progressive_cost_map::rows_per_block;
+	}
+}
+
+cheapest_route::progressive_cost_map::progressive_cost_map(std::filesystem::path const& filename, uint32_t first_row):
+	progressive_cost_map{image_row_reader{filename}, first_row}
+{}
+
+cheapest_route::progressive_cost_map::progressive_cost_map(image_row_reader&& src, uint32_t first_row):
+	m_pixels{src.width(), src.height()},
+	m_loaded{std::make_unique<std::atomic<bool>[]>(block_count(src.height()))}
+{
+	auto const first_block = std::min(first_row, std::max(src.height(), 1u) - 1)/rows_per_block;
+	m_loader = std::jthread{[this, src = std::move(src), first_block](std::stop_token stop) mutable {
+		load(src, first_block, stop);
+	}};
+}
+
+void cheapest_route::progressive_cost_map::wait_for_block(uint32_t block) const
+{
+	std::unique_lock lock{m_mutex};
+	m_block_loaded.wait(lock, [this, block]() {
+		return m_loaded[block].load(std::memory_order_relaxed) || m_error != nullptr;
+	});
+
+	if(!m_loaded[block].load(std::memory_order_relaxed))
+	{ std::rethrow_exception(m_error); }
+}
+
+void cheapest_route::progressive_cost_map::load(image_row_reader& src, uint32_t first_block, std::stop_token const& stop)
+{
+	try
+	{
+		auto const count = block_count(height());
+		auto const load_block = [this, &src](uint32_t block) {
+			auto const begin = block*rows_per_block;
+			src.read_rows(m_pixels.pixels(), begin, std::min(begin + rows_per_block, height()));
+			{
+				std::lock_guard lock{m_mutex};
+				m_loaded[block].store(true, std::memory_order_release);
+			}
+			m_block_loaded.notify_all();
+		};
+
+		// Alternate between the blocks below and above the first one, until both ends are reached
+		for(uint32_t k = 0; first_block + k < count || k <= first_block; ++k)
+		{
+			if(stop.stop_requested())
+			{ return; }
+
+			if(first_block + k < count)
+			{ load_block(first_block + k); }
+
+			if(k != 0 && k <= first_block)
+			{ load_block(first_block - k); }
+		}
+	}
+	catch(...)
+	{
+		{
+			std::lock_guard lock{m_mutex};
+			m_error = std::current_exception();
+		}
+		m_block_loaded.notify_all();
+	}
+}
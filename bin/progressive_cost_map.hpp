@@ -0,0 +1,99 @@
+//@	{"dependencies_extra":[{"ref":"./progressive_cost_map.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_PROGRESSIVECOSTMAP_HPP
+#define CHEAPESTROUTE_PROGRESSIVECOSTMAP_HPP
+
+#include "./image_loader.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace cheapest_route
+{
+	class progressive_cost_map;
+
+	// A view of a cost map that is still being loaded. Reading a pixel blocks until its row has
+	// been decoded.
+	class progressive_cost_map_span
+	{
+	public:
+		explicit progressive_cost_map_span(progressive_cost_map const& map);
+
+		uint32_t width() const
+		{ return m_pixels.width(); }
+
+		uint32_t height() const
+		{ return m_pixels.height(); }
+
+		inline cost_values operator()(uint32_t x, uint32_t y) const;
+
+	private:
+		progressive_cost_map const* m_map;
+		pixel_store::image_span<cost_values const> m_pixels;
+	};
+
+	// Decodes a cost map on a separate thread, starting with the rows around first_row and
+	// continuing outwards in both directions
+	class progressive_cost_map
+	{
+	public:
+		static constexpr uint32_t rows_per_block = 32;
+
+		// The header is read before the constructor returns, so errors in it are reported before
+		// the cost map is used
+		explicit progressive_cost_map(std::filesystem::path const& filename, uint32_t first_row);
+
+		progressive_cost_map_span pixels() const
+		{ return progressive_cost_map_span{*this}; }
+
+		pixel_store::image_span<cost_values const> loaded_pixels() const
+		{ return m_pixels.pixels(); }
+
+		uint32_t width() const
+		{ return m_pixels.width(); }
+
+		uint32_t height() const
+		{ return m_pixels.height(); }
+
+		void wait_for_row(uint32_t y) const
+		{
+			if(m_loaded[y/rows_per_block].load(std::memory_order_acquire)) [[likely]]
+			{ return; }
+			wait_for_block(y/rows_per_block);
+		}
+
+	private:
+		explicit progressive_cost_map(image_row_reader&& src, uint32_t first_row);
+
+		void wait_for_block(uint32_t block) const;
+
+		void load(image_row_reader& src, uint32_t first_block, std::stop_token const& stop);
+
+		image_type m_pixels;
+		std::unique_ptr<std::atomic<bool>[]> m_loaded;
+		mutable std::mutex m_mutex;
+		mutable std::condition_variable m_block_loaded;
+		std::exception_ptr m_error;
+
+		// Declared last, so the loader is stopped before anything it writes to is destroyed
+		std::jthread m_loader;
+	};
+
+	inline progressive_cost_map_span::progressive_cost_map_span(progressive_cost_map const& map):
+		m_map{&map},
+		m_pixels{map.loaded_pixels()}
+	{}
+
+	inline cost_values progressive_cost_map_span::operator()(uint32_t x, uint32_t y) const
+	{
+		m_map->wait_for_row(y);
+		return m_pixels(x, y);
+	}
+}
+
+#endif
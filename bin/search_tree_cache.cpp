@@ -0,0 +1,124 @@
+//@	{"target":{"name":"search_tree_cache.o"}}
+
+#include "./search_tree_cache.hpp"
+#include "./io_utils.hpp"
+#include "./hasher.hpp"
+
+#include "lib/passability.hpp"
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <unistd.h>
+
+namespace
+{
+	constexpr std::array<char, 8> magic{'C', 'H', 'R', 'T', 'T', 'R', 'E', 'E'};
+	constexpr uint32_t format_version = 2;
+
+	struct file_header
+	{
+		std::array<char, 8> magic;
+		uint32_t version;
+		uint32_t header_size;
+		cheapest_route::cost_function_key key;
+		int64_t width;
+		int64_t height;
+		int64_t root_x;
+		int64_t root_y;
+		uint64_t node_count;
+	};
+
+	static_assert(sizeof(file_header) == 112);
+}
+
+cheapest_route::cost_function_key
+cheapest_route::search_tree_key(cost_function const& f, to<int64_t> root, search_options const& options)
+{
+	hasher h;
+	h.add(format_version);
+	add(h, f)
+		.add(root.value())
+		.add(options.max_cost);
+
+	if(options.bounds.has_value())
+	{
+		h.add(options.bounds->min().value())
+			.add(options.bounds->max().value());
+	}
+
+	if(options.passability != nullptr)
+	{ h.add(std::as_bytes(options.passability->bits)); }
+
+	return cost_function_key{h.value(), get_cost_parameters(f)};
+}
+
+std::filesystem::path
+cheapest_route::search_tree_filename(std::filesystem::path const& cache_dir, cost_function_key const& key)
+{
+	std::array<char, 17> name{};
+	snprintf(std::data(name), std::size(name), "%016lx", key.hash);
+	return cache_dir / std::string{std::data(name)}.append(".crtree");
+}
+
+void cheapest_route::store(search_tree_view const& tree,
+	cost_function_key const& key,
+	std::filesystem::path const& filename)
+{
+	file_header const header{
+		magic,
+		format_version,
+		sizeof(file_header),
+		key,
+		tree.domain.width(),
+		tree.domain.height(),
+		tree.root[0],
+		tree.root[1],
+		std::size(tree.costs)
+	};
+
+	// Write to a temporary file first, so concurrent readers never see a partial tree
+	auto tmp_name = filename;
+	tmp_name += std::string{"."}.append(std::to_string(getpid())).append(".tmp");
+	{
+		output_file const dest{tmp_name};
+		if(dest.get() == nullptr)
+		{ throw std::runtime_error{std::string{"Failed to create "}.append(tmp_name.string())}; }
+
+		if(fwrite(&header, sizeof(header), 1, dest.get()) != 1
+			|| fwrite(std::data(tree.costs), sizeof(float), std::size(tree.costs), dest.get()) != std::size(tree.costs)
+			|| fwrite(std::data(tree.directions), 1, std::size(tree.directions), dest.get()) != std::size(tree.directions))
+		{ throw std::runtime_error{std::string{"Failed to write "}.append(tmp_name.string())}; }
+	}
+	std::filesystem::rename(tmp_name, filename);
+}
+
+std::optional<cheapest_route::cached_search_tree>
+cheapest_route::load_search_tree(std::filesystem::path const& filename, cost_function_key const& key)
+{
+	if(!std::filesystem::exists(filename))
+	{ return std::nullopt; }
+
+	mapped_file file{filename};
+	auto const data = file.data();
+	if(std::size(data) < sizeof(file_header))
+	{ return std::nullopt; }
+
+	file_header header;
+	memcpy(&header, std::data(data), sizeof(header));
+	auto const domain = search_domain{header.width, header.height};
+	if(header.magic != magic || header.version != format_version || header.header_size != sizeof(file_header)
+		|| header.key != key || header.node_count != lattice_node_count(domain)
+		|| std::size(data) != sizeof(file_header) + header.node_count*(sizeof(float) + sizeof(uint8_t)))
+	{ return std::nullopt; }
+
+	auto const costs = reinterpret_cast<float const*>(std::data(data) + sizeof(file_header));
+	auto const directions = reinterpret_cast<uint8_t const*>(costs + header.node_count);
+	search_tree_view const view{
+		domain,
+		to<int64_t>{header.root_x, header.root_y},
+		std::span{costs, header.node_count},
+		std::span{directions, header.node_count}
+	};
+	return cached_search_tree{std::move(file), view};
+}
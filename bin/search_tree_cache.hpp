@@ -0,0 +1,45 @@
+//@	{"dependencies_extra":[{"ref":"./search_tree_cache.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_SEARCHTREECACHE_HPP
+#define CHEAPESTROUTE_SEARCHTREECACHE_HPP
+
+#include "./cost_function.hpp"
+#include "./hasher.hpp"
+#include "./mapped_file.hpp"
+
+#include "lib/search_tree.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace cheapest_route
+{
+	// Identifies a search tree by everything that affects its contents
+	cost_function_key search_tree_key(cost_function const& f, to<int64_t> root, search_options const& options);
+
+	class cached_search_tree
+	{
+	public:
+		explicit cached_search_tree(mapped_file&& file, search_tree_view const& view):
+			m_file{std::move(file)},
+			m_view{view}
+		{}
+
+		search_tree_view const& view() const
+		{ return m_view; }
+
+	private:
+		mapped_file m_file;
+		search_tree_view m_view;
+	};
+
+	void store(search_tree_view const& tree, cost_function_key const& key, std::filesystem::path const& filename);
+
+	std::optional<cached_search_tree>
+	load_search_tree(std::filesystem::path const& filename, cost_function_key const& key);
+
+	std::filesystem::path search_tree_filename(std::filesystem::path const& cache_dir, cost_function_key const& key);
+}
+
+#endif
@@ -0,0 +1,101 @@
+//@	{"target":{"name":"tile_file.o"}}
+
+#include "./tile_file.hpp"
+#include "./io_utils.hpp"
+
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+	// Tile files are only exchanged between processes of the same build, so values are stored
+	// in native byte order
+	constexpr std::array<char, 8> costs_magic{'C', 'H', 'R', 'T', 'T', 'C', 'S', 'T'};
+	constexpr std::array<char, 8> route_magic{'C', 'H', 'R', 'T', 'T', 'R', 'T', 'E'};
+
+	struct file_header
+	{
+		std::array<char, 8> magic;
+		int64_t tile_x;
+		int64_t tile_y;
+		uint64_t node_count;
+	};
+
+	template<class T>
+	void write_values(FILE* f, std::span<T const> values, std::filesystem::path const& filename)
+	{
+		if(fwrite(std::data(values), sizeof(T), std::size(values), f) != std::size(values))
+		{ throw std::runtime_error{std::string{"Failed to write "}.append(filename.string())}; }
+	}
+
+	template<class T>
+	void read_values(FILE* f, std::span<T> values, std::filesystem::path const& filename)
+	{
+		if(fread(std::data(values), sizeof(T), std::size(values), f) != std::size(values))
+		{ throw std::runtime_error{std::string{"Failed to read "}.append(filename.string())}; }
+	}
+
+	cheapest_route::output_file create(std::filesystem::path const& filename)
+	{
+		cheapest_route::output_file ret{filename};
+		if(ret.get() == nullptr)
+		{ throw std::runtime_error{std::string{"Failed to create "}.append(filename.string())}; }
+		return ret;
+	}
+
+	file_header read_header(FILE* f, std::array<char, 8> const& magic, std::filesystem::path const& filename)
+	{
+		file_header ret;
+		read_values(f, std::span{&ret, 1}, filename);
+		if(ret.magic != magic)
+		{ throw std::runtime_error{std::string{"Unsupported tile file "}.append(filename.string())}; }
+		return ret;
+	}
+}
+
+void cheapest_route::store(tile_costs const& costs, std::filesystem::path const& filename)
+{
+	auto const dest = create(filename);
+	file_header const header{costs_magic, costs.tile[0], costs.tile[1], std::size(costs.nodes)};
+	write_values(dest.get(), std::span{&header, 1}, filename);
+	write_values(dest.get(), std::span{costs.nodes}, filename);
+	write_values(dest.get(), std::span{costs.costs}, filename);
+}
+
+cheapest_route::tile_costs cheapest_route::load_tile_costs(std::filesystem::path const& filename)
+{
+	input_file const src{filename};
+	if(src.get() == nullptr)
+	{ throw std::runtime_error{std::string{"Failed to open "}.append(filename.string())}; }
+
+	auto const header = read_header(src.get(), costs_magic, filename);
+	tile_costs ret{vec<int64_t, 2>{header.tile_x, header.tile_y},
+		std::vector<vec<int64_t, 2>>(header.node_count),
+		std::vector<float>(header.node_count*header.node_count)};
+	read_values(src.get(), std::span{ret.nodes}, filename);
+	read_values(src.get(), std::span{ret.costs}, filename);
+	return ret;
+}
+
+void cheapest_route::store(tile_route const& route, std::filesystem::path const& filename)
+{
+	auto const dest = create(filename);
+	file_header const header{route_magic, 0, 0, std::size(route.nodes)};
+	write_values(dest.get(), std::span{&header, 1}, filename);
+	write_values(dest.get(), std::span{route.nodes}, filename);
+	write_values(dest.get(), std::span{route.elevation_profile}, filename);
+}
+
+cheapest_route::tile_route cheapest_route::load_tile_route(std::filesystem::path const& filename)
+{
+	input_file const src{filename};
+	if(src.get() == nullptr)
+	{ throw std::runtime_error{std::string{"Failed to open "}.append(filename.string())}; }
+
+	auto const header = read_header(src.get(), route_magic, filename);
+	tile_route ret{path(header.node_count), std::vector<float>(header.node_count)};
+	read_values(src.get(), std::span{ret.nodes}, filename);
+	read_values(src.get(), std::span{ret.elevation_profile}, filename);
+	return ret;
+}
@@ -0,0 +1,29 @@
+//@	{"dependencies_extra":[{"ref":"./tile_file.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_TILEFILE_HPP
+#define CHEAPESTROUTE_TILEFILE_HPP
+
+#include "lib/tiled_search.hpp"
+
+#include <filesystem>
+#include <vector>
+
+namespace cheapest_route
+{
+	// The part of a route that was found within one tile, in domain coordinates
+	struct tile_route
+	{
+		path nodes;
+		std::vector<float> elevation_profile;
+	};
+
+	void store(tile_costs const& costs, std::filesystem::path const& filename);
+
+	tile_costs load_tile_costs(std::filesystem::path const& filename);
+
+	void store(tile_route const& route, std::filesystem::path const& filename);
+
+	tile_route load_tile_route(std::filesystem::path const& filename);
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef CHEAPESTROUTE_TILEDIMAGE_HPP
+#define CHEAPESTROUTE_TILEDIMAGE_HPP
+
+#include "lib/memory_layout.hpp"
+
+#include "pixel_store/image.hpp"
+
+#include <memory>
+#include <span>
+
+namespace cheapest_route
+{
+	// A view of an image that is stored using grid_layout
+	template<class T>
+	class tiled_image_span
+	{
+	public:
+		tiled_image_span() = default;
+
+		explicit tiled_image_span(T* data, uint32_t width, uint32_t height):
+			m_data{data},
+			m_width{width},
+			m_height{height}
+		{}
+
+		template<class U>
+		tiled_image_span(tiled_image_span<U> other):
+			m_data{other.data()},
+			m_width{other.width()},
+			m_height{other.height()}
+		{}
+
+		uint32_t width() const
+		{ return m_width; }
+
+		uint32_t height() const
+		{ return m_height; }
+
+		T* data() const
+		{ return m_data; }
+
+		T& operator()(uint32_t x, uint32_t y) const
+		{ return m_data[grid_index(x, y, m_width)]; }
+
+	private:
+		T* m_data{};
+		uint32_t m_width{};
+		uint32_t m_height{};
+	};
+
+	// The elements of img, including any padding
+	template<class T>
+	std::span<T> pixel_storage(tiled_image_span<T> img)
+	{ return std::span{img.data(), grid_storage_size(img.width(), img.height())}; }
+
+	template<class T>
+	class tiled_image
+	{
+	public:
+		explicit tiled_image(pixel_store::image_span<T const> src):
+			m_data{std::make_unique<T[]>(grid_storage_size(src.width(), src.height()))},
+			m_width{src.width()},
+			m_height{src.height()}
+		{
+			auto const dest = pixels();
+			for(uint32_t y = 0; y != m_height; ++y)
+			{
+				for(uint32_t x = 0; x != m_width; ++x)
+				{ dest(x, y) = src(x, y); }
+			}
+		}
+
+		tiled_image_span<T> pixels()
+		{ return tiled_image_span<T>{m_data.get(), m_width, m_height}; }
+
+		tiled_image_span<T const> pixels() const
+		{ return tiled_image_span<T const>{m_data.get(), m_width, m_height}; }
+
+		uint32_t width() const
+		{ return m_width; }
+
+		uint32_t height() const
+		{ return m_height; }
+
+	private:
+		std::unique_ptr<T[]> m_data;
+		uint32_t m_width;
+		uint32_t m_height;
+	};
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CHEAPESTROUTE_WAYPOINTLIST_HPP
+#define CHEAPESTROUTE_WAYPOINTLIST_HPP
+
+#include "lib/vec.hpp"
+
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace cheapest_route
+{
+	// A list of points written as ((x,y),(x,y),...)
+	class waypoint_list
+	{
+	public:
+		explicit waypoint_list(std::string_view str)
+		{
+			auto const is_space = [](char ch) { return ch >= '\0' && ch <= ' '; };
+			auto const skip_space = [&]() {
+				while(!std::empty(str) && is_space(str.front()))
+				{ str.remove_prefix(1); }
+			};
+
+			skip_space();
+			if(std::empty(str) || str.front() != '(')
+			{ throw std::runtime_error{"Expected ( in beginning of point list"}; }
+			str.remove_prefix(1);
+
+			while(true)
+			{
+				skip_space();
+				auto const end = str.find(')');
+				if(end == std::string_view::npos)
+				{ throw std::runtime_error{"Premature end of point list"}; }
+
+				m_points.push_back(vec<int64_t, 2>{str.substr(0, end + 1)});
+				str.remove_prefix(end + 1);
+				skip_space();
+				if(std::empty(str))
+				{ throw std::runtime_error{"Premature end of point list"}; }
+
+				auto const ch_in = str.front();
+				str.remove_prefix(1);
+				if(ch_in == ')')
+				{ break; }
+
+				if(ch_in != ',')
+				{ throw std::runtime_error{"Expected , or ) after point"}; }
+			}
+
+			skip_space();
+			if(!std::empty(str))
+			{ throw std::runtime_error{"Unexpected characters after point list"}; }
+		}
+
+		std::span<vec<int64_t, 2> const> points() const
+		{ return m_points; }
+
+	private:
+		std::vector<vec<int64_t, 2>> m_points;
+	};
+}
+
+#endif
@@ -0,0 +1,89 @@
+//@	{"target":{"name":"worker_processes.o"}}
+
+#include "./worker_processes.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+namespace
+{
+	// Returns -1 if the process could not be started
+	pid_t start_process(std::filesystem::path const& executable, std::vector<std::string> const& args)
+	{
+		std::vector<char*> argv;
+		argv.push_back(const_cast<char*>(executable.c_str()));
+		for(auto const& item : args)
+		{ argv.push_back(const_cast<char*>(item.c_str())); }
+		argv.push_back(nullptr);
+
+		auto const pid = fork();
+		if(pid == 0)
+		{
+			execv(executable.c_str(), std::data(argv));
+			_exit(127);
+		}
+		return pid;
+	}
+
+	// Waits until one of the processes in running exits, and removes it from running. Returns an
+	// error message if the process failed, or nullptr if it succeeded.
+	char const* wait_for_any(std::vector<pid_t>& running)
+	{
+		while(true)
+		{
+			int status = 0;
+			auto const pid = waitpid(-1, &status, 0);
+			if(pid == -1)
+			{
+				if(errno == EINTR)
+				{ continue; }
+
+				// There are no children left to wait for
+				running.clear();
+				return "Failed to wait for a worker process";
+			}
+
+			if(auto const i = std::ranges::find(running, pid); i != std::end(running))
+			{
+				running.erase(i);
+				return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? nullptr : "A worker process failed";
+			}
+		}
+	}
+}
+
+void cheapest_route::run_worker_processes(std::filesystem::path const& executable,
+	std::span<std::vector<std::string> const> jobs,
+	size_t process_count)
+{
+	process_count = std::max(process_count, size_t{1});
+	size_t next_job = 0;
+	std::vector<pid_t> running;
+	char const* error = nullptr;
+	while(!std::empty(running) || (next_job != std::size(jobs) && error == nullptr))
+	{
+		if(std::size(running) != process_count && next_job != std::size(jobs) && error == nullptr)
+		{
+			auto const pid = start_process(executable, jobs[next_job]);
+			if(pid == -1)
+			{ error = "Failed to start a worker process"; }
+			else
+			{
+				running.push_back(pid);
+				++next_job;
+			}
+			continue;
+		}
+
+		// Keep the first error, but wait for every running process before reporting it
+		if(auto const res = wait_for_any(running); res != nullptr && error == nullptr)
+		{ error = res; }
+	}
+
+	if(error != nullptr)
+	{ throw std::runtime_error{error}; }
+}
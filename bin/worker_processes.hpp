@@ -0,0 +1,21 @@
+//@	{"dependencies_extra":[{"ref":"./worker_processes.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_WORKERPROCESSES_HPP
+#define CHEAPESTROUTE_WORKERPROCESSES_HPP
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cheapest_route
+{
+	// Runs executable once for every job, with the job as its arguments, in at most process_count
+	// processes at a time. If any job fails, or a process cannot be started, the remaining jobs are
+	// not started, and an exception is thrown when the running ones have finished.
+	void run_worker_processes(std::filesystem::path const& executable,
+		std::span<std::vector<std::string> const> jobs,
+		size_t process_count);
+}
+
+#endif
@@ -6,32 +6,73 @@ bl_info = {
 
 import bpy
 import json
+import numpy
+
+binary_header = numpy.dtype([
+	('magic', 'S8'),
+	('version', '<u4'),
+	('header_size', '<u4'),
+	('node_count', '<u8'),
+	('width', '<i8'),
+	('height', '<i8'),
+	('world_scale', '<f8', (3,)),
+	('length_unit', 'S16')
+])
+
+def add_curve(x, y, z, world_scale, w, h):
+	curve = bpy.data.curves.new('curve', 'CURVE')
+	spline = curve.splines.new(type='NURBS')
 
-def read_some_data(context, filepath):
+	# a spline point for each point
+	spline.points.add(len(x)-1)
+
+	# assign the point coordinates to the spline points
+	co = numpy.empty((len(x), 4), dtype=numpy.float32)
+	co[:, 0] = (x - 0.5*w)*world_scale[0]
+	co[:, 1] = -(y - 0.5*h)*world_scale[1]
+	co[:, 2] = z*world_scale[2]
+	co[:, 3] = 1.0
+	spline.points.foreach_set('co', co.ravel())
+
+	# make a new object with the curve
+	obj = bpy.data.objects.new('cheapest_route', curve)
+	bpy.context.scene.collection.objects.link(obj)
+
+def read_json_data(context, filepath):
 	with open(filepath, 'r', encoding='utf-8') as f:
 		data = json.load(f)
 
-	path = data['cheapest_route']['path']
+	paths = data['cheapest_route']['paths'] if 'paths' in data['cheapest_route'] else [data['cheapest_route']['path']]
 	world_scale = [float(value) for value in data['cheapest_route']['world_scale'].split(' ')]
 	w = data['cheapest_route']['domain_size']['width']
 	h = data['cheapest_route']['domain_size']['height']
 
-	curve = bpy.data.curves.new('curve', 'CURVE')
-	spline = curve.splines.new(type='NURBS')
+	for path in paths:
+		add_curve(numpy.asarray(path['x']), numpy.asarray(path['y']), numpy.asarray(path['z']), world_scale, w, h)
 
-	# a spline point for each point
-	spline.points.add(len(path['x'])-1)
+	return {'FINISHED'}
 
-	# assign the point coordinates to the spline points
-	for p, x, y, z in zip(spline.points, path['x'], path['y'], path['z']):
-		p.co = ((x - 0.5*w)*world_scale[0], -(y - 0.5*h)*world_scale[1], z*world_scale[2] , 1.0)
+def read_binary_data(context, filepath):
+	data = numpy.memmap(filepath, dtype=numpy.uint8, mode='r')
+	offset = 0
+	while offset < len(data):
+		header = numpy.frombuffer(data, dtype=binary_header, count=1, offset=offset)[0]
+		if header['magic'] != b'CHRTPATH' or header['version'] != 1:
+			raise ValueError('%s is not a cheapest_route path file'%filepath)
 
-	# make a new object with the curve
-	obj = bpy.data.objects.new('cheapest_route', curve)
-	bpy.context.scene.collection.objects.link(obj)
+		n = int(header['node_count'])
+		offset += int(header['header_size'])
+		columns = numpy.frombuffer(data, dtype='<f8', count=4*n, offset=offset).reshape(4, n)
+		offset += columns.nbytes
+
+		add_curve(columns[0], columns[1], columns[2], header['world_scale'], header['width'], header['height'])
 
 	return {'FINISHED'}
 
+def read_some_data(context, filepath):
+	if filepath.endswith('.bin'):
+		return read_binary_data(context, filepath)
+	return read_json_data(context, filepath)
 
 from bpy_extras.io_utils import ImportHelper
 from bpy.props import StringProperty, BoolProperty, EnumProperty
@@ -46,7 +87,7 @@ class CheapestRoutePathImport(Operator, ImportHelper):
 	filename_ext = ".json"
 
 	filter_glob: StringProperty(
-		default="*.json",
+		default="*.json;*.bin",
 		options={'HIDDEN'},
 		maxlen=255,  # Max internal buffer length, longer would be clamped.
 	)
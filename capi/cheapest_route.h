@@ -0,0 +1,97 @@
+#ifndef CHEAPESTROUTE_CAPI_H
+#define CHEAPESTROUTE_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHEAPEST_ROUTE_API_VERSION 1
+
+/* Return values */
+#define CHEAPEST_ROUTE_OK 0
+#define CHEAPEST_ROUTE_INVALID_ARGUMENT 1
+#define CHEAPEST_ROUTE_SEARCH_FAILED 2
+#define CHEAPEST_ROUTE_BUFFER_TOO_SMALL 3
+#define CHEAPEST_ROUTE_OUT_OF_MEMORY 4
+
+/* Channel index used for channels that are not present in the cost map */
+#define CHEAPEST_ROUTE_NO_CHANNEL (-1)
+
+/* A cost map stored in a caller-owned float buffer. The buffer is not copied, and must stay valid
+ * during the call. Pixel (x, y) starts at data[y*row_stride + x*pixel_stride], and the channels
+ * are found at the given offsets from there. Missing channels use elevation 0, friction 1, and
+ * no wind. */
+typedef struct cheapest_route_cost_map
+{
+	float const* data;
+	uint32_t width;
+	uint32_t height;
+	size_t pixel_stride;
+	size_t row_stride;
+	int32_t elevation_channel;
+	int32_t friction_channel;
+	int32_t wind_x_channel;
+	int32_t wind_y_channel;
+} cheapest_route_cost_map;
+
+/* The same parameters as the corresponding command line options. Set max_cost to INFINITY to
+ * search without a cost limit. */
+typedef struct cheapest_route_parameters
+{
+	double world_scale[3];
+	double friction_strength;
+	double wind_strength[2];
+	double max_cost;
+} cheapest_route_parameters;
+
+typedef struct cheapest_route_node
+{
+	double x;
+	double y;
+	double z;
+	double integrated_cost;
+} cheapest_route_node;
+
+/* Holds buffers that are reused between calls, as well as the latest result. Calls that use the
+ * same workspace are serialized, so use one workspace per thread to run searches in parallel. */
+typedef struct cheapest_route_workspace cheapest_route_workspace;
+
+int cheapest_route_api_version(void);
+
+/* Returns NULL if out of memory */
+cheapest_route_workspace* cheapest_route_workspace_create(void);
+
+void cheapest_route_workspace_destroy(cheapest_route_workspace* workspace);
+
+/* Finds the cheapest route from origin to destination. The number of nodes in the route is
+ * written to node_count. If capacity is too small, CHEAPEST_ROUTE_BUFFER_TOO_SMALL is returned,
+ * and the route can be fetched with cheapest_route_copy_path after growing the buffer. */
+int cheapest_route_find_path(cheapest_route_workspace* workspace,
+	cheapest_route_cost_map const* cost_map,
+	cheapest_route_parameters const* params,
+	int64_t origin_x,
+	int64_t origin_y,
+	int64_t destination_x,
+	int64_t destination_y,
+	cheapest_route_node* path,
+	size_t capacity,
+	size_t* node_count);
+
+/* Copies the route found by the latest successful call to cheapest_route_find_path */
+int cheapest_route_copy_path(cheapest_route_workspace* workspace,
+	cheapest_route_node* path,
+	size_t capacity,
+	size_t* node_count);
+
+/* A description of the latest error. The string is valid until the next call that uses the same
+ * workspace. */
+char const* cheapest_route_last_error(cheapest_route_workspace* workspace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
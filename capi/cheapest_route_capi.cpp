@@ -0,0 +1,224 @@
+//@	{"target":{"name":"cheapest_route_capi.o"}}
+
+#include "./cheapest_route.h"
+
+#include "bin/cost_model.hpp"
+#include "lib/search.hpp"
+
+#include <cmath>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+struct cheapest_route_workspace
+{
+	std::mutex mutex;
+	cheapest_route::search_context context;
+	cheapest_route::path route;
+	std::vector<float> elevation_profile;
+	std::string last_error;
+};
+
+namespace
+{
+	// Presents the caller-owned buffer as an image of cost_values, without copying it
+	class strided_cost_map_span
+	{
+	public:
+		explicit strided_cost_map_span(cheapest_route_cost_map const& map):m_map{map}
+		{}
+
+		uint32_t width() const
+		{ return m_map.width; }
+
+		uint32_t height() const
+		{ return m_map.height; }
+
+		cheapest_route::cost_values operator()(uint32_t x, uint32_t y) const
+		{
+			auto const pixel = m_map.data + y*m_map.row_stride + x*m_map.pixel_stride;
+			return cheapest_route::cost_values{
+				get(pixel, m_map.elevation_channel, 0.0f),
+				get(pixel, m_map.friction_channel, 1.0f),
+				get(pixel, m_map.wind_x_channel, 0.0f),
+				get(pixel, m_map.wind_y_channel, 0.0f)
+			};
+		}
+
+	private:
+		cheapest_route_cost_map m_map;
+
+		static float get(float const* pixel, int32_t channel, float default_value)
+		{ return channel == CHEAPEST_ROUTE_NO_CHANNEL ? default_value : pixel[channel]; }
+	};
+
+	char const* validate(cheapest_route_cost_map const& map, cheapest_route_parameters const& params)
+	{
+		if(map.data == nullptr || map.width == 0 || map.height == 0)
+		{ return "The cost map is empty"; }
+
+		for(auto channel : {map.elevation_channel, map.friction_channel, map.wind_x_channel, map.wind_y_channel})
+		{
+			if(channel < CHEAPEST_ROUTE_NO_CHANNEL)
+			{ return "Channel offsets must be non-negative, or CHEAPEST_ROUTE_NO_CHANNEL"; }
+		}
+
+		for(auto value : params.world_scale)
+		{
+			if(!(value > 0.0))
+			{ return "All scaling factors must be strictly positive"; }
+		}
+
+		if(!(params.friction_strength > 0.0))
+		{ return "The friction strength must be strictly positive"; }
+
+		if(std::isnan(params.max_cost) || params.max_cost < 0.0)
+		{ return "Max cost must be non-negative"; }
+
+		return nullptr;
+	}
+
+	int copy_path(cheapest_route_workspace const& workspace,
+		cheapest_route_node* path,
+		size_t capacity,
+		size_t* node_count)
+	{
+		auto const& route = workspace.route;
+		if(node_count != nullptr)
+		{ *node_count = std::size(route); }
+
+		if(capacity < std::size(route) || (path == nullptr && std::size(route) != 0))
+		{ return CHEAPEST_ROUTE_BUFFER_TOO_SMALL; }
+
+		for(size_t k = 0; k != std::size(route); ++k)
+		{
+			path[k] = cheapest_route_node{
+				route[k].loc[0],
+				route[k].loc[1],
+				static_cast<double>(workspace.elevation_profile[k]),
+				route[k].integrated_cost
+			};
+		}
+		return CHEAPEST_ROUTE_OK;
+	}
+}
+
+int cheapest_route_api_version(void)
+{ return CHEAPEST_ROUTE_API_VERSION; }
+
+cheapest_route_workspace* cheapest_route_workspace_create(void)
+{ return new(std::nothrow) cheapest_route_workspace{}; }
+
+void cheapest_route_workspace_destroy(cheapest_route_workspace* workspace)
+{ delete workspace; }
+
+int cheapest_route_find_path(cheapest_route_workspace* workspace,
+	cheapest_route_cost_map const* cost_map,
+	cheapest_route_parameters const* params,
+	int64_t origin_x,
+	int64_t origin_y,
+	int64_t destination_x,
+	int64_t destination_y,
+	cheapest_route_node* path,
+	size_t capacity,
+	size_t* node_count)
+{
+	if(workspace == nullptr)
+	{ return CHEAPEST_ROUTE_INVALID_ARGUMENT; }
+
+	std::lock_guard lock{workspace->mutex};
+	try
+	{
+		workspace->last_error.clear();
+		workspace->route.clear();
+		workspace->elevation_profile.clear();
+		if(cost_map == nullptr || params == nullptr)
+		{
+			workspace->last_error = "No cost map or parameters given";
+			return CHEAPEST_ROUTE_INVALID_ARGUMENT;
+		}
+
+		if(auto const msg = validate(*cost_map, *params); msg != nullptr)
+		{
+			workspace->last_error = msg;
+			return CHEAPEST_ROUTE_INVALID_ARGUMENT;
+		}
+
+		auto const pixels = strided_cost_map_span{*cost_map};
+		auto const f = cheapest_route::basic_cost_function<strided_cost_map_span>{
+			pixels,
+			cheapest_route::scaling_factors{
+				static_cast<float>(params->world_scale[0]),
+				static_cast<float>(params->world_scale[1]),
+				static_cast<float>(params->world_scale[2])
+			},
+			static_cast<float>(params->friction_strength),
+			cheapest_route::vec<double, 2, cheapest_route::quantity_type::vector>{
+				params->wind_strength[0], params->wind_strength[1]
+			}
+		};
+
+		cheapest_route::search_options options;
+		options.max_cost = params->max_cost;
+		auto const domain = cheapest_route::search_domain{
+			static_cast<int64_t>(cost_map->width), static_cast<int64_t>(cost_map->height)
+		};
+
+		try
+		{
+			auto const& route = search(cheapest_route::from<int64_t>{origin_x, origin_y},
+				cheapest_route::to<int64_t>{destination_x, destination_y},
+				domain,
+				f,
+				options,
+				workspace->context);
+			workspace->route.assign(std::begin(route), std::end(route));
+		}
+		catch(std::runtime_error const& err)
+		{
+			workspace->last_error = err.what();
+			return CHEAPEST_ROUTE_SEARCH_FAILED;
+		}
+
+		workspace->elevation_profile.reserve(std::size(workspace->route));
+		for(auto const& item : workspace->route)
+		{ workspace->elevation_profile.push_back(cheapest_route::interp(pixels, item.loc.value()).elevation()); }
+
+		auto const ret = copy_path(*workspace, path, capacity, node_count);
+		if(ret == CHEAPEST_ROUTE_BUFFER_TOO_SMALL)
+		{ workspace->last_error = "The path buffer is too small"; }
+		return ret;
+	}
+	catch(std::bad_alloc const&)
+	{
+		workspace->last_error = "Out of memory";
+		return CHEAPEST_ROUTE_OUT_OF_MEMORY;
+	}
+	catch(std::exception const& err)
+	{
+		workspace->last_error = err.what();
+		return CHEAPEST_ROUTE_SEARCH_FAILED;
+	}
+}
+
+int cheapest_route_copy_path(cheapest_route_workspace* workspace,
+	cheapest_route_node* path,
+	size_t capacity,
+	size_t* node_count)
+{
+	if(workspace == nullptr)
+	{ return CHEAPEST_ROUTE_INVALID_ARGUMENT; }
+
+	std::lock_guard lock{workspace->mutex};
+	return copy_path(*workspace, path, capacity, node_count);
+}
+
+char const* cheapest_route_last_error(cheapest_route_workspace* workspace)
+{
+	if(workspace == nullptr)
+	{ return "No workspace given"; }
+
+	std::lock_guard lock{workspace->mutex};
+	return workspace->last_error.c_str();
+}
@@ -0,0 +1,83 @@
+//@	{
+//@	 "target":{"name":"cheapest_route_capi.test"},
+//@	 "dependencies":[{"ref":"./cheapest_route_capi.o", "origin":"generated", "rel":"implementation"}]
+//@	}
+
+#include "./cheapest_route.h"
+
+#include "lib/search.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+	// Interleaved RGBA-like layout with an extra unused channel, and padding at the end of rows
+	constexpr uint32_t w = 96;
+	constexpr uint32_t h = 64;
+	constexpr size_t pixel_stride = 5;
+	constexpr size_t row_stride = w*pixel_stride + 7;
+	std::vector<float> data(h*row_stride, -1.0f);
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		for(uint32_t x = 0; x != w; ++x)
+		{
+			auto const pixel = std::data(data) + y*row_stride + x*pixel_stride;
+			pixel[1] = 0.05f*static_cast<float>(x) + 0.02f*static_cast<float>(y);
+			pixel[2] = 1.0f + 0.5f*static_cast<float>(std::sin(x/9.0)*std::cos(y/5.0));
+			pixel[3] = 0.0f;
+			pixel[4] = 0.0f;
+		}
+	}
+
+	cheapest_route_cost_map const map{std::data(data), w, h, pixel_stride, row_stride, 1, 2, 3, 4};
+	cheapest_route_parameters const params{{1.0, 1.0, 1.0}, 1.0, {1.0, 1.0}, INFINITY};
+
+	auto const workspace = cheapest_route_workspace_create();
+	assert(workspace != nullptr);
+	assert(cheapest_route_api_version() == CHEAPEST_ROUTE_API_VERSION);
+
+	size_t node_count = 0;
+	std::vector<cheapest_route_node> nodes(4);
+	auto res = cheapest_route_find_path(workspace, &map, &params, 2, 3, 90, 60,
+		std::data(nodes), std::size(nodes), &node_count);
+	assert(res == CHEAPEST_ROUTE_BUFFER_TOO_SMALL);
+	assert(node_count > std::size(nodes));
+
+	nodes.resize(node_count);
+	res = cheapest_route_copy_path(workspace, std::data(nodes), std::size(nodes), &node_count);
+	assert(res == CHEAPEST_ROUTE_OK);
+	printf("%zu %.8g\n", node_count, nodes.back().integrated_cost);
+	assert(nodes.front().x == 2.0 && nodes.front().y == 3.0);
+	assert(nodes.back().x == 90.0 && nodes.back().y == 60.0);
+
+	// Without any channels, the cost is the euclidian length
+	nodes.resize(4*(w + h));
+	auto const flat_map = cheapest_route_cost_map{std::data(data), w, h, pixel_stride, row_stride,
+		CHEAPEST_ROUTE_NO_CHANNEL, CHEAPEST_ROUTE_NO_CHANNEL, CHEAPEST_ROUTE_NO_CHANNEL, CHEAPEST_ROUTE_NO_CHANNEL};
+	res = cheapest_route_find_path(workspace, &flat_map, &params, 2, 3, 90, 60,
+		std::data(nodes), std::size(nodes), &node_count);
+	assert(res == CHEAPEST_ROUTE_OK);
+	auto const reference = search(cheapest_route::from<int64_t>{2, 3},
+		cheapest_route::to<int64_t>{90, 60},
+		cheapest_route::search_domain{w, h});
+	printf("%zu %.8g %.8g\n", node_count, nodes[node_count - 1].integrated_cost, reference.back().integrated_cost);
+	assert(std::abs(nodes[node_count - 1].integrated_cost - reference.back().integrated_cost)
+		<= 1.0e-5*reference.back().integrated_cost);
+
+	res = cheapest_route_find_path(workspace, &map, &params, 2, 3, 200, 60,
+		std::data(nodes), std::size(nodes), &node_count);
+	assert(res == CHEAPEST_ROUTE_SEARCH_FAILED);
+	printf("%s\n", cheapest_route_last_error(workspace));
+
+	auto bad_params = params;
+	bad_params.friction_strength = 0.0;
+	res = cheapest_route_find_path(workspace, &map, &bad_params, 2, 3, 90, 60,
+		std::data(nodes), std::size(nodes), &node_count);
+	assert(res == CHEAPEST_ROUTE_INVALID_ARGUMENT);
+	printf("%s\n", cheapest_route_last_error(workspace));
+
+	cheapest_route_workspace_destroy(workspace);
+}
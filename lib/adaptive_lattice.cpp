@@ -0,0 +1,367 @@
+//@	{"target":{"name":"adaptive_lattice.o"}}
+
+#include "./adaptive_lattice.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+	using cheapest_route::lattice_detail::scale;
+	using cheapest_route::lattice_detail::scale_int;
+
+	using lattice_point = cheapest_route::vec<int64_t, 2>;
+
+	bool is_power_of_two(int64_t value)
+	{ return value > 0 && (value & (value - 1)) == 0; }
+
+	void split_cell(int64_t x0,
+		int64_t y0,
+		int64_t size,
+		cheapest_route::search_domain const& domain,
+		void const* callback_data,
+		cheapest_route::cell_predicate_ptr is_smooth,
+		cheapest_route::adaptive_lattice_options const& options,
+		std::vector<cheapest_route::adaptive_lattice_cell>& cells)
+	{
+		// Cells end at the last pixel, since there are no lattice nodes beyond it
+		auto const x1 = std::min(x0 + size, domain.width() - 1);
+		auto const y1 = std::min(y0 + size, domain.height() - 1);
+		auto const pixels = cheapest_route::search_bounds{
+			cheapest_route::make_interval<cheapest_route::boundary_type::inclusive,
+				cheapest_route::boundary_type::exclusive>(x0, x1 + 1),
+			cheapest_route::make_interval<cheapest_route::boundary_type::inclusive,
+				cheapest_route::boundary_type::exclusive>(y0, y1 + 1)
+		};
+
+		if(size == 1 || is_smooth(callback_data, pixels))
+		{
+			cells.push_back(cheapest_route::adaptive_lattice_cell{
+				scale_int*lattice_point{x0, y0},
+				scale_int*lattice_point{x1, y1},
+				std::max(scale_int*size/options.portals_per_side, int64_t{1})
+			});
+			return;
+		}
+
+		auto const half = size/2;
+		for(int64_t dy = 0; dy != 2; ++dy)
+		{
+			for(int64_t dx = 0; dx != 2; ++dx)
+			{
+				if((dx != 0 && x0 + half >= x1) || (dy != 0 && y0 + half >= y1))
+				{ continue; }
+				split_cell(x0 + dx*half, y0 + dy*half, half, domain, callback_data, is_smooth, options, cells);
+			}
+		}
+	}
+
+	// Every spacing step from begin, and end itself
+	void append_steps(int64_t begin, int64_t end, int64_t spacing, std::vector<int64_t>& ret)
+	{
+		ret.clear();
+		for(auto k = begin; k < end; k += spacing)
+		{ ret.push_back(k); }
+		ret.push_back(end);
+	}
+
+	bool contains(cheapest_route::adaptive_lattice_cell const& cell, lattice_point loc)
+	{
+		return loc[0] >= cell.min[0] && loc[0] <= cell.max[0]
+			&& loc[1] >= cell.min[1] && loc[1] <= cell.max[1];
+	}
+
+	cheapest_route::vec<double, 2> to_pixels(lattice_point loc)
+	{ return cheapest_route::vec<double, 2>{static_cast<double>(loc[0])/scale, static_cast<double>(loc[1])/scale}; }
+
+	class edge_integrator
+	{
+	public:
+		explicit edge_integrator(double max_segment_length,
+			void const* callback_data,
+			cheapest_route::cost_function_ptr cost_function):
+			m_max_segment_length{max_segment_length},
+			m_callback_data{callback_data},
+			m_cost_function{cost_function}
+		{}
+
+		size_t segment_count(lattice_point a, lattice_point b) const
+		{
+			auto const length = std::sqrt(length_squared(to_pixels(b) - to_pixels(a)));
+			return std::max(static_cast<size_t>(std::ceil(length/m_max_segment_length)), size_t{1});
+		}
+
+		double segment_cost(lattice_point a, lattice_point b, size_t k, size_t count) const
+		{
+			auto const ret = m_cost_function(m_callback_data,
+				cheapest_route::from<double>{point(a, b, k, count)},
+				cheapest_route::to<double>{point(a, b, k + 1, count)});
+			if(ret < 0.0)
+			{ throw std::runtime_error{"Cost function must be positive"}; }
+			return ret;
+		}
+
+		double operator()(lattice_point a, lattice_point b) const
+		{
+			auto const count = segment_count(a, b);
+			auto sum = 0.0;
+			for(size_t k = 0; k != count; ++k)
+			{ sum += segment_cost(a, b, k, count); }
+			return sum;
+		}
+
+		static cheapest_route::vec<double, 2> point(lattice_point a, lattice_point b, size_t k, size_t count)
+		{
+			auto const t = static_cast<double>(k)/static_cast<double>(count);
+			auto const p0 = to_pixels(a);
+			auto const p1 = to_pixels(b);
+			return cheapest_route::vec<double, 2>{p0[0] + t*(p1[0] - p0[0]), p0[1] + t*(p1[1] - p0[1])};
+		}
+
+	private:
+		double m_max_segment_length;
+		void const* m_callback_data;
+		cheapest_route::cost_function_ptr m_cost_function;
+	};
+
+	struct pending_node
+	{
+		uint32_t index;
+		double integrated_cost;
+	};
+}
+
+cheapest_route::adaptive_lattice::adaptive_lattice(search_domain const& domain,
+	adaptive_lattice_options const& options,
+	std::vector<adaptive_lattice_cell>&& cells):
+	m_domain{domain},
+	m_options{options},
+	m_cells{std::move(cells)}
+{
+	std::unordered_map<uint64_t, uint32_t> node_index;
+	std::vector<lattice_point> boundary;
+	std::vector<int64_t> xs;
+	std::vector<int64_t> ys;
+	m_portal_offsets.reserve(std::size(m_cells) + 1);
+	m_portal_offsets.push_back(0);
+	for(size_t k = 0; k != std::size(m_cells); ++k)
+	{
+		auto const& cell = m_cells[k];
+		append_steps(cell.min[0], cell.max[0], cell.portal_spacing, xs);
+		append_steps(cell.min[1], cell.max[1], cell.portal_spacing, ys);
+		boundary.clear();
+		for(auto x : xs)
+		{
+			boundary.push_back(lattice_point{x, cell.min[1]});
+			boundary.push_back(lattice_point{x, cell.max[1]});
+		}
+		for(auto y : ys)
+		{
+			boundary.push_back(lattice_point{cell.min[0], y});
+			boundary.push_back(lattice_point{cell.max[0], y});
+		}
+
+		auto const key = [](lattice_point loc) {
+			return (static_cast<uint64_t>(loc[1]) << 32) | static_cast<uint64_t>(loc[0]);
+		};
+		std::ranges::sort(boundary, {}, key);
+		auto const duplicates = std::ranges::unique(boundary, {}, key);
+		boundary.erase(std::begin(duplicates), std::end(duplicates));
+
+		for(auto const loc : boundary)
+		{
+			auto const [i, inserted] = node_index.emplace(key(loc), static_cast<uint32_t>(std::size(m_nodes)));
+			if(inserted)
+			{
+				m_nodes.push_back(loc);
+				m_node_cells.push_back(std::array{no_cell, no_cell, no_cell, no_cell});
+			}
+
+			auto& node_cells = m_node_cells[i->second];
+			auto const slot = std::ranges::find(node_cells, no_cell);
+			if(slot == std::end(node_cells))
+			{ throw std::runtime_error{"A node is shared by more than four cells"}; }
+			*slot = static_cast<uint32_t>(k);
+			m_portals.push_back(i->second);
+		}
+		m_portal_offsets.push_back(std::size(m_portals));
+	}
+}
+
+cheapest_route::adaptive_lattice cheapest_route::build_adaptive_lattice_impl(search_domain const& domain,
+	void const* callback_data,
+	cell_predicate_ptr is_smooth,
+	adaptive_lattice_options const& options)
+{
+	if(domain.width() < 1 || domain.height() < 1)
+	{ throw std::runtime_error{"Empty search domain"}; }
+
+	if(domain.width() > 0x7fff'ffff/scale_int || domain.height() > 0x7fff'ffff/scale_int)
+	{ throw std::runtime_error{"The search domain is too large for an adaptive lattice"}; }
+
+	if(!is_power_of_two(options.max_cell_size) || !is_power_of_two(options.portals_per_side))
+	{ throw std::runtime_error{"The cell size and the number of portals per side must be powers of two"}; }
+
+	if(!(options.max_segment_length > 0.0))
+	{ throw std::runtime_error{"The segment length must be strictly positive"}; }
+
+	std::vector<adaptive_lattice_cell> cells;
+	auto const size = options.max_cell_size;
+	for(int64_t y = 0; y == 0 || y < domain.height() - 1; y += size)
+	{
+		for(int64_t x = 0; x == 0 || x < domain.width() - 1; x += size)
+		{ split_cell(x, y, size, domain, callback_data, is_smooth, options, cells); }
+	}
+
+	return adaptive_lattice{domain, options, std::move(cells)};
+}
+
+cheapest_route::path cheapest_route::search_adaptive_impl(adaptive_lattice const& lattice,
+	from<int64_t> source,
+	to<int64_t> target,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options)
+{
+	if(options.bounds.has_value() || options.edge_weights != nullptr || options.passability != nullptr)
+	{ throw std::runtime_error{"Search bounds, edge weights, and passability are not supported on an adaptive lattice"}; }
+
+	if(options.max_cost < 0.0)
+	{ throw std::runtime_error{"Max cost must be non-negative"}; }
+
+	if(outside(vec<int64_t, 2>{source}, lattice.domain()))
+	{ throw std::runtime_error{"Source location is outside search domain"}; }
+
+	if(outside(vec<int64_t, 2>{target}, lattice.domain()))
+	{ throw std::runtime_error{"Target location is outside search domain"}; }
+
+	auto const source_loc = scale_int*vec<int64_t, 2>{source};
+	auto const target_loc = scale_int*vec<int64_t, 2>{target};
+	if(source_loc[0] == target_loc[0] && source_loc[1] == target_loc[1])
+	{ return path{visited_node{vec<double, 2, quantity_type::point>{to_pixels(source_loc)}, 0.0}}; }
+
+	// The endpoints are extra nodes, connected to every portal of the cells that contain them
+	auto const node_count = lattice.node_count();
+	auto const source_index = static_cast<uint32_t>(node_count);
+	auto const target_index = static_cast<uint32_t>(node_count + 1);
+	std::vector<std::pair<uint32_t, uint32_t>> endpoint_cells;
+	auto const cells = lattice.cells();
+	for(size_t k = 0; k != std::size(cells); ++k)
+	{
+		if(contains(cells[k], source_loc))
+		{ endpoint_cells.emplace_back(static_cast<uint32_t>(k), source_index); }
+
+		if(contains(cells[k], target_loc))
+		{ endpoint_cells.emplace_back(static_cast<uint32_t>(k), target_index); }
+	}
+
+	auto const location = [&](uint32_t index) {
+		return index < node_count ? lattice.node(index) : (index == source_index ? source_loc : target_loc);
+	};
+
+	auto const integrate = edge_integrator{lattice.options().max_segment_length, callback_data, cost_function};
+	std::vector<double> costs(node_count + 2, std::numeric_limits<double>::infinity());
+	std::vector<uint32_t> parents(node_count + 2);
+	std::vector<uint8_t> visited(node_count + 2);
+	std::vector<pending_node> nodes_to_visit;
+	auto const cmp = [](pending_node const& a, pending_node const& b) {
+		return a.integrated_cost > b.integrated_cost;
+	};
+
+	costs[source_index] = 0.0;
+	parents[source_index] = source_index;
+	nodes_to_visit.push_back(pending_node{source_index, 0.0});
+	while(!nodes_to_visit.empty())
+	{
+		std::ranges::pop_heap(nodes_to_visit, cmp);
+		auto const current = nodes_to_visit.back();
+		nodes_to_visit.pop_back();
+		if(visited[current.index])
+		{ continue; }
+		visited[current.index] = 1;
+
+		if(current.index == target_index)
+		{ break; }
+
+		auto const current_loc = location(current.index);
+		auto const relax = [&](uint32_t next) {
+			if(visited[next])
+			{ return; }
+
+			auto const cost_increment = integrate(current_loc, location(next));
+			if(cost_increment == std::numeric_limits<double>::infinity())
+			{ return; }
+
+			auto const new_cost = current.integrated_cost + cost_increment;
+			if(new_cost < costs[next] && new_cost <= options.max_cost)
+			{
+				costs[next] = new_cost;
+				parents[next] = current.index;
+				nodes_to_visit.push_back(pending_node{next, new_cost});
+				std::ranges::push_heap(nodes_to_visit, cmp);
+			}
+		};
+
+		auto const visit_cell = [&](uint32_t cell) {
+			for(auto const next : lattice.portals(cell))
+			{ relax(next); }
+
+			for(auto const& item : endpoint_cells)
+			{
+				if(item.first == cell)
+				{ relax(item.second); }
+			}
+		};
+
+		if(current.index < node_count)
+		{
+			for(auto const cell : lattice.node_cells(current.index))
+			{
+				if(cell != adaptive_lattice::no_cell)
+				{ visit_cell(cell); }
+			}
+		}
+		else
+		{
+			for(auto const& item : endpoint_cells)
+			{
+				if(item.second == current.index)
+				{ visit_cell(item.first); }
+			}
+		}
+	}
+
+	if(!visited[target_index])
+	{ lattice_detail::throw_not_reached(target, options.max_cost); }
+
+	std::vector<uint32_t> route_nodes;
+	for(auto index = target_index; index != source_index; index = parents[index])
+	{ route_nodes.push_back(index); }
+	route_nodes.push_back(source_index);
+	std::ranges::reverse(route_nodes);
+
+	// Long edges are written as their segments, so the path follows the terrain as closely as the
+	// search did
+	path ret;
+	ret.push_back(visited_node{vec<double, 2, quantity_type::point>{to_pixels(source_loc)}, 0.0});
+	for(size_t k = 1; k != std::size(route_nodes); ++k)
+	{
+		auto const a = location(route_nodes[k - 1]);
+		auto const b = location(route_nodes[k]);
+		auto const count = integrate.segment_count(a, b);
+		auto cost = costs[route_nodes[k - 1]];
+		for(size_t l = 1; l != count; ++l)
+		{
+			cost += integrate.segment_cost(a, b, l - 1, count);
+			ret.push_back(visited_node{
+				vec<double, 2, quantity_type::point>{edge_integrator::point(a, b, l, count)},
+				cost
+			});
+		}
+		ret.push_back(visited_node{vec<double, 2, quantity_type::point>{to_pixels(b)}, costs[route_nodes[k]]});
+	}
+	return ret;
+}
@@ -0,0 +1,132 @@
+//@	{"dependencies_extra":[{"ref":"./adaptive_lattice.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_ADAPTIVELATTICE_HPP
+#define CHEAPESTROUTE_ADAPTIVELATTICE_HPP
+
+#include "./search.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	struct adaptive_lattice_options
+	{
+		// The size of the largest cells, in pixels. Must be a power of two.
+		int64_t max_cell_size = 64;
+
+		// The number of portal intervals along each side of a cell. Smaller cells get the same
+		// number of portals, but never more than one per lattice step. Must be a power of two, so
+		// the portals of a large cell are also portals of its smaller neighbours.
+		int64_t portals_per_side = 4;
+
+		// Edges across large cells are integrated in segments of at most this length, in pixels
+		double max_segment_length = 4.0;
+	};
+
+	// A cell in lattice coordinates. The boundary is part of the cell, so neighbouring cells share
+	// their common side.
+	struct adaptive_lattice_cell
+	{
+		vec<int64_t, 2> min;
+		vec<int64_t, 2> max;
+		int64_t portal_spacing;
+	};
+
+	// A quadtree over the search domain. The leaves are the cells, and the lattice nodes are the
+	// portals on their boundaries. Within a cell, every portal is connected to every other portal
+	// with a straight edge.
+	class adaptive_lattice
+	{
+	public:
+		static constexpr uint32_t no_cell = 0xffff'ffff;
+
+		explicit adaptive_lattice(search_domain const& domain,
+			adaptive_lattice_options const& options,
+			std::vector<adaptive_lattice_cell>&& cells);
+
+		search_domain const& domain() const
+		{ return m_domain; }
+
+		adaptive_lattice_options const& options() const
+		{ return m_options; }
+
+		std::span<adaptive_lattice_cell const> cells() const
+		{ return m_cells; }
+
+		std::span<uint32_t const> portals(uint32_t cell) const
+		{
+			return std::span{std::data(m_portals) + m_portal_offsets[cell],
+				std::data(m_portals) + m_portal_offsets[cell + 1]};
+		}
+
+		size_t node_count() const
+		{ return std::size(m_nodes); }
+
+		// The location of a node in lattice coordinates
+		vec<int64_t, 2> node(uint32_t index) const
+		{ return m_nodes[index]; }
+
+		// The cells that have node as a portal. Unused entries are set to no_cell.
+		std::array<uint32_t, 4> const& node_cells(uint32_t index) const
+		{ return m_node_cells[index]; }
+
+	private:
+		search_domain m_domain;
+		adaptive_lattice_options m_options;
+		std::vector<adaptive_lattice_cell> m_cells;
+		std::vector<size_t> m_portal_offsets;
+		std::vector<uint32_t> m_portals;
+		std::vector<vec<int64_t, 2>> m_nodes;
+		std::vector<std::array<uint32_t, 4>> m_node_cells;
+	};
+
+	using cell_predicate_ptr = bool (*)(void const* callback_data, search_bounds const& cell);
+
+	adaptive_lattice build_adaptive_lattice_impl(search_domain const& domain,
+		void const* callback_data,
+		cell_predicate_ptr is_smooth,
+		adaptive_lattice_options const& options);
+
+	// Builds the lattice by splitting cells until is_smooth(cell) holds, or the cell is a single
+	// pixel. cell covers the pixels that the cell is interpolated from, including the first row and
+	// column after it.
+	template<class Predicate>
+	adaptive_lattice build_adaptive_lattice(search_domain const& domain,
+		Predicate&& is_smooth,
+		adaptive_lattice_options const& options = adaptive_lattice_options{})
+	{
+		return build_adaptive_lattice_impl(domain, &is_smooth, [](void const* callback_data,
+			search_bounds const& cell){
+			auto const& data = *static_cast<std::remove_cvref_t<Predicate> const*>(callback_data);
+			return static_cast<bool>(data(cell));
+		}, options);
+	}
+
+	path search_adaptive_impl(adaptive_lattice const& lattice,
+		from<int64_t> source,
+		to<int64_t> target,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options);
+
+	// Like search, but on an adaptive lattice. Only max_cost is supported among the options.
+	template<class CostFunction = flat_euclidian_norm>
+	path search_adaptive(adaptive_lattice const& lattice,
+		from<int64_t> source,
+		to<int64_t> target,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
+	{
+		return search_adaptive_impl(lattice, source, target, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options);
+	}
+}
+
+#endif
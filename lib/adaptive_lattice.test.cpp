@@ -0,0 +1,86 @@
+//@	{"target":{"name":"adaptive_lattice.test"}}
+
+#include "./adaptive_lattice.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	// Smooth, except for a wall with a gap at the bottom
+	double friction(double x, double y)
+	{
+		auto const wall = std::abs(x - 128.0) < 3.0 && y < 150.0 ? 100.0 : 0.0;
+		return 1.0 + 0.3*std::sin(x/50.0)*std::cos(y/40.0) + wall;
+	}
+}
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{256, 192};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return friction(mid[0], mid[1])*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const lattice = build_adaptive_lattice(domain, [](cheapest_route::search_bounds const& cell) {
+		auto min_val = std::numeric_limits<double>::infinity();
+		auto max_val = -min_val;
+		for(auto y = cell.vert_interval.min; y != cell.vert_interval.max; ++y)
+		{
+			for(auto x = cell.horz_interval.min; x != cell.horz_interval.max; ++x)
+			{
+				auto const val = friction(static_cast<double>(x), static_cast<double>(y));
+				min_val = std::min(min_val, val);
+				max_val = std::max(max_val, val);
+			}
+		}
+		return max_val - min_val <= 0.05;
+	});
+
+	auto const regular_node_count = static_cast<size_t>((4*(domain.width() - 1) + 1)*(4*(domain.height() - 1) + 1));
+	printf("%zu cells, %zu nodes, %zu regular nodes\n",
+		std::size(lattice.cells()), lattice.node_count(), regular_node_count);
+	assert(10*lattice.node_count() < regular_node_count);
+
+	// Every node must be a portal of the cells it says it belongs to
+	for(uint32_t k = 0; k != lattice.node_count(); ++k)
+	{
+		for(auto const cell : lattice.node_cells(k))
+		{
+			if(cell != cheapest_route::adaptive_lattice::no_cell)
+			{ assert(std::ranges::find(lattice.portals(cell), k) != std::end(lattice.portals(cell))); }
+		}
+	}
+
+	auto const source = cheapest_route::from<int64_t>{10, 20};
+	auto const target = cheapest_route::to<int64_t>{240, 30};
+	auto const route = search_adaptive(lattice, source, target, f);
+	auto const reference = search(source, target, domain, f);
+	printf("%zu %.8g %.8g\n", std::size(route), route.back().integrated_cost, reference.back().integrated_cost);
+
+	assert(route.front().loc[0] == 10.0 && route.front().loc[1] == 20.0);
+	assert(route.back().loc[0] == 240.0 && route.back().loc[1] == 30.0);
+	assert(route.front().integrated_cost == 0.0);
+	assert(std::ranges::is_sorted(route, {}, &cheapest_route::visited_node::integrated_cost));
+	assert(std::abs(route.back().integrated_cost - reference.back().integrated_cost)
+		<= 0.03*reference.back().integrated_cost);
+
+	// The route must go around the wall, through the gap
+	assert(std::ranges::any_of(route, [](auto const& item) { return item.loc[1] >= 150.0; }));
+
+	auto limited = cheapest_route::search_options{};
+	limited.max_cost = 100.0;
+	try
+	{
+		search_adaptive(lattice, source, target, f, limited);
+		assert(false);
+	}
+	catch(std::runtime_error const&)
+	{}
+
+	auto const trivial = search_adaptive(lattice, source, cheapest_route::to<int64_t>{10, 20}, f);
+	assert(std::size(trivial) == 1);
+}
@@ -0,0 +1,243 @@
+//@	{"target":{"name":"alternative_routes.o"}}
+
+#include "./alternative_routes.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	using cheapest_route::lattice_detail::scale_int;
+	using cheapest_route::lattice_detail::neigbour_offsets;
+	using cheapest_route::lattice_detail::lattice_rectangle;
+	using cheapest_route::lattice_detail::get_item;
+	using cheapest_route::no_parent;
+
+	using lattice_point = cheapest_route::vec<int64_t, 2>;
+
+	constexpr uint8_t opposite(uint8_t direction)
+	{ return static_cast<uint8_t>((direction + std::size(neigbour_offsets)/2)%std::size(neigbour_offsets)); }
+
+	class tree_pair
+	{
+	public:
+		explicit tree_pair(cheapest_route::search_tree_view const& forward,
+			cheapest_route::search_tree_view const& backward,
+			lattice_rectangle const& lattice):
+			m_forward{forward},
+			m_backward{backward},
+			m_lattice{lattice}
+		{}
+
+		double cost_from_source(lattice_point loc) const
+		{ return get_item(std::data(m_forward.costs), loc, m_lattice); }
+
+		double cost_to_target(lattice_point loc) const
+		{ return get_item(std::data(m_backward.costs), loc, m_lattice); }
+
+		uint8_t forward_direction(lattice_point loc) const
+		{ return get_item(std::data(m_forward.directions), loc, m_lattice); }
+
+		uint8_t backward_direction(lattice_point loc) const
+		{ return get_item(std::data(m_backward.directions), loc, m_lattice); }
+
+		// The node before loc on the cheapest route from the source
+		lattice_point predecessor(lattice_point loc) const
+		{ return loc - lattice_point{neigbour_offsets[forward_direction(loc)]}; }
+
+		// The node after loc on the cheapest route to the target
+		lattice_point successor(lattice_point loc) const
+		{ return loc - lattice_point{neigbour_offsets[backward_direction(loc)]}; }
+
+		// True if the edge from the predecessor of loc into loc is part of both trees
+		bool shared_in(lattice_point loc) const
+		{
+			auto const dir = forward_direction(loc);
+			return dir != no_parent && backward_direction(predecessor(loc)) == opposite(dir);
+		}
+
+		// True if the edge from loc to its successor is part of both trees
+		bool shared_out(lattice_point loc) const
+		{
+			auto const dir = backward_direction(loc);
+			return dir != no_parent && forward_direction(successor(loc)) == opposite(dir);
+		}
+
+		lattice_rectangle const& lattice() const
+		{ return m_lattice; }
+
+	private:
+		cheapest_route::search_tree_view m_forward;
+		cheapest_route::search_tree_view m_backward;
+		lattice_rectangle m_lattice;
+	};
+
+	struct plateau
+	{
+		lattice_point via;
+		double route_cost;
+		double length;
+	};
+
+	// Plateaus are chains of edges that are part of both trees. Every node on a plateau has the same
+	// total cost, so any of them can be used as via node.
+	auto find_plateaus(tree_pair const& trees, double max_cost)
+	{
+		std::vector<plateau> ret;
+		auto const& lattice = trees.lattice();
+		for(auto y = lattice.vert_interval.min; y != lattice.vert_interval.max; ++y)
+		{
+			for(auto x = lattice.horz_interval.min; x != lattice.horz_interval.max; ++x)
+			{
+				auto const end = lattice_point{x, y};
+				if(!trees.shared_in(end) || trees.shared_out(end))
+				{ continue; }
+
+				auto start = end;
+				while(trees.shared_in(start))
+				{ start = trees.predecessor(start); }
+
+				auto const route_cost = trees.cost_from_source(start) + trees.cost_to_target(start);
+				if(route_cost <= max_cost)
+				{ ret.push_back(plateau{start, route_cost, trees.cost_from_source(end) - trees.cost_from_source(start)}); }
+			}
+		}
+		return ret;
+	}
+
+	struct route_candidate
+	{
+		std::vector<lattice_point> nodes;
+		std::vector<double> costs;
+	};
+
+	// Returns false if the route through via visits a node twice
+	bool trace_via(tree_pair const& trees,
+		lattice_point via,
+		std::span<uint32_t> visit_stamps,
+		uint32_t stamp,
+		route_candidate& ret)
+	{
+		ret.nodes.clear();
+		ret.costs.clear();
+		auto const& lattice = trees.lattice();
+		auto const visit = [&](lattice_point loc) {
+			auto& item = get_item(std::data(visit_stamps), loc, lattice);
+			if(item == stamp)
+			{ return false; }
+			item = stamp;
+			return true;
+		};
+
+		auto loc = via;
+		while(true)
+		{
+			if(!visit(loc))
+			{ return false; }
+			ret.nodes.push_back(loc);
+			ret.costs.push_back(trees.cost_from_source(loc));
+			if(trees.forward_direction(loc) == no_parent)
+			{ break; }
+			loc = trees.predecessor(loc);
+		}
+		std::ranges::reverse(ret.nodes);
+		std::ranges::reverse(ret.costs);
+
+		auto const via_cost = trees.cost_from_source(via) + trees.cost_to_target(via);
+		loc = via;
+		while(trees.backward_direction(loc) != no_parent)
+		{
+			loc = trees.successor(loc);
+			if(!visit(loc))
+			{ return false; }
+			ret.nodes.push_back(loc);
+			ret.costs.push_back(via_cost - trees.cost_to_target(loc));
+		}
+		return true;
+	}
+}
+
+std::vector<cheapest_route::path> cheapest_route::extract_alternative_routes(search_tree_view const& forward,
+	search_tree_view const& backward,
+	alternative_route_options const& alt_options)
+{
+	if(forward.domain.width() != backward.domain.width() || forward.domain.height() != backward.domain.height())
+	{ throw std::runtime_error{"The search trees do not cover the same domain"}; }
+
+	auto const node_count = lattice_node_count(forward.domain);
+	if(std::size(forward.costs) != node_count || std::size(forward.directions) != node_count
+		|| std::size(backward.costs) != node_count || std::size(backward.directions) != node_count)
+	{ throw std::runtime_error{"Search tree does not match its domain"}; }
+
+	if(!(alt_options.max_stretch >= 0.0) || !(alt_options.max_overlap >= 0.0))
+	{ throw std::runtime_error{"Stretch and overlap limits must be non-negative"}; }
+
+	if(alt_options.route_count == 0)
+	{ return std::vector<path>{}; }
+
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{forward.domain, origin_at_zero{}});
+	tree_pair const trees{forward, backward, lattice};
+	auto const target = lattice_point{scale_int*backward.root};
+	auto const cheapest = trees.cost_from_source(target);
+	if(cheapest == std::numeric_limits<double>::infinity())
+	{
+		throw std::runtime_error{std::string{"Target "}.append(to_string(backward.root))
+			.append(" cannot be reached from ").append(to_string(forward.root))};
+	}
+
+	auto plateaus = find_plateaus(trees, (1.0 + alt_options.max_stretch)*cheapest);
+	std::ranges::sort(plateaus, [](auto const& a, auto const& b) {
+		return std::pair{a.route_cost - a.length, a.route_cost} < std::pair{b.route_cost - b.length, b.route_cost};
+	});
+
+	std::vector<uint32_t> visit_stamps(node_count);
+	std::vector<uint8_t> on_route(node_count);
+	std::vector<path> ret;
+	route_candidate candidate;
+	uint32_t stamp = 0;
+
+	auto const try_add = [&](lattice_point via) {
+		++stamp;
+		if(!trace_via(trees, via, visit_stamps, stamp, candidate))
+		{ return; }
+
+		auto const& nodes = candidate.nodes;
+		auto const& costs = candidate.costs;
+		auto shared_cost = 0.0;
+		auto has_new_nodes = false;
+		for(size_t k = 0; k != std::size(nodes); ++k)
+		{
+			auto const visited = get_item(std::data(on_route), nodes[k], lattice) != 0;
+			has_new_nodes = has_new_nodes || !visited;
+			if(k != 0 && visited && get_item(std::data(on_route), nodes[k - 1], lattice) != 0)
+			{ shared_cost += costs[k] - costs[k - 1]; }
+		}
+
+		if(!std::empty(ret) && (!has_new_nodes || shared_cost > alt_options.max_overlap*costs.back()))
+		{ return; }
+
+		path route;
+		route.reserve(std::size(nodes));
+		for(size_t k = 0; k != std::size(nodes); ++k)
+		{
+			get_item(std::data(on_route), nodes[k], lattice) = 1;
+			route.push_back(visited_node{
+				vec<double, 2, quantity_type::point>{scale_to_float(lattice_detail::scale, nodes[k])},
+				std::max(costs[k], 0.0)
+			});
+		}
+		ret.push_back(std::move(route));
+	};
+
+	// The via node of the cheapest route is the target itself
+	try_add(target);
+	for(auto const& item : plateaus)
+	{
+		if(std::size(ret) >= alt_options.route_count)
+		{ break; }
+		try_add(item.via);
+	}
+
+	return ret;
+}
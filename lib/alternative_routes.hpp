@@ -0,0 +1,57 @@
+//@	{"dependencies_extra":[{"ref":"./alternative_routes.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_ALTERNATIVEROUTES_HPP
+#define CHEAPESTROUTE_ALTERNATIVEROUTES_HPP
+
+#include "./search_tree.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace cheapest_route
+{
+	struct alternative_route_options
+	{
+		// The maximum number of routes to return, including the cheapest one
+		size_t route_count = 3;
+
+		// An alternative may cost at most 1 + max_stretch times as much as the cheapest route
+		double max_stretch = 0.25;
+
+		// The largest share of the cost of an alternative that may be spent on nodes that are part
+		// of routes found earlier
+		double max_overlap = 0.5;
+	};
+
+	// Extracts alternative routes from a tree rooted in the source, built with the cost function,
+	// and a tree rooted in the target, built with the reversed cost function. The cheapest route
+	// comes first.
+	std::vector<path> extract_alternative_routes(search_tree_view const& forward,
+		search_tree_view const& backward,
+		alternative_route_options const& alt_options);
+
+	// Finds up to route_count diverse routes from source to target, using one search from each
+	// end. Every alternative passes through a plateau, that is, a part shared by the two search
+	// trees.
+	template<class CostFunction = flat_euclidian_norm>
+	std::vector<path> find_alternative_routes(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{},
+		alternative_route_options const& alt_options = alternative_route_options{})
+	{
+		if(options.edge_weights != nullptr)
+		{ throw std::runtime_error{"Alternative routes cannot be computed from precompiled edge weights"}; }
+
+		auto const forward = build_search_tree(to<int64_t>{source.value()}, domain, f, options);
+		auto const backward = build_search_tree(target, domain,
+			[&f](from<double> x0, to<double> x1) {
+				return static_cast<double>(f(from<double>{x1.value()}, to<double>{x0.value()}));
+			},
+			options);
+		return extract_alternative_routes(forward.view(), backward.view(), alt_options);
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+//@	{"target":{"name":"alternative_routes.test"}}
+
+#include "./alternative_routes.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+
+	// A wall with two gaps, so there are two clearly different ways around it
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		if(mid[0] > 78.0 && mid[0] < 82.0 && !(mid[1] > 20.0 && mid[1] < 30.0) && !(mid[1] > 85.0 && mid[1] < 95.0))
+		{ return std::numeric_limits<double>::infinity(); }
+		return (1.0 + 0.2*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const source = cheapest_route::from<int64_t>{10, 60};
+	auto const target = cheapest_route::to<int64_t>{150, 55};
+
+	cheapest_route::alternative_route_options alt_options;
+	alt_options.route_count = 3;
+	alt_options.max_stretch = 0.3;
+	alt_options.max_overlap = 0.5;
+	auto const routes = find_alternative_routes(source, target, domain, f,
+		cheapest_route::search_options{}, alt_options);
+	auto const cheapest = search(source, target, domain, f).back().integrated_cost;
+
+	assert(std::size(routes) >= 2 && std::size(routes) <= alt_options.route_count);
+	assert(std::abs(routes[0].back().integrated_cost - cheapest) <= 1.0e-5*cheapest);
+
+	auto const passes_above = [](cheapest_route::path const& route) {
+		return std::ranges::any_of(route, [](auto const& item){ return item.loc[0] > 76.0 && item.loc[0] < 84.0 && item.loc[1] < 50.0; });
+	};
+	assert(std::ranges::any_of(routes, passes_above) && !std::ranges::all_of(routes, passes_above));
+
+	for(auto const& route : routes)
+	{
+		printf("%zu %.8g\n", std::size(route), route.back().integrated_cost);
+		assert(route.front().loc[0] == static_cast<double>(source[0]));
+		assert(route.front().loc[1] == static_cast<double>(source[1]));
+		assert(route.back().loc[0] == static_cast<double>(target[0]));
+		assert(route.back().loc[1] == static_cast<double>(target[1]));
+		assert(route.front().integrated_cost == 0.0);
+		assert(route.back().integrated_cost <= (1.0 + alt_options.max_stretch)*cheapest*(1.0 + 1.0e-5));
+		assert(std::ranges::is_sorted(route, [](auto const& a, auto const& b) {
+			return a.integrated_cost < b.integrated_cost;
+		}));
+	}
+
+	// Without stretch, only the cheapest route is left
+	alt_options.max_stretch = 0.0;
+	auto const only_cheapest = find_alternative_routes(source, target, domain, f,
+		cheapest_route::search_options{}, alt_options);
+	assert(std::size(only_cheapest) == 1);
+
+	auto const same_point = find_alternative_routes(source, cheapest_route::to<int64_t>{source.value()}, domain, f);
+	assert(std::size(same_point) == 1 && std::size(same_point[0]) == 1);
+}
@@ -0,0 +1,270 @@
+//@	{"target":{"name":"anytime_search.o"}}
+
+#include "./anytime_search.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	using cheapest_route::lattice_detail::scale;
+	using cheapest_route::lattice_detail::scale_int;
+	using cheapest_route::lattice_detail::neigbour_offsets;
+	using cheapest_route::lattice_detail::lattice_rectangle;
+	using cheapest_route::lattice_detail::get_item;
+	using cheapest_route::lattice_detail::edge_cost;
+
+	constexpr auto no_parent = std::numeric_limits<uint8_t>::max();
+	constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+	struct node
+	{
+		double g{infinity};
+		uint32_t closed_in{0};
+		uint8_t parent{no_parent};
+		bool inconsistent{false};
+	};
+
+	struct pending_node
+	{
+		cheapest_route::vec<int64_t, 2> loc;
+		double key;
+		double g;
+	};
+
+	bool has_lower_priority(pending_node const& a, pending_node const& b)
+	{ return a.key > b.key; }
+
+	auto make_deadline(std::chrono::steady_clock::duration budget)
+	{
+		auto const now = std::chrono::steady_clock::now();
+		return budget >= std::chrono::steady_clock::time_point::max() - now ?
+			std::chrono::steady_clock::time_point::max() : now + budget;
+	}
+
+	class ara_star
+	{
+	public:
+		explicit ara_star(cheapest_route::vec<int64_t, 2> source,
+			cheapest_route::vec<int64_t, 2> target,
+			lattice_rectangle const& lattice,
+			edge_cost const& cost,
+			double max_cost,
+			double min_cost_per_length):
+			m_source{source},
+			m_target{target},
+			m_lattice{lattice},
+			m_cost{cost},
+			m_max_cost{max_cost},
+			m_min_cost_per_length{min_cost_per_length},
+			m_nodes{std::make_unique<node[]>(cheapest_route::lattice_detail::node_count(lattice))},
+			m_iteration{1}
+		{
+			get_node(source).g = 0.0;
+			m_open.push_back(pending_node{source, 0.0, 0.0});
+		}
+
+		// Returns false if the deadline passed before the iteration was complete
+		bool improve_path(double weight, std::chrono::steady_clock::time_point deadline, bool interruptible)
+		{
+			size_t expanded = 0;
+			auto& target = get_node(m_target);
+			while(!m_open.empty())
+			{
+				auto const current = m_open.front();
+				auto& item = get_node(current.loc);
+				if(current.g != item.g || item.closed_in == m_iteration)
+				{
+					std::ranges::pop_heap(m_open, has_lower_priority);
+					m_open.pop_back();
+					continue;
+				}
+
+				if(current.key >= target.g)
+				{ return true; }
+
+				++expanded;
+				if(interruptible && expanded%1024 == 0 && std::chrono::steady_clock::now() >= deadline)
+				{ return false; }
+
+				std::ranges::pop_heap(m_open, has_lower_priority);
+				m_open.pop_back();
+				item.closed_in = m_iteration;
+
+				for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+				{
+					auto const next_loc = current.loc + cheapest_route::vec<int64_t, 2>{neigbour_offsets[k]};
+					if(outside(next_loc, m_lattice))
+					{ continue; }
+
+					auto const cost_increment = m_cost(current.loc, k);
+					if(cost_increment < 0.0)
+					{ throw std::runtime_error{"Cost function must be positive"}; }
+
+					auto const new_g = item.g + cost_increment;
+					auto& next = get_node(next_loc);
+					if(new_g >= next.g || new_g > m_max_cost)
+					{ continue; }
+
+					next.g = new_g;
+					next.parent = static_cast<uint8_t>(k);
+					if(next.closed_in == m_iteration)
+					{
+						if(!next.inconsistent)
+						{
+							next.inconsistent = true;
+							m_inconsistent.push_back(next_loc);
+						}
+					}
+					else
+					{
+						m_open.push_back(pending_node{next_loc, new_g + weight*heuristic(next_loc), new_g});
+						std::ranges::push_heap(m_open, has_lower_priority);
+					}
+				}
+			}
+			return true;
+		}
+
+		// The ratio between the cost of the current route and a lower bound of the cheapest cost
+		double suboptimality_bound(double weight) const
+		{
+			auto lower_bound = infinity;
+			for(auto const& item : m_open)
+			{
+				auto const& n = get_node(item.loc);
+				if(item.g == n.g && n.closed_in != m_iteration)
+				{ lower_bound = std::min(lower_bound, n.g + heuristic(item.loc)); }
+			}
+
+			for(auto const loc : m_inconsistent)
+			{ lower_bound = std::min(lower_bound, get_node(loc).g + heuristic(loc)); }
+
+			auto const g_target = get_node(m_target).g;
+			return lower_bound >= g_target ? 1.0 : std::min(weight, g_target/lower_bound);
+		}
+
+		// Starts a new iteration. All nodes that were improved after being expanded are
+		// reconsidered, and all queue keys are recomputed with the new weight.
+		void begin_iteration(double weight)
+		{
+			++m_iteration;
+			std::vector<pending_node> open;
+			open.reserve(std::size(m_open) + std::size(m_inconsistent));
+			for(auto const& item : m_open)
+			{
+				auto const& n = get_node(item.loc);
+				if(item.g == n.g && n.closed_in != m_iteration - 1)
+				{ open.push_back(pending_node{item.loc, n.g + weight*heuristic(item.loc), n.g}); }
+			}
+
+			for(auto const loc : m_inconsistent)
+			{
+				auto& n = get_node(loc);
+				n.inconsistent = false;
+				open.push_back(pending_node{loc, n.g + weight*heuristic(loc), n.g});
+			}
+			m_inconsistent.clear();
+			std::ranges::make_heap(open, has_lower_priority);
+			m_open = std::move(open);
+		}
+
+		cheapest_route::path get_path() const
+		{
+			auto loc = m_target;
+			if(get_node(loc).g == infinity)
+			{ return cheapest_route::path{}; }
+
+			cheapest_route::path ret;
+			while(loc[0] != m_source[0] || loc[1] != m_source[1])
+			{
+				auto const& item = get_node(loc);
+				if(item.parent == no_parent || std::size(ret) > cheapest_route::lattice_detail::node_count(m_lattice))
+				{ throw std::runtime_error{"Inconsistent search tree"}; }
+
+				ret.push_back(cheapest_route::visited_node{
+					cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{scale_to_float(scale, loc)},
+					item.g
+				});
+				loc -= cheapest_route::vec<int64_t, 2>{neigbour_offsets[item.parent]};
+			}
+			ret.push_back(cheapest_route::visited_node{
+				cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{scale_to_float(scale, loc)},
+				0.0
+			});
+			std::ranges::reverse(ret);
+			return ret;
+		}
+
+	private:
+		cheapest_route::vec<int64_t, 2> m_source;
+		cheapest_route::vec<int64_t, 2> m_target;
+		lattice_rectangle m_lattice;
+		edge_cost m_cost;
+		double m_max_cost;
+		double m_min_cost_per_length;
+		std::unique_ptr<node[]> m_nodes;
+		std::vector<pending_node> m_open;
+		std::vector<cheapest_route::vec<int64_t, 2>> m_inconsistent;
+		uint32_t m_iteration;
+
+		node& get_node(cheapest_route::vec<int64_t, 2> loc) const
+		{ return get_item(m_nodes.get(), loc, m_lattice); }
+
+		double heuristic(cheapest_route::vec<int64_t, 2> loc) const
+		{
+			auto const d = scale_to_float(scale, m_target - loc);
+			return m_min_cost_per_length*std::sqrt(length_squared(d));
+		}
+	};
+}
+
+cheapest_route::anytime_search_result cheapest_route::anytime_search_impl(from<int64_t> source,
+	to<int64_t> target,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	anytime_search_options const& anytime_options)
+{
+	if(anytime_options.min_cost_per_length < 0.0)
+	{ throw std::runtime_error{"The minimum cost per length must be non-negative"}; }
+
+	if(anytime_options.initial_weight < 1.0)
+	{ throw std::runtime_error{"The initial heuristic weight must be at least 1"}; }
+
+	if(anytime_options.weight_step <= 0.0)
+	{ throw std::runtime_error{"The heuristic weight step must be positive"}; }
+
+	auto const deadline = make_deadline(anytime_options.time_budget);
+	auto const lattice = lattice_detail::make_search_lattice(source, target, domain, options);
+	auto const cost = lattice_detail::make_edge_cost(domain, callback_data, cost_function, options);
+	auto const source_loc = vec<int64_t, 2>{lattice_detail::scale_int*source};
+	auto const target_loc = vec<int64_t, 2>{lattice_detail::scale_int*target};
+	if((source[0] != target[0] || source[1] != target[1])
+		&& is_isolated(lattice_detail::scale_int*target, lattice, cost))
+	{ lattice_detail::throw_not_reached(target, options.max_cost); }
+
+	ara_star searcher{source_loc, target_loc, lattice, cost, options.max_cost, anytime_options.min_cost_per_length};
+
+	auto weight = anytime_options.initial_weight;
+	searcher.improve_path(weight, deadline, false);
+	anytime_search_result ret{searcher.get_path(), searcher.suboptimality_bound(weight), 1};
+	if(std::size(ret.route) == 0)
+	{ lattice_detail::throw_not_reached(target, options.max_cost); }
+
+	while(ret.suboptimality_bound > 1.0 && std::chrono::steady_clock::now() < deadline)
+	{
+		weight = std::max(1.0, std::min(weight, ret.suboptimality_bound) - anytime_options.weight_step);
+		searcher.begin_iteration(weight);
+		if(!searcher.improve_path(weight, deadline, true))
+		{ return ret; }
+
+		ret = anytime_search_result{searcher.get_path(), searcher.suboptimality_bound(weight), ret.iteration_count + 1};
+	}
+	return ret;
+}
@@ -0,0 +1,67 @@
+//@	{"dependencies_extra":[{"ref":"./anytime_search.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_ANYTIMESEARCH_HPP
+#define CHEAPESTROUTE_ANYTIMESEARCH_HPP
+
+#include "./search.hpp"
+
+#include <chrono>
+
+namespace cheapest_route
+{
+	struct anytime_search_options
+	{
+		// A lower bound of the cost of moving one pixel, in any direction. It is used as an
+		// A* heuristic, and the route is not guaranteed to be within the reported bound if the
+		// cost function can be cheaper than this.
+		double min_cost_per_length = 0.0;
+
+		// The heuristic weight of the first iteration. The first route is at most this many times
+		// as expensive as the cheapest one.
+		double initial_weight = 3.0;
+
+		// How much to decrease the weight between iterations
+		double weight_step = 0.5;
+
+		// The search returns the best route found so far when the time budget has expired. The
+		// first iteration always runs to completion.
+		std::chrono::steady_clock::duration time_budget = std::chrono::steady_clock::duration::max();
+	};
+
+	struct anytime_search_result
+	{
+		path route;
+
+		// The cost of route is at most suboptimality_bound times the cost of the cheapest route
+		double suboptimality_bound;
+		size_t iteration_count;
+	};
+
+	anytime_search_result anytime_search_impl(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		anytime_search_options const& anytime_options);
+
+	// Anytime Repairing A* (ARA*). Starts with an inflated heuristic to find a route quickly, and
+	// then improves it, reusing the previous search effort, while there is time left.
+	template<class CostFunction = flat_euclidian_norm>
+	anytime_search_result anytime_search(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{},
+		anytime_search_options const& anytime_options = anytime_search_options{})
+	{
+		return anytime_search_impl(source, target, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options, anytime_options);
+	}
+}
+
+#endif
@@ -0,0 +1,44 @@
+//@	{"target":{"name":"anytime_search.test"}}
+
+#include "./anytime_search.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		if(mid[0] > 60.0 && mid[0] < 62.0 && mid[1] > 20.0)
+		{ return std::numeric_limits<double>::infinity(); }
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const source = cheapest_route::from<int64_t>{12, 4};
+	for(auto target : {cheapest_route::to<int64_t>{150, 110},
+		cheapest_route::to<int64_t>{0, 119},
+		cheapest_route::to<int64_t>{12, 4}})
+	{
+		auto const optimal = search(source, target, domain, f).back().integrated_cost;
+
+		cheapest_route::anytime_search_options first_only;
+		first_only.min_cost_per_length = 0.5;
+		first_only.time_budget = std::chrono::steady_clock::duration::zero();
+		auto const first = anytime_search(source, target, domain, f, cheapest_route::search_options{}, first_only);
+		assert(first.iteration_count == 1);
+		assert(first.suboptimality_bound <= first_only.initial_weight);
+		assert(first.route.back().integrated_cost <= first.suboptimality_bound*optimal*(1.0 + 1.0e-9));
+
+		auto complete = first_only;
+		complete.time_budget = std::chrono::steady_clock::duration::max();
+		auto const best = anytime_search(source, target, domain, f, cheapest_route::search_options{}, complete);
+		printf("%.8g %.8g %.8g %zu %.8g\n", optimal, first.route.back().integrated_cost, first.suboptimality_bound,
+			best.iteration_count, best.route.back().integrated_cost);
+
+		assert(best.suboptimality_bound == 1.0);
+		assert(std::abs(best.route.back().integrated_cost - optimal) <= 1.0e-9*optimal);
+		assert(best.route.front().loc[0] == static_cast<double>(source[0]));
+		assert(best.route.back().loc[1] == static_cast<double>(target[1]));
+	}
+}
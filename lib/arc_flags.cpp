@@ -0,0 +1,220 @@
+//@	{"target":{"name":"arc_flags.o"}}
+
+#include "./arc_flags.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	using cheapest_route::lattice_detail::neigbour_offsets;
+	using cheapest_route::lattice_detail::lattice_rectangle;
+
+	struct pending_node
+	{
+		cheapest_route::vec<int64_t, 2> loc;
+		double integrated_cost;
+	};
+
+	struct boundary_node
+	{
+		cheapest_route::vec<int64_t, 2> loc;
+		size_t region;
+	};
+
+	constexpr auto no_direction = static_cast<uint8_t>(0xff);
+
+	// The cost of every edge, indexed by the node it starts at. Each backward search visits every
+	// edge, so the cost function is only called once per edge.
+	using edge_cost_set = std::array<double, std::size(neigbour_offsets)>;
+
+	void set_flag(std::span<uint64_t> bits, size_t index)
+	{ std::atomic_ref{bits[index/64]}.fetch_or(uint64_t{1} << (index%64), std::memory_order_relaxed); }
+
+	// Finds the cheapest route from every lattice node to target, following the edges backwards
+	class backward_search
+	{
+	public:
+		explicit backward_search(lattice_rectangle const& lattice):
+			m_lattice{lattice},
+			m_costs(cheapest_route::lattice_detail::node_count(lattice)),
+			m_directions(cheapest_route::lattice_detail::node_count(lattice))
+		{}
+
+		void run(cheapest_route::vec<int64_t, 2> target, std::span<edge_cost_set const> costs)
+		{
+			using cheapest_route::lattice_detail::get_item;
+
+			std::ranges::fill(m_costs, std::numeric_limits<double>::infinity());
+			std::ranges::fill(m_directions, no_direction);
+			m_queue.clear();
+
+			auto const cmp = [](pending_node const& a, pending_node const& b) {
+				return b.integrated_cost < a.integrated_cost;
+			};
+
+			get_item(std::data(m_costs), target, m_lattice) = 0.0;
+			m_queue.push_back(pending_node{target, 0.0});
+			while(!m_queue.empty())
+			{
+				std::ranges::pop_heap(m_queue, cmp);
+				auto const current = m_queue.back();
+				m_queue.pop_back();
+				if(current.integrated_cost > get_item(std::data(m_costs), current.loc, m_lattice))
+				{ continue; }
+
+				for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+				{
+					auto const prev_loc = current.loc - cheapest_route::vec<int64_t, 2>{neigbour_offsets[k]};
+					if(outside(prev_loc, m_lattice))
+					{ continue; }
+
+					auto const cost_increment = get_item(std::data(costs), prev_loc, m_lattice)[k];
+					auto const new_cost = current.integrated_cost + cost_increment;
+					auto& prev_cost = get_item(std::data(m_costs), prev_loc, m_lattice);
+					if(new_cost < prev_cost)
+					{
+						prev_cost = new_cost;
+						get_item(std::data(m_directions), prev_loc, m_lattice) = static_cast<uint8_t>(k);
+						m_queue.push_back(pending_node{prev_loc, new_cost});
+						std::ranges::push_heap(m_queue, cmp);
+					}
+				}
+			}
+		}
+
+		// The direction of the first edge on the route from loc, or no_direction if loc cannot
+		// reach the target
+		uint8_t direction(cheapest_route::vec<int64_t, 2> loc) const
+		{ return cheapest_route::lattice_detail::get_item(std::data(m_directions), loc, m_lattice); }
+
+	private:
+		lattice_rectangle m_lattice;
+		std::vector<double> m_costs;
+		std::vector<uint8_t> m_directions;
+		std::vector<pending_node> m_queue;
+	};
+}
+
+size_t cheapest_route::arc_flag_word_count(search_domain const& domain, int64_t region_size)
+{
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	auto const bit_count = lattice_detail::node_count(lattice)*std::size(neigbour_offsets)
+		*arc_flag_region_count(domain, region_size);
+	return (bit_count + 63)/64;
+}
+
+double cheapest_route::arc_flag_memory_usage(search_domain const& domain, int64_t region_size, size_t thread_count)
+{
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	auto const node_count = static_cast<double>(lattice_detail::node_count(lattice));
+	auto const flags = node_count*static_cast<double>(std::size(neigbour_offsets))
+		*static_cast<double>(arc_flag_region_count(domain, region_size))/8.0;
+	auto const search_state = node_count*static_cast<double>(sizeof(double) + sizeof(uint8_t));
+	return flags + node_count*static_cast<double>(sizeof(edge_cost_set))
+		+ static_cast<double>(std::max(thread_count, size_t{1}))*search_state;
+}
+
+cheapest_route::arc_flag_table::arc_flag_table(search_domain const& domain, int64_t region_size):
+	m_domain{domain},
+	m_region_size{region_size},
+	m_word_count{arc_flag_word_count(domain, region_size)},
+	m_bits{std::make_unique_for_overwrite<uint64_t[]>(m_word_count)}
+{ std::fill_n(m_bits.get(), m_word_count, uint64_t{0}); }
+
+cheapest_route::arc_flag_table cheapest_route::compute_arc_flags_impl(search_domain const& domain,
+	int64_t region_size,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	size_t thread_count)
+{
+	if(domain.width() < 1 || domain.height() < 1)
+	{ throw std::runtime_error{"Empty search domain"}; }
+
+	if(region_size < 1)
+	{ throw std::runtime_error{"The region size must be at least one pixel"}; }
+
+	arc_flag_table ret{domain, region_size};
+	auto const view = ret.view();
+	auto const bits = ret.bits();
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	auto const cost = lattice_detail::make_edge_cost(domain, callback_data, cost_function, options);
+
+	std::vector<edge_cost_set> costs(lattice_detail::node_count(lattice));
+	for(auto y = lattice.vert_interval.min; y != lattice.vert_interval.max; ++y)
+	{
+		for(auto x = lattice.horz_interval.min; x != lattice.horz_interval.max; ++x)
+		{
+			auto const loc = vec<int64_t, 2>{x, y};
+			auto& item = lattice_detail::get_item(std::data(costs), loc, lattice);
+			cost(loc, lattice, lattice_detail::all_directions, item);
+			if(std::ranges::any_of(item, [](auto val) { return val < 0.0; }))
+			{ throw std::runtime_error{"Cost function must be positive"}; }
+		}
+	}
+
+	// A route that ends inside a region can be split at the last time it enters the region. Edges
+	// after that point stay inside the region, and the route up to that point is a cheapest route
+	// to one of the boundary nodes.
+	std::vector<boundary_node> boundary;
+	for(auto y = lattice.vert_interval.min; y != lattice.vert_interval.max; ++y)
+	{
+		for(auto x = lattice.horz_interval.min; x != lattice.horz_interval.max; ++x)
+		{
+			auto const loc = vec<int64_t, 2>{x, y};
+			auto const region = lattice_detail::arc_flag_region(view, loc);
+			auto on_boundary = false;
+			for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+			{
+				auto const next_loc = loc + vec<int64_t, 2>{neigbour_offsets[k]};
+				if(!outside(next_loc, lattice) && lattice_detail::arc_flag_region(view, next_loc) == region)
+				{ set_flag(bits, lattice_detail::arc_flag_index(view, lattice, loc, k, region)); }
+
+				auto const prev_loc = loc - vec<int64_t, 2>{neigbour_offsets[k]};
+				if(!outside(prev_loc, lattice) && lattice_detail::arc_flag_region(view, prev_loc) != region)
+				{ on_boundary = true; }
+			}
+
+			if(on_boundary)
+			{ boundary.push_back(boundary_node{loc, region}); }
+		}
+	}
+
+	std::atomic<size_t> next_node{0};
+	{
+		std::vector<std::jthread> workers;
+		for(size_t k = 0; k != std::max(thread_count, size_t{1}); ++k)
+		{
+			workers.emplace_back([&]() {
+				backward_search search{lattice};
+				while(true)
+				{
+					auto const index = next_node++;
+					if(index >= std::size(boundary))
+					{ return; }
+
+					auto const& target = boundary[index];
+					search.run(target.loc, costs);
+
+					for(auto y = lattice.vert_interval.min; y != lattice.vert_interval.max; ++y)
+					{
+						for(auto x = lattice.horz_interval.min; x != lattice.horz_interval.max; ++x)
+						{
+							auto const loc = vec<int64_t, 2>{x, y};
+							auto const direction = search.direction(loc);
+							if(direction != no_direction)
+							{ set_flag(bits, lattice_detail::arc_flag_index(view, lattice, loc, direction, target.region)); }
+						}
+					}
+				}
+			});
+		}
+	}
+
+	return ret;
+}
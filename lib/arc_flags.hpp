@@ -0,0 +1,90 @@
+//@	{"dependencies_extra":[{"ref":"./arc_flags.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_ARCFLAGS_HPP
+#define CHEAPESTROUTE_ARCFLAGS_HPP
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace cheapest_route
+{
+	// The domain is split into square regions of region_size pixels. For every lattice edge, and
+	// every region, a bit tells whether the edge lies on a cheapest route into that region. Bit
+	// (node*32 + direction)*region_count + region is stored in bits, where node is the index of
+	// the lattice node that the edge starts at.
+	struct arc_flags_view
+	{
+		search_domain domain;
+		int64_t region_size;
+		std::span<uint64_t const> bits;
+	};
+
+	constexpr int64_t arc_flag_regions_x(search_domain const& domain, int64_t region_size)
+	{ return (domain.width() + region_size - 1)/region_size; }
+
+	constexpr int64_t arc_flag_regions_y(search_domain const& domain, int64_t region_size)
+	{ return (domain.height() + region_size - 1)/region_size; }
+
+	constexpr size_t arc_flag_region_count(search_domain const& domain, int64_t region_size)
+	{ return static_cast<size_t>(arc_flag_regions_x(domain, region_size)*arc_flag_regions_y(domain, region_size)); }
+
+	size_t arc_flag_word_count(search_domain const& domain, int64_t region_size);
+
+	// The approximate number of bytes that compute_arc_flags allocates: the flags, the cost of every
+	// edge, and the state of each search thread. It is computed in floating point, since it may not
+	// fit in a size_t.
+	double arc_flag_memory_usage(search_domain const& domain, int64_t region_size, size_t thread_count);
+
+	class arc_flag_table
+	{
+	public:
+		// No edge is flagged initially
+		explicit arc_flag_table(search_domain const& domain, int64_t region_size);
+
+		arc_flags_view view() const
+		{ return arc_flags_view{m_domain, m_region_size, std::span{m_bits.get(), m_word_count}}; }
+
+		std::span<uint64_t> bits()
+		{ return std::span{m_bits.get(), m_word_count}; }
+
+	private:
+		search_domain m_domain;
+		int64_t m_region_size;
+		size_t m_word_count;
+		std::unique_ptr<uint64_t[]> m_bits;
+	};
+
+	arc_flag_table compute_arc_flags_impl(search_domain const& domain,
+		int64_t region_size,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		size_t thread_count);
+
+	// Runs one backward search from every lattice node on the boundary of every region, using
+	// thread_count threads, and flags the edges of the resulting trees. Edges within a region are
+	// always flagged for that region. Only edge_weights and passability are used among the options,
+	// and searches that use the flags must use the same options. The cost function is called
+	// concurrently.
+	template<class CostFunction = flat_euclidian_norm>
+	arc_flag_table compute_arc_flags(search_domain const& domain,
+		int64_t region_size,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{},
+		size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		return compute_arc_flags_impl(domain, region_size, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options, thread_count);
+	}
+}
+
+#endif
@@ -0,0 +1,60 @@
+//@	{"target":{"name":"arc_flags.test"}}
+
+#include "./arc_flags.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{24, 16};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		if(mid[0] > 11.0 && mid[0] < 13.0 && mid[1] > 3.0)
+		{ return 50.0*std::sqrt(length_squared(x1 - x0)); }
+		return (1.0 + 0.5*std::sin(mid[0]/5.0)*std::cos(mid[1]/3.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const table = compute_arc_flags(domain, 8, f, cheapest_route::search_options{}, 2);
+	auto const flags = table.view();
+	assert(arc_flag_memory_usage(domain, 8, 2) > static_cast<double>(std::size(flags.bits)*sizeof(uint64_t)));
+	cheapest_route::search_options options;
+	options.arc_flags = &flags;
+
+	for(auto const& [source, target] : {
+		std::pair{cheapest_route::from<int64_t>{1, 14}, cheapest_route::to<int64_t>{22, 13}},
+		std::pair{cheapest_route::from<int64_t>{22, 1}, cheapest_route::to<int64_t>{2, 11}},
+		std::pair{cheapest_route::from<int64_t>{3, 3}, cheapest_route::to<int64_t>{5, 4}},
+		std::pair{cheapest_route::from<int64_t>{18, 10}, cheapest_route::to<int64_t>{18, 10}}})
+	{
+		size_t direct_calls = 0;
+		size_t pruned_calls = 0;
+		auto const direct = search(source, target, domain, [&direct_calls, f](auto x0, auto x1) {
+			++direct_calls;
+			return f(x0, x1);
+		});
+		auto const pruned = search(source, target, domain, [&pruned_calls, f](auto x0, auto x1) {
+			++pruned_calls;
+			return f(x0, x1);
+		}, options);
+		printf("%zu %.8g %zu %.8g %zu %zu\n",
+			std::size(direct), direct.back().integrated_cost,
+			std::size(pruned), pruned.back().integrated_cost,
+			direct_calls, pruned_calls);
+
+		assert(std::abs(pruned.back().integrated_cost - direct.back().integrated_cost)
+			<= 1.0e-9*direct.back().integrated_cost);
+		assert(pruned_calls <= direct_calls);
+	}
+
+	try
+	{
+		auto with_bounds = options;
+		with_bounds.bounds = cheapest_route::search_bounds{domain, cheapest_route::origin_at_zero{}};
+		search(cheapest_route::from<int64_t>{0, 0}, cheapest_route::to<int64_t>{1, 1}, domain, f, with_bounds);
+		abort();
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+}
@@ -0,0 +1,52 @@
+#ifndef CHEAPESTROUTE_ASYNCSEARCH_HPP
+#define CHEAPESTROUTE_ASYNCSEARCH_HPP
+
+#include "./search.hpp"
+#include "./search_monitor.hpp"
+
+#include <future>
+#include <stop_token>
+#include <utility>
+
+namespace cheapest_route
+{
+	struct ignore_progress
+	{
+		void operator()(search_progress const&) const
+		{}
+	};
+
+	// Runs search on a separate thread. The future throws search_cancelled if stop is requested
+	// before the route has been found. on_progress is called from the search thread, as
+	// described for search_monitor. Any monitor in options is replaced. The data that options
+	// point to must outlive the query.
+	template<class CostFunction = flat_euclidian_norm, class ProgressCallback = ignore_progress>
+	std::future<path> search_async(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		CostFunction f = flat_euclidian_norm{},
+		search_options const& options = search_options{},
+		std::stop_token stop = std::stop_token{},
+		ProgressCallback on_progress = ignore_progress{},
+		double min_cost_per_length = 0.0)
+	{
+		return std::async(std::launch::async,
+			[source, target, domain, f = std::move(f), options, stop = std::move(stop),
+				on_progress = std::move(on_progress), min_cost_per_length]() mutable {
+				search_monitor const monitor{
+					stop,
+					&on_progress,
+					[](void* callback_data, search_progress const& progress) {
+						(*static_cast<ProgressCallback*>(callback_data))(progress);
+					},
+					min_cost_per_length
+				};
+
+				auto monitored_options = options;
+				monitored_options.monitor = &monitor;
+				return search(source, target, domain, f, monitored_options);
+			});
+	}
+}
+
+#endif
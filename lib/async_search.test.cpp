@@ -0,0 +1,79 @@
+//@	{"target":{"name":"async_search.test"}}
+
+#include "./async_search.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{200, 150};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+	auto const source = cheapest_route::from<int64_t>{3, 4};
+	auto const target = cheapest_route::to<int64_t>{190, 140};
+
+	{
+		std::vector<cheapest_route::search_progress> reports;
+		auto result = search_async(source, target, domain, f, cheapest_route::search_options{}, std::stop_token{},
+			[&reports](cheapest_route::search_progress const& progress) { reports.push_back(progress); },
+			0.5);
+		auto const route = result.get();
+		auto const expected = search(source, target, domain, f);
+		printf("%zu %.8g %zu\n", std::size(route), route.back().integrated_cost, std::size(reports));
+		assert(std::ranges::equal(route, expected, [](auto const& a, auto const& b) {
+			return a.loc[0] == b.loc[0] && a.loc[1] == b.loc[1] && a.integrated_cost == b.integrated_cost;
+		}));
+
+		assert(std::size(reports) > 1);
+		assert(std::ranges::is_sorted(reports, {}, &cheapest_route::search_progress::frontier_cost));
+		assert(std::ranges::is_sorted(reports, {}, &cheapest_route::search_progress::settled_count));
+		assert(reports.back().frontier_cost <= route.back().integrated_cost);
+		assert(std::abs(reports.front().lower_bound - 0.5*std::sqrt(187.0*187.0 + 136.0*136.0)) < 1.0e-9);
+	}
+
+	// Stop the search from the progress callback, after the first few reports
+	{
+		std::stop_source stop;
+		size_t report_count = 0;
+		auto result = search_async(source, target, domain, f, cheapest_route::search_options{}, stop.get_token(),
+			[&stop, &report_count](cheapest_route::search_progress const&) {
+				if(++report_count == 3)
+				{ stop.request_stop(); }
+			});
+		try
+		{
+			result.get();
+			assert(false);
+		}
+		catch(cheapest_route::search_cancelled const&)
+		{}
+		assert(report_count == 3);
+	}
+
+	// A query that is stopped before it starts does not do any work
+	{
+		std::stop_source stop;
+		stop.request_stop();
+		size_t call_count = 0;
+		auto result = search_async(source, target, domain,
+			[&call_count, f](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+				++call_count;
+				return f(x0, x1);
+			},
+			cheapest_route::search_options{}, stop.get_token());
+		try
+		{
+			result.get();
+			assert(false);
+		}
+		catch(cheapest_route::search_cancelled const&)
+		{}
+		assert(call_count == 0);
+	}
+}
@@ -0,0 +1,73 @@
+//@	{"target":{"name":"batch_cost.test"}}
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	struct counting_cost_function
+	{
+		double operator()(cheapest_route::from<double> x0, cheapest_route::to<double> x1) const
+		{
+			++single_calls;
+			return cost(x0, x1);
+		}
+
+		void evaluate_batch(cheapest_route::from<double> x0,
+			std::span<cheapest_route::to<double> const> x1,
+			std::span<double> costs) const
+		{
+			assert(std::size(x1) == std::size(costs));
+			assert(std::size(x1) <= 32);
+			++batch_calls;
+			for(size_t k = 0; k != std::size(x1); ++k)
+			{ costs[k] = cost(x0, x1[k]); }
+		}
+
+		static double cost(cheapest_route::from<double> x0, cheapest_route::to<double> x1)
+		{
+			auto const mid = midpoint(x1, x0);
+			return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+		}
+
+		mutable size_t single_calls = 0;
+		mutable size_t batch_calls = 0;
+	};
+}
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{64, 48};
+	auto const source = cheapest_route::from<int64_t>{3, 4};
+	auto const target = cheapest_route::to<int64_t>{60, 40};
+
+	counting_cost_function f;
+	auto const expected = search(source, target, domain, f);
+	assert(f.batch_calls == 0);
+
+	f.single_calls = 0;
+	auto const batch = cheapest_route::make_batch_cost_function(f);
+	auto options = cheapest_route::search_options{};
+	options.batch_cost = &batch;
+	auto const route = search(source, target, domain, f, options);
+	printf("%zu %.8g %zu %zu\n", std::size(route), route.back().integrated_cost, f.single_calls, f.batch_calls);
+	assert(std::ranges::equal(route, expected, [](auto const& a, auto const& b) {
+		return a.loc[0] == b.loc[0] && a.loc[1] == b.loc[1] && a.integrated_cost == b.integrated_cost;
+	}));
+
+	// Only the check for an isolated target evaluates single edges
+	assert(f.single_calls <= 32);
+	assert(f.batch_calls > 0);
+
+	auto const pixel_count = static_cast<size_t>(domain.width()*domain.height());
+	std::vector<float> expected_costs(pixel_count);
+	std::vector<float> costs(pixel_count);
+	compute_cost_field(source, domain, expected_costs, f);
+	compute_cost_field(source, domain, costs, f, options);
+	assert(costs == expected_costs);
+}
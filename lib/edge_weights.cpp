@@ -0,0 +1,101 @@
+//@	{"target":{"name":"edge_weights.o"}}
+
+#include "./edge_weights.hpp"
+#include "./lattice.hpp"
+
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+cheapest_route::edge_weight_table::edge_weight_table(search_domain const& domain):
+	m_domain{domain},
+	m_node_count{lattice_detail::node_count(
+		lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}}))},
+	m_weights{std::make_unique_for_overwrite<edge_weight_set[]>(m_node_count)}
+{}
+
+cheapest_route::edge_weight_table cheapest_route::compile_edge_weights_impl(search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	size_t thread_count)
+{
+	using lattice_detail::neigbour_offsets;
+
+	if(domain.width() < 1 || domain.height() < 1)
+	{ throw std::runtime_error{"Empty search domain"}; }
+
+	edge_weight_table ret{domain};
+	auto const weights = ret.weights();
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+
+	// Nodes in the padding of partial tiles are never visited, but are stored together with the rest
+	edge_weight_set unused;
+	unused.fill(std::numeric_limits<float>::infinity());
+	std::ranges::fill(weights, unused);
+
+	std::atomic<bool> negative_cost{false};
+	auto const compile_row = [&](int64_t y) {
+		for(auto x = lattice.horz_interval.min; x != lattice.horz_interval.max; ++x)
+		{
+			auto const loc = vec<int64_t, 2>{x, y};
+			auto& item = lattice_detail::get_item(std::data(weights), loc, lattice);
+			auto const loc_scaled = scale_to_float(lattice_detail::scale, from<int64_t>{loc});
+			for(size_t l = 0; l != stored_directions; ++l)
+			{
+				auto const next_loc = loc + vec<int64_t, 2>{neigbour_offsets[l]};
+				if(outside(next_loc, lattice))
+				{
+					item[l] = std::numeric_limits<float>::infinity();
+					continue;
+				}
+
+				auto const val = cost_function(callback_data,
+					loc_scaled,
+					scale_to_float(lattice_detail::scale, to<int64_t>{next_loc}));
+				if(val < 0.0)
+				{ negative_cost = true; }
+				item[l] = static_cast<float>(val);
+			}
+		}
+	};
+
+	// Rows are handed out one by one, so threads that get cheap rows continue with others
+	std::atomic<int64_t> next_row{lattice.vert_interval.min};
+	std::vector<std::exception_ptr> errors(std::max(thread_count, size_t{1}));
+	{
+		std::vector<std::jthread> workers;
+		for(size_t k = 0; k != std::size(errors); ++k)
+		{
+			workers.emplace_back([&, k]() {
+				while(true)
+				{
+					auto const y = next_row++;
+					if(y >= lattice.vert_interval.max)
+					{ return; }
+
+					try
+					{ compile_row(y); }
+					catch(...)
+					{
+						// Stop handing out rows to the other threads
+						errors[k] = std::current_exception();
+						next_row = lattice.vert_interval.max;
+						return;
+					}
+				}
+			});
+		}
+	}
+
+	for(auto const& item : errors)
+	{
+		if(item != nullptr)
+		{ std::rethrow_exception(item); }
+	}
+
+	if(negative_cost)
+	{ throw std::runtime_error{"Cost function must be positive"}; }
+
+	return ret;
+}
@@ -0,0 +1,66 @@
+//@	{"dependencies_extra":[{"ref":"./edge_weights.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_EDGEWEIGHTS_HPP
+#define CHEAPESTROUTE_EDGEWEIGHTS_HPP
+
+#include "./search.hpp"
+
+#include <array>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace cheapest_route
+{
+	// Edges are symmetric, so only the first half of the 32 directions are stored for each
+	// lattice node. The other half is found at the neighbour in the opposite direction.
+	constexpr size_t stored_directions = 16;
+
+	using edge_weight_set = std::array<float, stored_directions>;
+
+	struct edge_weights_view
+	{
+		search_domain domain;
+		std::span<edge_weight_set const> weights;
+	};
+
+	class edge_weight_table
+	{
+	public:
+		explicit edge_weight_table(search_domain const& domain);
+
+		edge_weights_view view() const
+		{ return edge_weights_view{m_domain, std::span{m_weights.get(), m_node_count}}; }
+
+		std::span<edge_weight_set> weights()
+		{ return std::span{m_weights.get(), m_node_count}; }
+
+	private:
+		search_domain m_domain;
+		size_t m_node_count;
+		std::unique_ptr<edge_weight_set[]> m_weights;
+	};
+
+	edge_weight_table compile_edge_weights_impl(search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		size_t thread_count);
+
+	// Evaluates the weight of every lattice edge in domain, using thread_count threads. The cost
+	// function is called concurrently, and must be symmetric. If it throws, the exception is rethrown
+	// here once all threads have stopped.
+	template<class CostFunction = flat_euclidian_norm>
+	edge_weight_table compile_edge_weights(search_domain const& domain,
+		CostFunction&& f = flat_euclidian_norm{},
+		size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		return compile_edge_weights_impl(domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, thread_count);
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+//@	{"target":{"name":"edge_weights.test"}}
+
+#include "./edge_weights.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		if(mid[0] > 60.0 && mid[0] < 62.0 && mid[1] > 20.0)
+		{ return std::numeric_limits<double>::infinity(); }
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const table = compile_edge_weights(domain, f, 3);
+	auto const weights = table.view();
+	cheapest_route::search_options options;
+	options.edge_weights = &weights;
+
+	for(auto target : {cheapest_route::to<int64_t>{150, 110},
+		cheapest_route::to<int64_t>{0, 119},
+		cheapest_route::to<int64_t>{12, 4}})
+	{
+		auto const source = cheapest_route::from<int64_t>{12, 4};
+		auto const direct = search(source, target, domain, f);
+		auto const compiled = search(source, target, domain, f, options);
+		printf("%zu %.8g %zu %.8g\n",
+			std::size(direct), direct.back().integrated_cost,
+			std::size(compiled), compiled.back().integrated_cost);
+
+		assert(std::abs(compiled.back().integrated_cost - direct.back().integrated_cost)
+			<= 1.0e-5*direct.back().integrated_cost);
+	}
+
+	try
+	{
+		auto const other_domain = cheapest_route::search_domain{100, 120};
+		search(cheapest_route::from<int64_t>{0, 0}, cheapest_route::to<int64_t>{1, 1}, other_domain,
+			f, options);
+		abort();
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+
+	// An exception thrown by the cost function on a worker thread reaches the caller
+	try
+	{
+		compile_edge_weights(cheapest_route::search_domain{40, 30},
+			[](cheapest_route::from<double> x0, cheapest_route::to<double>) -> double {
+				if(x0[1] > 15.0)
+				{ throw std::runtime_error{"Cost map not available"}; }
+				return 1.0;
+			},
+			4);
+		abort();
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+}
@@ -0,0 +1,238 @@
+//@	{"target":{"name":"incremental_search.o"}}
+
+#include "./incremental_search.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+	using cheapest_route::lattice_detail::scale_int;
+	using cheapest_route::lattice_detail::neigbour_offsets;
+	using cheapest_route::lattice_detail::make_lattice_rectangle;
+	using cheapest_route::lattice_detail::get_item;
+
+	constexpr auto no_parent = std::numeric_limits<uint8_t>::max();
+	constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+	template<class Node>
+	double get_key(Node const& node)
+	{ return std::min(node.g, node.rhs); }
+
+	template<class PendingNode>
+	bool has_lower_priority(PendingNode const& a, PendingNode const& b)
+	{ return a.key > b.key; }
+}
+
+cheapest_route::incremental_search::incremental_search(from<int64_t> source,
+	to<int64_t> target,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function):
+	m_source{source},
+	m_target{target},
+	m_domain{domain},
+	m_callback_data{callback_data},
+	m_cost_function{cost_function},
+	m_expanded_node_count{0}
+{
+	if(domain.width() < 1 || domain.height() < 1)
+	{ throw std::runtime_error{"Empty search domain"}; }
+
+	if(outside(vec<int64_t, 2>{source}, domain))
+	{ throw std::runtime_error{"Source location is outside search domain"}; }
+
+	if(outside(vec<int64_t, 2>{target}, domain))
+	{ throw std::runtime_error{"Target location is outside search domain"}; }
+
+	m_lattice = make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	auto const node_count = lattice_detail::node_count(m_lattice);
+	m_nodes = std::make_unique_for_overwrite<node[]>(node_count);
+	std::fill_n(m_nodes.get(), node_count, node{infinity, infinity, no_parent});
+
+	auto const source_loc = vec<int64_t, 2>{scale_int*source};
+	get_node(source_loc).rhs = 0.0;
+	m_queue.push_back(pending_node{source_loc, 0.0});
+}
+
+cheapest_route::incremental_search::node&
+cheapest_route::incremental_search::get_node(vec<int64_t, 2> loc) const
+{ return get_item(m_nodes.get(), loc, m_lattice); }
+
+double cheapest_route::incremental_search::cost(vec<int64_t, 2> from_loc, vec<int64_t, 2> to_loc) const
+{
+	auto const ret = m_cost_function(m_callback_data,
+		scale_to_float(lattice_detail::scale, from<int64_t>{from_loc}),
+		scale_to_float(lattice_detail::scale, to<int64_t>{to_loc}));
+
+	if(ret < 0.0)
+	{ throw std::runtime_error{"Cost function must be positive"}; }
+
+	return ret;
+}
+
+void cheapest_route::incremental_search::update_rhs(vec<int64_t, 2> loc)
+{
+	auto& item = get_node(loc);
+	if(loc[0] == scale_int*m_source[0] && loc[1] == scale_int*m_source[1])
+	{
+		item.rhs = 0.0;
+		item.parent = no_parent;
+		return;
+	}
+
+	item.rhs = infinity;
+	item.parent = no_parent;
+	for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+	{
+		auto const pred_loc = loc - vec<int64_t, 2>{neigbour_offsets[k]};
+		if(outside(pred_loc, m_lattice))
+		{ continue; }
+
+		auto const& pred = get_node(pred_loc);
+		if(pred.g == infinity)
+		{ continue; }
+
+		auto const new_rhs = pred.g + cost(pred_loc, loc);
+		if(new_rhs < item.rhs)
+		{
+			item.rhs = new_rhs;
+			item.parent = static_cast<uint8_t>(k);
+		}
+	}
+}
+
+void cheapest_route::incremental_search::enqueue_if_inconsistent(vec<int64_t, 2> loc)
+{
+	auto const& item = get_node(loc);
+	if(item.g != item.rhs)
+	{
+		m_queue.push_back(pending_node{loc, get_key(item)});
+		std::ranges::push_heap(m_queue, has_lower_priority<pending_node>);
+	}
+}
+
+void cheapest_route::incremental_search::compute_shortest_path()
+{
+	auto const& target = get_node(vec<int64_t, 2>{scale_int*m_target});
+	while(true)
+	{
+		// Entries are not removed when a node is re-queued, so drop the outdated ones
+		while(!m_queue.empty())
+		{
+			auto const& top = m_queue.front();
+			auto const& item = get_node(top.loc);
+			if(item.g != item.rhs && top.key == get_key(item))
+			{ break; }
+			std::ranges::pop_heap(m_queue, has_lower_priority<pending_node>);
+			m_queue.pop_back();
+		}
+
+		if(m_queue.empty())
+		{ return; }
+
+		if(!(m_queue.front().key < get_key(target) || target.g != target.rhs))
+		{ return; }
+
+		auto const loc = m_queue.front().loc;
+		std::ranges::pop_heap(m_queue, has_lower_priority<pending_node>);
+		m_queue.pop_back();
+		++m_expanded_node_count;
+
+		auto& item = get_node(loc);
+		if(item.g > item.rhs)
+		{
+			item.g = item.rhs;
+			for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+			{
+				auto const next_loc = loc + vec<int64_t, 2>{neigbour_offsets[k]};
+				if(outside(next_loc, m_lattice))
+				{ continue; }
+
+				auto const cost_increment = cost(loc, next_loc);
+				if(cost_increment == infinity)
+				{ continue; }
+
+				auto& next = get_node(next_loc);
+				auto const new_rhs = item.g + cost_increment;
+				if(new_rhs < next.rhs)
+				{
+					next.rhs = new_rhs;
+					next.parent = static_cast<uint8_t>(k);
+					enqueue_if_inconsistent(next_loc);
+				}
+			}
+		}
+		else
+		{
+			item.g = infinity;
+			update_rhs(loc);
+			enqueue_if_inconsistent(loc);
+			for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+			{
+				auto const next_loc = loc + vec<int64_t, 2>{neigbour_offsets[k]};
+				if(outside(next_loc, m_lattice))
+				{ continue; }
+
+				if(get_node(next_loc).parent == k)
+				{
+					update_rhs(next_loc);
+					enqueue_if_inconsistent(next_loc);
+				}
+			}
+		}
+	}
+}
+
+void cheapest_route::incremental_search::invalidate(std::span<search_bounds const> changed_pixels)
+{
+	// An edge samples the cost map at its end points and its midpoint, using bilinear
+	// interpolation. Edges are at most one pixel long, so all edges that depend on a changed
+	// pixel ends within two pixels from it.
+	constexpr int64_t margin = 2;
+	for(auto const& rect : changed_pixels)
+	{
+		auto const x_min = std::max(scale_int*(rect.horz_interval.min - margin), m_lattice.horz_interval.min);
+		auto const x_max = std::min(scale_int*(rect.horz_interval.max - 1 + margin) + 1, m_lattice.horz_interval.max);
+		auto const y_min = std::max(scale_int*(rect.vert_interval.min - margin), m_lattice.vert_interval.min);
+		auto const y_max = std::min(scale_int*(rect.vert_interval.max - 1 + margin) + 1, m_lattice.vert_interval.max);
+
+		for(auto y = y_min; y < y_max; ++y)
+		{
+			for(auto x = x_min; x < x_max; ++x)
+			{
+				auto const loc = vec<int64_t, 2>{x, y};
+				update_rhs(loc);
+				enqueue_if_inconsistent(loc);
+			}
+		}
+	}
+}
+
+cheapest_route::path cheapest_route::incremental_search::find_path()
+{
+	compute_shortest_path();
+
+	auto const source_loc = vec<int64_t, 2>{scale_int*m_source};
+	auto loc = vec<int64_t, 2>{scale_int*m_target};
+	if(get_node(loc).g == infinity)
+	{ throw std::runtime_error{std::string{"Target "}.append(to_string(m_target)).append(" not reached")}; }
+
+	path ret;
+	while(loc[0] != source_loc[0] || loc[1] != source_loc[1])
+	{
+		auto const& item = get_node(loc);
+		if(item.parent == no_parent || std::size(ret) > static_cast<size_t>(m_lattice.width()*m_lattice.height()))
+		{ throw std::runtime_error{"Inconsistent search tree"}; }
+
+		ret.push_back(visited_node{
+			vec<double, 2, quantity_type::point>{scale_to_float(lattice_detail::scale, loc)}, item.g
+		});
+		loc -= vec<int64_t, 2>{neigbour_offsets[item.parent]};
+	}
+	ret.push_back(visited_node{vec<double, 2, quantity_type::point>{scale_to_float(lattice_detail::scale, loc)}, 0.0});
+	std::ranges::reverse(ret);
+	return ret;
+}
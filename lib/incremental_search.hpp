@@ -0,0 +1,83 @@
+//@	{"dependencies_extra":[{"ref":"./incremental_search.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_INCREMENTALSEARCH_HPP
+#define CHEAPESTROUTE_INCREMENTALSEARCH_HPP
+
+#include "./search.hpp"
+
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	// Keeps the search state between queries, so the route can be repaired after parts of the
+	// cost map have been changed (Lifelong Planning A*, without heuristic). The cost function is
+	// referenced, not copied, and must outlive the incremental_search object.
+	class incremental_search
+	{
+	public:
+		template<class CostFunction>
+		explicit incremental_search(from<int64_t> source,
+			to<int64_t> target,
+			search_domain const& domain,
+			CostFunction const& f):
+			incremental_search{source, target, domain, &f, [](void const* func_pair,
+				from<double> x0,
+				to<double> x1){
+				auto const& data = *static_cast<CostFunction const*>(func_pair);
+				return static_cast<double>(data(x0, x1));
+			}}
+		{}
+
+		explicit incremental_search(from<int64_t> source,
+			to<int64_t> target,
+			search_domain const& domain,
+			void const* callback_data,
+			cost_function_ptr cost_function);
+
+		// Tells that the pixels within the given rectangles have changed, and that all edges
+		// depending on these pixels must be re-evaluated
+		void invalidate(std::span<search_bounds const> changed_pixels);
+
+		// Computes, or repairs, the cheapest route. Only nodes affected by changes made since the
+		// previous call are processed.
+		path find_path();
+
+		size_t expanded_node_count() const
+		{ return m_expanded_node_count; }
+
+	private:
+		struct node
+		{
+			double g;
+			double rhs;
+			uint8_t parent;
+		};
+
+		struct pending_node
+		{
+			vec<int64_t, 2> loc;
+			double key;
+		};
+
+		from<int64_t> m_source;
+		to<int64_t> m_target;
+		search_domain m_domain;
+		void const* m_callback_data;
+		cost_function_ptr m_cost_function;
+
+		search_bounds m_lattice;
+		std::unique_ptr<node[]> m_nodes;
+		std::vector<pending_node> m_queue;
+		size_t m_expanded_node_count;
+
+		node& get_node(vec<int64_t, 2> loc) const;
+		double cost(vec<int64_t, 2> from_loc, vec<int64_t, 2> to_loc) const;
+		void update_rhs(vec<int64_t, 2> loc);
+		void enqueue_if_inconsistent(vec<int64_t, 2> loc);
+		void compute_shortest_path();
+	};
+}
+
+#endif
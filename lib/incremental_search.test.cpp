@@ -0,0 +1,81 @@
+//@	{"target":{"name":"incremental_search.test"}}
+
+#include "./incremental_search.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+namespace
+{
+	struct cost_map
+	{
+		int64_t size;
+		std::vector<float> friction;
+
+		double operator()(cheapest_route::from<double> x0, cheapest_route::to<double> x1) const
+		{
+			auto const mid = midpoint(x1, x0);
+			auto const val = friction[static_cast<int64_t>(mid[1])*size + static_cast<int64_t>(mid[0])];
+			return val*std::sqrt(length_squared(x1 - x0));
+		}
+
+		void fill(cheapest_route::search_bounds const& rect, float value)
+		{
+			for(auto y = rect.vert_interval.min; y != rect.vert_interval.max; ++y)
+			{
+				for(auto x = rect.horz_interval.min; x != rect.horz_interval.max; ++x)
+				{ friction[y*size + x] = value; }
+			}
+		}
+	};
+
+	void check_same_cost(cheapest_route::path const& a, cheapest_route::path const& b)
+	{
+		printf("%.8g %.8g\n", a.back().integrated_cost, b.back().integrated_cost);
+		assert(std::abs(a.back().integrated_cost - b.back().integrated_cost) < 1.0e-9*b.back().integrated_cost);
+	}
+}
+
+int main()
+{
+	int64_t const size = 96;
+	auto const domain = cheapest_route::search_domain{size, size};
+	cost_map costs{size, std::vector<float>(size*size, 1.0f)};
+
+	auto const source = cheapest_route::from<int64_t>{4, 48};
+	auto const target = cheapest_route::to<int64_t>{90, 50};
+
+	cheapest_route::incremental_search engine{source, target, domain, costs};
+	check_same_cost(engine.find_path(), search(source, target, domain, costs));
+	auto const initial_expansions = engine.expanded_node_count();
+
+	// Put a wall across the route
+	auto const wall = cheapest_route::search_bounds{"(40, 20, 44, 80)"};
+	costs.fill(wall, std::numeric_limits<float>::infinity());
+	engine.invalidate(std::span{&wall, 1});
+	auto const with_wall = engine.find_path();
+	check_same_cost(with_wall, search(source, target, domain, costs));
+	assert(with_wall.back().integrated_cost > 86.0);
+
+	// The extracted path must be consistent with the costs
+	for(size_t k = 1; k != std::size(with_wall); ++k)
+	{
+		auto const c = costs(cheapest_route::from<double>{with_wall[k - 1].loc},
+			cheapest_route::to<double>{with_wall[k].loc});
+		assert(std::abs(with_wall[k - 1].integrated_cost + c - with_wall[k].integrated_cost) < 1.0e-9);
+	}
+
+	// Open a gap in the wall. Repairing should be cheaper than starting over.
+	auto const gap = cheapest_route::search_bounds{"(40, 46, 44, 52)"};
+	costs.fill(gap, 1.0f);
+	auto const expansions_before = engine.expanded_node_count();
+	engine.invalidate(std::span{&gap, 1});
+	check_same_cost(engine.find_path(), search(source, target, domain, costs));
+	assert(engine.expanded_node_count() - expansions_before < initial_expansions);
+
+	// Make the area around the target more expensive
+	auto const swamp = cheapest_route::search_bounds{"(80, 30, 96, 70)"};
+	costs.fill(swamp, 3.0f);
+	engine.invalidate(std::span{&swamp, 1});
+	check_same_cost(engine.find_path(), search(source, target, domain, costs));
+}
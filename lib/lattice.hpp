@@ -0,0 +1,441 @@
+#ifndef CHEAPESTROUTE_LATTICE_HPP
+#define CHEAPESTROUTE_LATTICE_HPP
+
+#include "./search.hpp"
+#include "./edge_weights.hpp"
+#include "./arc_flags.hpp"
+#include "./passability.hpp"
+#include "./uniform_blocks.hpp"
+#include "./memory_layout.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Shared by the different search engines. The search runs on a lattice that is scale times finer
+// than the pixel grid, and each lattice node is connected to 32 neighbours.
+namespace cheapest_route::lattice_detail
+{
+	constexpr auto scale = 4.0;
+	constexpr auto scale_int = static_cast<int64_t>(scale);
+
+	constexpr auto gen_neigbour_offset_table()
+	{
+		std::array<to<int64_t>, 32> ret{};
+		constexpr auto r = scale;
+		for(size_t k = 0; k != std::size(ret); ++k)
+		{
+			auto const theta = k*2.0*std::numbers::pi/std::size(ret);
+			auto const v = to<double>{std::round(r*std::cos(theta)), std::round(r*std::sin(theta))};
+			ret[k] = to<int64_t>{v};
+		}
+		return ret;
+	}
+
+	constexpr auto neigbour_offsets = gen_neigbour_offset_table();
+
+	constexpr auto max_offset = scale_int;
+
+	constexpr auto gen_direction_table()
+	{
+		std::array<uint8_t, (2*max_offset + 1)*(2*max_offset + 1)> ret{};
+		std::ranges::fill(ret, static_cast<uint8_t>(0xff));
+		for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+		{
+			auto const offset = neigbour_offsets[k];
+			ret[(offset[1] + max_offset)*(2*max_offset + 1) + offset[0] + max_offset] = static_cast<uint8_t>(k);
+		}
+		return ret;
+	}
+
+	constexpr auto direction_table = gen_direction_table();
+
+	// Maps an offset in neigbour_offsets back to its index
+	constexpr uint8_t get_direction(vec<int64_t, 2> offset)
+	{ return direction_table[(offset[1] + max_offset)*(2*max_offset + 1) + offset[0] + max_offset]; }
+
+	using lattice_rectangle = rectangle<int64_t,
+		boundary_type::inclusive,
+		boundary_type::exclusive,
+		boundary_type::inclusive,
+		boundary_type::exclusive>;
+
+	inline auto make_lattice_rectangle(search_bounds const& bounds)
+	{
+		return lattice_rectangle{
+			make_interval<boundary_type::inclusive,
+				boundary_type::exclusive>(scale_int*bounds.horz_interval.min,
+				scale_int*(bounds.horz_interval.max - 1) + 1),
+			make_interval<boundary_type::inclusive,
+				boundary_type::exclusive>(scale_int*bounds.vert_interval.min,
+				scale_int*(bounds.vert_interval.max - 1) + 1)
+		};
+	}
+
+	template<auto tag>
+	size_t node_index(vec<int64_t, 2, tag> loc, lattice_rectangle const& rect)
+	{
+		auto const x = loc[0] - rect.horz_interval.min;
+		auto const y = loc[1] - rect.vert_interval.min;
+		return grid_index(static_cast<uint64_t>(x), static_cast<uint64_t>(y), static_cast<uint64_t>(rect.width()));
+	}
+
+	template<class T, auto tag>
+	T& get_item(T* ptr, vec<int64_t, 2, tag> loc, lattice_rectangle const& rect)
+	{ return *(ptr + node_index(loc, rect)); }
+
+	inline size_t node_count(lattice_rectangle const& rect)
+	{ return grid_storage_size(static_cast<uint64_t>(rect.width()), static_cast<uint64_t>(rect.height())); }
+
+	inline double get_edge_weight(edge_weights_view const& edge_weights,
+		lattice_rectangle const& lattice,
+		vec<int64_t, 2> loc,
+		size_t direction)
+	{
+		if(direction < stored_directions)
+		{ return get_item(std::data(edge_weights.weights), loc, lattice)[direction]; }
+
+		auto const other = loc + vec<int64_t, 2>{neigbour_offsets[direction]};
+		return get_item(std::data(edge_weights.weights), other, lattice)[direction - stored_directions];
+	}
+
+	// Lattice nodes belong to the nearest pixel
+	inline bool is_passable(passability_view const& passability, vec<int64_t, 2> loc)
+	{ return passability.passable((loc[0] + scale_int/2)/scale_int, (loc[1] + scale_int/2)/scale_int); }
+
+	// The arc flag region of the pixel nearest to loc
+	inline size_t arc_flag_region(arc_flags_view const& arc_flags, vec<int64_t, 2> loc)
+	{
+		auto const x = (loc[0] + scale_int/2)/scale_int/arc_flags.region_size;
+		auto const y = (loc[1] + scale_int/2)/scale_int/arc_flags.region_size;
+		return static_cast<size_t>(y*arc_flag_regions_x(arc_flags.domain, arc_flags.region_size) + x);
+	}
+
+	inline size_t arc_flag_index(arc_flags_view const& arc_flags,
+		lattice_rectangle const& lattice,
+		vec<int64_t, 2> loc,
+		size_t direction,
+		size_t region)
+	{
+		auto const region_count = arc_flag_region_count(arc_flags.domain, arc_flags.region_size);
+		return (node_index(loc, lattice)*std::size(neigbour_offsets) + direction)*region_count + region;
+	}
+
+	constexpr uint32_t all_directions = 0xffff'ffff;
+
+	// Returns the region of the target node
+	inline size_t check_arc_flags(arc_flags_view const& arc_flags,
+		search_domain const& domain,
+		search_options const& options,
+		vec<int64_t, 2> target)
+	{
+		if(options.bounds.has_value() || options.uniform_blocks != nullptr)
+		{ throw std::runtime_error{"Arc flags cannot be combined with search bounds or uniform blocks"}; }
+
+		if(arc_flags.domain.width() != domain.width() || arc_flags.domain.height() != domain.height()
+			|| arc_flags.region_size < 1
+			|| std::size(arc_flags.bits) != arc_flag_word_count(domain, arc_flags.region_size))
+		{ throw std::runtime_error{"Arc flags do not match the search domain"}; }
+
+		return arc_flag_region(arc_flags, target);
+	}
+
+	// The directions from loc that are flagged for region, one bit per direction. lattice must
+	// cover the domain of arc_flags.
+	inline uint32_t flagged_directions(arc_flags_view const& arc_flags,
+		lattice_rectangle const& lattice,
+		vec<int64_t, 2> loc,
+		size_t region)
+	{
+		uint32_t ret = 0;
+		for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+		{
+			auto const index = arc_flag_index(arc_flags, lattice, loc, k, region);
+			ret |= static_cast<uint32_t>((arc_flags.bits[index/64] >> (index%64)) & 1) << k;
+		}
+		return ret;
+	}
+
+	inline auto clamp_bounds(search_domain const& domain,
+		std::optional<search_bounds> const& bounds)
+	{
+		auto const dom_rect = search_bounds{domain, origin_at_zero{}};
+		if(!bounds.has_value())
+		{ return dom_rect; }
+
+		auto ret = *bounds;
+		ret.horz_interval.min = std::max(ret.horz_interval.min, dom_rect.horz_interval.min);
+		ret.horz_interval.max = std::min(ret.horz_interval.max, dom_rect.horz_interval.max);
+		ret.vert_interval.min = std::max(ret.vert_interval.min, dom_rect.vert_interval.min);
+		ret.vert_interval.max = std::min(ret.vert_interval.max, dom_rect.vert_interval.max);
+		return ret;
+	}
+
+	// Looks up edge costs either from precompiled edge weights, or by calling the cost function.
+	// Edges into blocked pixels are rejected before either of them is consulted.
+	struct edge_cost
+	{
+		void const* callback_data;
+		cost_function_ptr cost_function;
+		edge_weights_view const* edge_weights;
+		passability_view const* passability;
+		lattice_rectangle weights_lattice;
+		batch_cost_function const* batch_cost;
+
+		double operator()(vec<int64_t, 2> loc, size_t direction) const
+		{
+			if(passability != nullptr
+				&& !is_passable(*passability, loc + vec<int64_t, 2>{neigbour_offsets[direction]}))
+			{ return std::numeric_limits<double>::infinity(); }
+
+			if(edge_weights != nullptr)
+			{ return get_edge_weight(*edge_weights, weights_lattice, loc, direction); }
+
+			return cost_function(callback_data,
+				scale_to_float(scale, from<int64_t>{loc}),
+				scale_to_float(scale, to<int64_t>{loc} + neigbour_offsets[direction]));
+		}
+
+		// Computes the cost of the edges from loc in directions, which has one bit per direction.
+		// Other edges, and edges that leave lattice, get an infinite cost.
+		void operator()(vec<int64_t, 2> loc,
+			lattice_rectangle const& lattice,
+			uint32_t directions,
+			std::span<double, std::size(neigbour_offsets)> costs) const
+		{
+			if(batch_cost == nullptr || edge_weights != nullptr)
+			{
+				for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+				{
+					auto const skip = !((directions >> k) & 1)
+						|| outside(loc + vec<int64_t, 2>{neigbour_offsets[k]}, lattice);
+					costs[k] = skip ? std::numeric_limits<double>::infinity() : (*this)(loc, k);
+				}
+				return;
+			}
+
+			std::array<to<double>, std::size(neigbour_offsets)> targets;
+			std::array<size_t, std::size(neigbour_offsets)> target_directions;
+			size_t count = 0;
+			for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+			{
+				auto const next_loc = loc + vec<int64_t, 2>{neigbour_offsets[k]};
+				costs[k] = std::numeric_limits<double>::infinity();
+				if(!((directions >> k) & 1) || outside(next_loc, lattice)
+					|| (passability != nullptr && !is_passable(*passability, next_loc)))
+				{ continue; }
+
+				targets[count] = scale_to_float(scale, to<int64_t>{loc} + neigbour_offsets[k]);
+				target_directions[count] = k;
+				++count;
+			}
+
+			std::array<double, std::size(neigbour_offsets)> batch;
+			batch_cost->evaluate(batch_cost->callback_data,
+				scale_to_float(scale, from<int64_t>{loc}),
+				std::span{std::data(targets), count},
+				std::span{std::data(batch), count});
+			for(size_t k = 0; k != count; ++k)
+			{ costs[target_directions[k]] = batch[k]; }
+		}
+	};
+
+	inline auto make_edge_cost(search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options)
+	{
+		auto const weights_lattice = make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+		if(options.edge_weights != nullptr)
+		{
+			auto const& weights_domain = options.edge_weights->domain;
+			if(weights_domain.width() != domain.width() || weights_domain.height() != domain.height()
+				|| std::size(options.edge_weights->weights) != node_count(weights_lattice))
+			{ throw std::runtime_error{"Edge weights do not match the search domain"}; }
+		}
+
+		if(options.passability != nullptr)
+		{
+			auto const& mask_domain = options.passability->domain;
+			if(mask_domain.width() != domain.width() || mask_domain.height() != domain.height()
+				|| std::size(options.passability->bits) != passability_word_count(domain))
+			{ throw std::runtime_error{"Passability mask does not match the search domain"}; }
+		}
+		return edge_cost{callback_data,
+			cost_function,
+			options.edge_weights,
+			options.passability,
+			weights_lattice,
+			options.batch_cost};
+	}
+
+	inline bool is_isolated(to<int64_t> loc,
+		lattice_rectangle const& lattice,
+		edge_cost const& cost)
+	{
+		auto const n = std::size(neigbour_offsets);
+		for(size_t k = 0; k != n; ++k)
+		{
+			auto const other_loc = loc + neigbour_offsets[k];
+			if(outside(vec<int64_t, 2>(other_loc), lattice))
+			{ continue; }
+
+			// Use the opposite direction, so the edge goes from other_loc into loc
+			if(cost(vec<int64_t, 2>(other_loc), (k + n/2)%n) != std::numeric_limits<double>::infinity())
+			{ return false; }
+		}
+		return true;
+	}
+
+	// Tells which lattice nodes a search may jump over. These are the nodes strictly inside uniform
+	// blocks, except for the blocks that contain the source or the target.
+	struct jump_regions
+	{
+		uniform_block_view const* blocks;
+		int64_t block_span;
+		vec<int64_t, 2> source_block;
+		vec<int64_t, 2> target_block;
+
+		// Returns the index of the uniform block that loc is inside, or -1 if loc must be settled
+		int64_t interior_block(vec<int64_t, 2> loc) const
+		{
+			if(blocks == nullptr || loc[0]%block_span == 0 || loc[1]%block_span == 0)
+			{ return -1; }
+
+			auto const block_x = loc[0]/block_span;
+			auto const block_y = loc[1]/block_span;
+			if((block_x == source_block[0] && block_y == source_block[1])
+				|| (block_x == target_block[0] && block_y == target_block[1])
+				|| !blocks->uniform(block_x, block_y))
+			{ return -1; }
+
+			return block_y*blocks->columns() + block_x;
+		}
+
+		// The number of steps from loc that stay strictly inside the block that loc is inside
+		int64_t steps_inside_block(vec<int64_t, 2> loc, vec<int64_t, 2> step) const
+		{
+			auto ret = std::numeric_limits<int64_t>::max();
+			for(size_t axis = 0; axis != 2; ++axis)
+			{
+				auto const block_min = (loc[axis]/block_span)*block_span;
+				if(step[axis] > 0)
+				{ ret = std::min(ret, (block_min + block_span - 1 - loc[axis])/step[axis]); }
+				else
+				if(step[axis] < 0)
+				{ ret = std::min(ret, (loc[axis] - block_min - 1)/(-step[axis])); }
+			}
+			return ret;
+		}
+	};
+
+	// The number of steps from loc that stay inside lattice
+	inline int64_t steps_inside(lattice_rectangle const& lattice, vec<int64_t, 2> loc, vec<int64_t, 2> step)
+	{
+		auto ret = std::numeric_limits<int64_t>::max();
+		auto const limit = [&ret](int64_t min, int64_t max, int64_t pos, int64_t step) {
+			if(step > 0)
+			{ ret = std::min(ret, (max - 1 - pos)/step); }
+			else
+			if(step < 0)
+			{ ret = std::min(ret, (pos - min)/(-step)); }
+		};
+		limit(lattice.horz_interval.min, lattice.horz_interval.max, loc[0], step[0]);
+		limit(lattice.vert_interval.min, lattice.vert_interval.max, loc[1], step[1]);
+		return ret;
+	}
+
+	inline jump_regions make_jump_regions(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		search_options const& options)
+	{
+		auto const blocks = options.uniform_blocks;
+		if(blocks == nullptr)
+		{ return jump_regions{nullptr, 1, vec<int64_t, 2>{}, vec<int64_t, 2>{}}; }
+
+		if(blocks->domain.width() != domain.width() || blocks->domain.height() != domain.height()
+			|| blocks->block_size < 1
+			|| std::size(blocks->bits) != uniform_block_word_count(domain, blocks->block_size))
+		{ throw std::runtime_error{"Uniform blocks do not match the search domain"}; }
+
+		return jump_regions{
+			blocks,
+			scale_int*blocks->block_size,
+			vec<int64_t, 2>{source[0]/blocks->block_size, source[1]/blocks->block_size},
+			vec<int64_t, 2>{target[0]/blocks->block_size, target[1]/blocks->block_size}
+		};
+	}
+
+	// Splits offset into a number of steps along one of neigbour_offsets. Returns the direction and
+	// the number of steps. The number of steps is zero if offset is not a straight line.
+	constexpr std::pair<uint8_t, int64_t> split_straight_line(vec<int64_t, 2> offset)
+	{
+		for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
+		{
+			auto const step = neigbour_offsets[k];
+			auto const count = step[0] != 0 ? offset[0]/step[0] : offset[1]/step[1];
+			if(count > 0 && count*step[0] == offset[0] && count*step[1] == offset[1])
+			{ return std::pair{static_cast<uint8_t>(k), count}; }
+		}
+		return std::pair{static_cast<uint8_t>(0xff), int64_t{0}};
+	}
+
+	[[noreturn]] inline void throw_not_reached(to<int64_t> target, double max_cost)
+	{
+		std::string msg{"Target "};
+		msg.append(to_string(target)).append(" not reached");
+		if(max_cost != std::numeric_limits<double>::infinity())
+		{ msg.append(" within a cost of ").append(std::to_string(max_cost)); }
+		throw std::runtime_error{std::move(msg)};
+	}
+
+	// Validates a query, and returns the part of the lattice to search
+	inline lattice_rectangle make_search_lattice(from<int64_t> source,
+		std::optional<to<int64_t>> target,
+		search_domain const& domain,
+		search_options const& options)
+	{
+		if(domain.width() < 1 || domain.height() < 1)
+		{ throw std::runtime_error{"Empty search domain"}; }
+
+		if(outside(vec<int64_t, 2>{source}, domain))
+		{ throw std::runtime_error{"Source location is outside search domain"}; }
+
+		if(target.has_value() && outside(vec<int64_t, 2>{*target}, domain))
+		{ throw std::runtime_error{"Target location is outside search domain"}; }
+
+		auto const bounds = clamp_bounds(domain, options.bounds);
+		if(bounds.width() < 1 || bounds.height() < 1)
+		{ throw std::runtime_error{"Search bounds do not overlap the search domain"}; }
+
+		if(outside(vec<int64_t, 2>{source}, bounds))
+		{ throw std::runtime_error{"Source location is outside search bounds"}; }
+
+		if(target.has_value() && outside(vec<int64_t, 2>{*target}, bounds))
+		{ throw std::runtime_error{"Target location is outside search bounds"}; }
+
+		if(options.max_cost < 0.0)
+		{ throw std::runtime_error{"Max cost must be non-negative"}; }
+
+		if(options.passability != nullptr)
+		{
+			if(!is_passable(*options.passability, scale_int*vec<int64_t, 2>{source}))
+			{ throw std::runtime_error{"Source location is not passable"}; }
+
+			if(target.has_value() && !is_passable(*options.passability, scale_int*vec<int64_t, 2>{*target}))
+			{ throw std::runtime_error{"Target location is not passable"}; }
+		}
+
+		return make_lattice_rectangle(bounds);
+	}
+}
+
+#endif
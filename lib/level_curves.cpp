@@ -0,0 +1,211 @@
+//@	{"target":{"name":"level_curves.o"}}
+
+#include "./level_curves.hpp"
+
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	enum class cell_edge:int{top, right, bottom, left};
+
+	struct segment
+	{
+		uint64_t from;
+		uint64_t to;
+	};
+
+	struct edge_segments
+	{
+		std::array<size_t, 2> items{
+			std::numeric_limits<size_t>::max(),
+			std::numeric_limits<size_t>::max()
+		};
+
+		void add(size_t k)
+		{ items[items[0] == std::numeric_limits<size_t>::max() ? 0 : 1] = k; }
+	};
+
+	// Segments within a cell, indexed by which corners that are inside. Corners are counted
+	// clock-wise, starting at the top left corner.
+	constexpr std::array<std::array<std::pair<cell_edge, cell_edge>, 2>, 16> segment_table{{
+		{},
+		{{{cell_edge::left, cell_edge::top}}},
+		{{{cell_edge::top, cell_edge::right}}},
+		{{{cell_edge::left, cell_edge::right}}},
+		{{{cell_edge::right, cell_edge::bottom}}},
+		{{{cell_edge::left, cell_edge::top}, {cell_edge::right, cell_edge::bottom}}},
+		{{{cell_edge::top, cell_edge::bottom}}},
+		{{{cell_edge::left, cell_edge::bottom}}},
+		{{{cell_edge::bottom, cell_edge::left}}},
+		{{{cell_edge::top, cell_edge::bottom}}},
+		{{{cell_edge::top, cell_edge::right}, {cell_edge::bottom, cell_edge::left}}},
+		{{{cell_edge::right, cell_edge::bottom}}},
+		{{{cell_edge::left, cell_edge::right}}},
+		{{{cell_edge::top, cell_edge::right}}},
+		{{{cell_edge::left, cell_edge::top}}},
+		{}
+	}};
+
+	constexpr std::array<size_t, 16> segment_count{0, 1, 1, 1, 1, 2, 1, 1, 1, 1, 2, 1, 1, 1, 1, 0};
+
+	class sample_grid
+	{
+	public:
+		explicit sample_grid(std::span<float const> values,
+			cheapest_route::search_domain const& domain,
+			float level):
+			m_values{values},
+			m_w{domain.width()},
+			m_h{domain.height()},
+			m_level{level}
+		{}
+
+		float operator()(int64_t x, int64_t y) const
+		{
+			if(x < 0 || y < 0 || x >= m_w || y >= m_h)
+			{ return std::numeric_limits<float>::infinity(); }
+			return m_values[y*m_w + x];
+		}
+
+		bool inside(int64_t x, int64_t y) const
+		{ return (*this)(x, y) <= m_level; }
+
+		// Edges are identified by the sample to the left of, or above the edge
+		uint64_t edge_key(int64_t x, int64_t y, bool vertical) const
+		{ return 2*static_cast<uint64_t>((y + 1)*(m_w + 2) + (x + 1)) + (vertical ? 1 : 0); }
+
+		uint64_t edge_key(int64_t x, int64_t y, cell_edge edge) const
+		{
+			switch(edge)
+			{
+				case cell_edge::top:
+					return edge_key(x, y, false);
+				case cell_edge::right:
+					return edge_key(x + 1, y, true);
+				case cell_edge::bottom:
+					return edge_key(x, y + 1, false);
+				case cell_edge::left:
+					return edge_key(x, y, true);
+			}
+			__builtin_unreachable();
+		}
+
+		cheapest_route::vec<double, 2, cheapest_route::quantity_type::point> crossing(uint64_t key) const
+		{
+			auto const vertical = (key & 1) != 0;
+			auto const index = static_cast<int64_t>(key/2);
+			auto const x0 = index%(m_w + 2) - 1;
+			auto const y0 = index/(m_w + 2) - 1;
+			auto const x1 = vertical ? x0 : x0 + 1;
+			auto const y1 = vertical ? y0 + 1 : y0;
+
+			auto const inside_first = inside(x0, y0);
+			auto const v_in = inside_first ? (*this)(x0, y0) : (*this)(x1, y1);
+			auto const v_out = inside_first ? (*this)(x1, y1) : (*this)(x0, y0);
+			auto const t_from_inside = (v_out == std::numeric_limits<float>::infinity()) ?
+				0.5 : std::clamp(static_cast<double>(m_level - v_in)/static_cast<double>(v_out - v_in), 0.0, 1.0);
+			auto const t = inside_first ? t_from_inside : 1.0 - t_from_inside;
+
+			auto const x = static_cast<double>(x0) + t*static_cast<double>(x1 - x0);
+			auto const y = static_cast<double>(y0) + t*static_cast<double>(y1 - y0);
+			return cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{
+				std::clamp(x, 0.0, static_cast<double>(m_w - 1)),
+				std::clamp(y, 0.0, static_cast<double>(m_h - 1))
+			};
+		}
+
+	private:
+		std::span<float const> m_values;
+		int64_t m_w;
+		int64_t m_h;
+		float m_level;
+	};
+}
+
+std::vector<cheapest_route::path> cheapest_route::trace_level_curves(std::span<float const> values,
+	search_domain const& domain,
+	float level)
+{
+	if(std::size(values) != static_cast<size_t>(domain.width()*domain.height()))
+	{ throw std::runtime_error{"The number of samples does not match the domain size"}; }
+
+	sample_grid const grid{values, domain, level};
+
+	std::vector<segment> segments;
+	std::unordered_map<uint64_t, edge_segments> segments_by_edge;
+	for(int64_t y = -1; y < domain.height(); ++y)
+	{
+		for(int64_t x = -1; x < domain.width(); ++x)
+		{
+			auto const cell_case = (grid.inside(x, y) ? 1 : 0)
+				| (grid.inside(x + 1, y) ? 2 : 0)
+				| (grid.inside(x + 1, y + 1) ? 4 : 0)
+				| (grid.inside(x, y + 1) ? 8 : 0);
+
+			for(size_t k = 0; k != segment_count[cell_case]; ++k)
+			{
+				auto const edges = segment_table[cell_case][k];
+				auto const seg = segment{grid.edge_key(x, y, edges.first), grid.edge_key(x, y, edges.second)};
+				segments_by_edge[seg.from].add(std::size(segments));
+				segments_by_edge[seg.to].add(std::size(segments));
+				segments.push_back(seg);
+			}
+		}
+	}
+
+	std::vector<bool> used(std::size(segments));
+	auto const next_segment = [&segments_by_edge, &used](uint64_t edge) {
+		for(auto k : segments_by_edge[edge].items)
+		{
+			if(k != std::numeric_limits<size_t>::max() && !used[k])
+			{ return k; }
+		}
+		return std::numeric_limits<size_t>::max();
+	};
+
+	std::vector<path> ret;
+	for(size_t k = 0; k != std::size(segments); ++k)
+	{
+		if(used[k])
+		{ continue; }
+
+		used[k] = true;
+		std::deque<uint64_t> chain{segments[k].from, segments[k].to};
+		while(true)
+		{
+			auto const i = next_segment(chain.back());
+			if(i == std::numeric_limits<size_t>::max())
+			{ break; }
+			used[i] = true;
+			chain.push_back(segments[i].from == chain.back() ? segments[i].to : segments[i].from);
+		}
+
+		while(true)
+		{
+			auto const i = next_segment(chain.front());
+			if(i == std::numeric_limits<size_t>::max())
+			{ break; }
+			used[i] = true;
+			chain.push_front(segments[i].from == chain.front() ? segments[i].to : segments[i].from);
+		}
+
+		path curve;
+		curve.reserve(std::size(chain));
+		std::ranges::transform(chain, std::back_inserter(curve), [&grid, level](auto key) {
+			return visited_node{grid.crossing(key), static_cast<double>(level)};
+		});
+
+		// Clamping at the domain boundary may produce repeated nodes
+		curve.erase(std::unique(std::begin(curve), std::end(curve), [](auto const& a, auto const& b) {
+			return a.loc[0] == b.loc[0] && a.loc[1] == b.loc[1];
+		}), std::end(curve));
+		ret.push_back(std::move(curve));
+	}
+
+	return ret;
+}
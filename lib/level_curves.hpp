@@ -0,0 +1,21 @@
+//@	{"dependencies_extra":[{"ref":"./level_curves.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_LEVELCURVES_HPP
+#define CHEAPESTROUTE_LEVELCURVES_HPP
+
+#include "./search.hpp"
+
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	// Traces the curves that separates samples with a value less than or equal to level, from
+	// other samples, using marching squares. Samples outside the domain counts as outside, so all
+	// curves are closed. The integrated_cost of each node is set to level.
+	std::vector<path> trace_level_curves(std::span<float const> values,
+		search_domain const& domain,
+		float level);
+}
+
+#endif
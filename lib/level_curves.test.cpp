@@ -0,0 +1,48 @@
+//@	{"target":{"name":"level_curves.test"}}
+
+#include "./level_curves.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+int main()
+{
+	int64_t const size = 64;
+	auto const domain = cheapest_route::search_domain{size, size};
+	std::vector<float> values(size*size);
+	for(int64_t y = 0; y != size; ++y)
+	{
+		for(int64_t x = 0; x != size; ++x)
+		{
+			auto const dx = static_cast<float>(x - size/2);
+			auto const dy = static_cast<float>(y - size/2);
+			values[y*size + x] = std::sqrt(dx*dx + dy*dy);
+		}
+	}
+
+	// A disc gives one closed curve
+	{
+		auto const curves = cheapest_route::trace_level_curves(values, domain, 20.0f);
+		assert(std::size(curves) == 1);
+		auto const& curve = curves[0];
+		assert(std::size(curve) > 4);
+		assert(curve.front().loc[0] == curve.back().loc[0] && curve.front().loc[1] == curve.back().loc[1]);
+		for(auto const& item : curve)
+		{
+			auto const r = std::sqrt(length_squared(item.loc
+				- cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{size/2.0, size/2.0}));
+			assert(std::abs(r - 20.0) < 0.25);
+			assert(item.integrated_cost == 20.0);
+		}
+	}
+
+	// Two discs separated by unreachable samples gives two curves
+	{
+		for(int64_t y = 0; y != size; ++y)
+		{ values[y*size + size/2] = std::numeric_limits<float>::infinity(); }
+
+		auto const curves = cheapest_route::trace_level_curves(values, domain, 20.0f);
+		assert(std::size(curves) == 2);
+		printf("%zu %zu\n", std::size(curves[0]), std::size(curves[1]));
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef CHEAPESTROUTE_MEMORYLAYOUT_HPP
+#define CHEAPESTROUTE_MEMORYLAYOUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cheapest_route
+{
+	enum class memory_layout:uint32_t{row_major, tiled};
+
+	// Large grids are stored in square tiles by default, so neighbours in adjacent rows are likely
+	// to be on the same cache line and page. Define CHEAPESTROUTE_ROW_MAJOR_LAYOUT to get the
+	// plain row-major layout.
+#ifdef CHEAPESTROUTE_ROW_MAJOR_LAYOUT
+	constexpr auto grid_layout = memory_layout::row_major;
+#else
+	constexpr auto grid_layout = memory_layout::tiled;
+#endif
+
+	constexpr uint64_t tile_size = 16;
+
+	constexpr uint64_t tile_count(uint64_t n)
+	{ return (n + tile_size - 1)/tile_size; }
+
+	// The number of elements needed to store a w x h grid. Tiles on the right and bottom edge are
+	// padded to full size.
+	constexpr size_t grid_storage_size(uint64_t w, uint64_t h)
+	{
+		if constexpr(grid_layout == memory_layout::tiled)
+		{ return tile_count(w)*tile_count(h)*tile_size*tile_size; }
+		else
+		{ return w*h; }
+	}
+
+	constexpr size_t grid_index(uint64_t x, uint64_t y, uint64_t w)
+	{
+		if constexpr(grid_layout == memory_layout::tiled)
+		{
+			auto const tile = (y/tile_size)*tile_count(w) + x/tile_size;
+			return tile*tile_size*tile_size + (y%tile_size)*tile_size + x%tile_size;
+		}
+		else
+		{ return y*w + x; }
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef CHEAPESTROUTE_PASSABILITY_HPP
+#define CHEAPESTROUTE_PASSABILITY_HPP
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace cheapest_route
+{
+	// One bit per pixel, stored row by row. A set bit marks a pixel that can be entered.
+	struct passability_view
+	{
+		search_domain domain;
+		std::span<uint64_t const> bits;
+
+		bool passable(int64_t x, int64_t y) const
+		{
+			auto const index = static_cast<uint64_t>(y*domain.width() + x);
+			return (bits[index/64] >> (index%64)) & 1;
+		}
+	};
+
+	constexpr size_t passability_word_count(search_domain const& domain)
+	{ return (static_cast<size_t>(domain.width()*domain.height()) + 63)/64; }
+
+	class passability_mask
+	{
+	public:
+		// All pixels are passable initially
+		explicit passability_mask(search_domain const& domain):
+			m_domain{domain},
+			m_word_count{passability_word_count(domain)},
+			m_bits{std::make_unique_for_overwrite<uint64_t[]>(m_word_count)}
+		{ std::fill_n(m_bits.get(), m_word_count, ~uint64_t{0}); }
+
+		passability_view view() const
+		{ return passability_view{m_domain, std::span{m_bits.get(), m_word_count}}; }
+
+		void set_passable(int64_t x, int64_t y, bool value)
+		{
+			auto const index = static_cast<uint64_t>(y*m_domain.width() + x);
+			auto const bit = uint64_t{1} << (index%64);
+			m_bits[index/64] = value ? (m_bits[index/64] | bit) : (m_bits[index/64] & ~bit);
+		}
+
+	private:
+		search_domain m_domain;
+		size_t m_word_count;
+		std::unique_ptr<uint64_t[]> m_bits;
+	};
+
+	// Builds a mask where the pixels for which is_passable(x, y) returns false are blocked
+	template<class Predicate>
+	passability_mask make_passability_mask(search_domain const& domain, Predicate&& is_passable)
+	{
+		passability_mask ret{domain};
+		for(int64_t y = 0; y != domain.height(); ++y)
+		{
+			for(int64_t x = 0; x != domain.width(); ++x)
+			{
+				if(!is_passable(x, y))
+				{ ret.set_passable(x, y, false); }
+			}
+		}
+		return ret;
+	}
+}
+
+#endif
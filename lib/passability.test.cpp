@@ -0,0 +1,79 @@
+//@	{"target":{"name":"passability.test"}}
+
+#include "./passability.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+
+	// A wall with a gap near the bottom
+	auto const is_passable = [](int64_t x, int64_t y) {
+		return !(x >= 70 && x < 75 && y < 100);
+	};
+
+	auto const mask = make_passability_mask(domain, is_passable);
+	auto const mask_view = mask.view();
+
+	auto const g = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	size_t call_count = 0;
+	auto const f = [&call_count, g](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		++call_count;
+		return g(x0, x1);
+	};
+
+	// The same obstacle, expressed by the cost function
+	auto const f_blocked = [&call_count, g, is_passable](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		++call_count;
+		if(!is_passable(std::lround(x1[0]), std::lround(x1[1])))
+		{ return std::numeric_limits<double>::infinity(); }
+		return g(x0, x1);
+	};
+
+	auto const source = cheapest_route::from<int64_t>{10, 20};
+	auto const target = cheapest_route::to<int64_t>{150, 30};
+
+	auto const reference = search(source, target, domain, f_blocked);
+	auto const calls_without_mask = call_count;
+
+	call_count = 0;
+	auto options = cheapest_route::search_options{};
+	options.passability = &mask_view;
+	auto const masked = search(source, target, domain, f, options);
+	auto const calls_with_mask = call_count;
+
+	printf("%zu %.8g %zu %zu\n", std::size(masked), masked.back().integrated_cost,
+		calls_without_mask, calls_with_mask);
+	assert(std::size(masked) == std::size(reference));
+	assert(masked.back().integrated_cost == reference.back().integrated_cost);
+	assert(calls_with_mask < calls_without_mask);
+	for(auto const& item : masked)
+	{ assert(is_passable(std::lround(item.loc[0]), std::lround(item.loc[1]))); }
+
+	try
+	{
+		search(cheapest_route::from<int64_t>{72, 20}, target, domain, f, options);
+		assert(false);
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+
+	auto const other_mask = cheapest_route::passability_mask{cheapest_route::search_domain{16, 12}};
+	auto const other_view = other_mask.view();
+	options.passability = &other_view;
+	try
+	{
+		search(source, target, domain, f, options);
+		assert(false);
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+}
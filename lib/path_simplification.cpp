@@ -0,0 +1,74 @@
+//@	{"target":{"name":"path_simplification.o"}}
+
+#include "./path_simplification.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	double distance_squared_to_segment(cheapest_route::polyline_point const& p,
+		cheapest_route::polyline_point const& a,
+		cheapest_route::polyline_point const& b)
+	{
+		auto const d_xy = b.xy - a.xy;
+		auto const d_z = b.z - a.z;
+		auto const l2 = length_squared(d_xy) + d_z*d_z;
+		auto const t = l2 > 0.0 ? std::clamp((dot(p.xy - a.xy, d_xy) + (p.z - a.z)*d_z)/l2, 0.0, 1.0) : 0.0;
+		auto const e_xy = p.xy - (a.xy + t*d_xy);
+		auto const e_z = p.z - (a.z + t*d_z);
+		return length_squared(e_xy) + e_z*e_z;
+	}
+}
+
+std::vector<size_t> cheapest_route::simplify_polyline(std::span<polyline_point const> points, double tolerance)
+{
+	auto const n = std::size(points);
+	if(n <= 2)
+	{
+		std::vector<size_t> ret(n);
+		for(size_t k = 0; k != n; ++k)
+		{ ret[k] = k; }
+		return ret;
+	}
+
+	std::vector<char> keep(n);
+	keep.front() = 1;
+	keep.back() = 1;
+
+	// Routes may have millions of points, so use an explicit stack instead of recursion
+	auto const tolerance_squared = tolerance*tolerance;
+	std::vector<std::pair<size_t, size_t>> ranges{{0, n - 1}};
+	while(!ranges.empty())
+	{
+		auto const [first, last] = ranges.back();
+		ranges.pop_back();
+
+		auto max_distance = 0.0;
+		auto max_index = first;
+		for(auto k = first + 1; k < last; ++k)
+		{
+			auto const d = distance_squared_to_segment(points[k], points[first], points[last]);
+			if(d > max_distance)
+			{
+				max_distance = d;
+				max_index = k;
+			}
+		}
+
+		if(max_distance > tolerance_squared)
+		{
+			keep[max_index] = 1;
+			ranges.push_back({first, max_index});
+			ranges.push_back({max_index, last});
+		}
+	}
+
+	std::vector<size_t> ret;
+	for(size_t k = 0; k != n; ++k)
+	{
+		if(keep[k])
+		{ ret.push_back(k); }
+	}
+	return ret;
+}
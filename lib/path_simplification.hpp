@@ -0,0 +1,25 @@
+//@	{"dependencies_extra":[{"ref":"./path_simplification.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_PATHSIMPLIFICATION_HPP
+#define CHEAPESTROUTE_PATHSIMPLIFICATION_HPP
+
+#include "./vec.hpp"
+
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	struct polyline_point
+	{
+		vec<double, 2> xy;
+		double z;
+	};
+
+	// Selects the points to keep from a polyline, using Douglas-Peucker, so that no removed point
+	// lies farther than tolerance from the segment between the kept points around it. The first and
+	// the last point are always kept. Returns the indices of the kept points, in increasing order.
+	std::vector<size_t> simplify_polyline(std::span<polyline_point const> points, double tolerance);
+}
+
+#endif
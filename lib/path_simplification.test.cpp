@@ -0,0 +1,82 @@
+//@	{"target":{"name":"path_simplification.test"}}
+
+#include "./path_simplification.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	cheapest_route::polyline_point make_point(double x, double y, double z)
+	{ return cheapest_route::polyline_point{cheapest_route::vec<double, 2>{x, y}, z}; }
+
+	double distance_to_segment(cheapest_route::polyline_point const& p,
+		cheapest_route::polyline_point const& a,
+		cheapest_route::polyline_point const& b)
+	{
+		auto const d_xy = b.xy - a.xy;
+		auto const d_z = b.z - a.z;
+		auto const t = std::clamp((dot(p.xy - a.xy, d_xy) + (p.z - a.z)*d_z)/(length_squared(d_xy) + d_z*d_z), 0.0, 1.0);
+		auto const e_xy = p.xy - (a.xy + t*d_xy);
+		auto const e_z = p.z - (a.z + t*d_z);
+		return std::sqrt(length_squared(e_xy) + e_z*e_z);
+	}
+}
+
+int main()
+{
+	// Collinear points collapse to the end points
+	{
+		std::vector<cheapest_route::polyline_point> points;
+		for(int k = 0; k != 100; ++k)
+		{ points.push_back(make_point(0.25*k, 0.5*k, 0.125*k)); }
+		auto const kept = cheapest_route::simplify_polyline(points, 1.0e-9);
+		assert((kept == std::vector<size_t>{0, 99}));
+	}
+
+	// A corner is kept, also when it is only in z
+	{
+		std::vector<cheapest_route::polyline_point> points;
+		for(int k = 0; k != 10; ++k)
+		{ points.push_back(make_point(k, 0.0, 0.0)); }
+		for(int k = 1; k != 10; ++k)
+		{ points.push_back(make_point(9.0 + k, 0.0, k)); }
+		auto const kept = cheapest_route::simplify_polyline(points, 0.1);
+		assert((kept == std::vector<size_t>{0, 9, 18}));
+	}
+
+	// The error is bounded by the tolerance, and a larger tolerance keeps fewer points
+	{
+		std::vector<cheapest_route::polyline_point> points;
+		for(int k = 0; k != 4000; ++k)
+		{
+			auto const t = 0.25*k;
+			points.push_back(make_point(t, 20.0*std::sin(t/40.0), 5.0*std::cos(t/25.0)));
+		}
+
+		auto prev_count = std::size(points) + 1;
+		for(auto const tolerance : {0.01, 0.1, 1.0})
+		{
+			auto const kept = cheapest_route::simplify_polyline(points, tolerance);
+			printf("%.2f %zu\n", tolerance, std::size(kept));
+			assert(kept.front() == 0 && kept.back() == std::size(points) - 1);
+			assert(std::size(kept) < prev_count);
+			prev_count = std::size(kept);
+
+			for(size_t l = 1; l != std::size(kept); ++l)
+			{
+				for(auto k = kept[l - 1] + 1; k != kept[l]; ++k)
+				{ assert(distance_to_segment(points[k], points[kept[l - 1]], points[kept[l]]) <= tolerance); }
+			}
+		}
+	}
+
+	// Short polylines are kept as is
+	{
+		std::vector<cheapest_route::polyline_point> const points{make_point(0.0, 0.0, 0.0), make_point(1.0, 0.0, 0.0)};
+		assert((cheapest_route::simplify_polyline(points, 10.0) == std::vector<size_t>{0, 1}));
+		assert(std::empty(cheapest_route::simplify_polyline(std::span<cheapest_route::polyline_point const>{}, 10.0)));
+	}
+}
@@ -61,6 +61,13 @@ namespace cheapest_route
 			vert_interval{static_cast<T>(0), dim.height()}
 		{}
 
+		explicit rectangle(std::string_view src)
+		{
+			static_value_array<T, 4> values{src};
+			horz_interval = interval<T, left, right>{values[0], values[2]};
+			vert_interval = interval<T, top, bottom>{values[1], values[3]};
+		}
+
 		constexpr auto width() const
 		{ return horz_interval.max - horz_interval.min;}
 
@@ -1,9 +1,13 @@
 //@	{"target":{"name":"search.o"}}
 
 #include "./search.hpp"
+#include "./lattice.hpp"
+#include "./search_tree.hpp"
+#include "./edge_weights.hpp"
+#include "./search_monitor.hpp"
 
 #include <vector>
-#include <queue>
+#include <algorithm>
 #include <cmath>
 #include <numbers>
 #include <array>
@@ -11,9 +15,6 @@
 
 namespace
 {
-	constexpr auto scale = 4.0;
-	constexpr auto scale_int = static_cast<int64_t>(scale);
-
 	struct pending_route_node
 	{
 		cheapest_route::to<int64_t> loc;
@@ -33,92 +34,212 @@ namespace
 		route_node():loc{}, integrated_cost{std::numeric_limits<double>::infinity()}{}
 	};
 
-	constexpr auto gen_neigbour_offset_table()
+	using cheapest_route::lattice_detail::scale;
+	using cheapest_route::lattice_detail::scale_int;
+	using cheapest_route::lattice_detail::neigbour_offsets;
+	using cheapest_route::lattice_detail::lattice_rectangle;
+	using cheapest_route::lattice_detail::make_lattice_rectangle;
+	using cheapest_route::lattice_detail::get_item;
+	using cheapest_route::lattice_detail::make_search_lattice;
+	using cheapest_route::lattice_detail::make_edge_cost;
+	using cheapest_route::lattice_detail::is_isolated;
+	using cheapest_route::lattice_detail::throw_not_reached;
+	using cheapest_route::lattice_detail::jump_regions;
+	using cheapest_route::lattice_detail::make_jump_regions;
+	using cheapest_route::lattice_detail::is_passable;
+	using cheapest_route::lattice_detail::steps_inside;
+	using cheapest_route::lattice_detail::check_arc_flags;
+	using cheapest_route::lattice_detail::flagged_directions;
+	using cheapest_route::lattice_detail::all_directions;
+
+	struct node:public route_node  // Inherit from node to save some space
+	{
+		uint32_t generation{0};
+		bool visited{false};
+	};
+
+	// Nodes stamped with an older generation have not been touched by the current query
+	node& get_current(node& item, uint32_t generation)
 	{
-		std::array<cheapest_route::to<int64_t>, 32> ret{};
-		constexpr auto r = scale;
-		for(size_t k = 0; k != std::size(ret); ++k)
+		if(item.generation != generation)
 		{
-			auto const theta = k*2.0*std::numbers::pi/std::size(ret);
-			auto const v = cheapest_route::to<double>{std::round(r*std::cos(theta)), std::round(r*std::sin(theta))};
-			ret[k] = cheapest_route::to<int64_t>{v};
+			item = node{};
+			item.generation = generation;
 		}
-		return ret;
+		return item;
 	}
 
-	constexpr auto neigbour_offsets = gen_neigbour_offset_table();
+	bool is_visited(node const& item, uint32_t generation)
+	{ return item.generation == generation && item.visited; }
+
+	// Cost fields and search trees need every node to be settled
+	jump_regions const no_jumps{nullptr, 1, cheapest_route::vec<int64_t, 2>{}, cheapest_route::vec<int64_t, 2>{}};
 
-	template<class T, auto tag>
-	T& get_item(T* ptr, cheapest_route::vec<int64_t, 2, tag> loc, size_t width)
+	double lower_bound(cheapest_route::from<int64_t> source,
+		std::optional<cheapest_route::to<int64_t>> target,
+		cheapest_route::search_monitor const& monitor)
 	{
-		auto const x = loc[0];
-		auto const y = loc[1];
-		return *(ptr + y*width + x);
+		if(!target.has_value())
+		{ return 0.0; }
+		return monitor.min_cost_per_length*std::sqrt(length_squared(*target - source));
 	}
 
-	struct node:public route_node  // Inherit from node to save some space
+	void poll(cheapest_route::search_monitor const& monitor, cheapest_route::search_progress const& progress)
 	{
-		bool visited{false};
-	};
+		if(monitor.stop.stop_requested())
+		{ throw cheapest_route::search_cancelled{}; }
+
+		if(monitor.report_progress != nullptr)
+		{ monitor.report_progress(monitor.callback_data, progress); }
+	}
 
 	struct search_result
 	{
-		std::unique_ptr<node[]> cost_table;
+		node const* cost_table;
+		uint32_t const* labels;
+		uint32_t generation;
 		cheapest_route::from<int64_t> termination_point;
-		cheapest_route::search_domain dom_scaled;
+		lattice_rectangle lattice;
 	};
+}
 
-	auto do_search(cheapest_route::from<int64_t> source,
-		cheapest_route::to<int64_t> target,
-		cheapest_route::search_domain const& domain,
-		void const* callback_data,
-		cheapest_route::cost_function_ptr cost_function)
+struct cheapest_route::search_context::buffers
+{
+	std::unique_ptr<node[]> nodes;
+	size_t capacity{0};
+	uint32_t generation{0};
+	std::vector<pending_route_node> queue;
+	std::vector<uint32_t> labels;
+	path route;
+
+	// Prepares the buffers for a query that needs node_count nodes. Memory is only allocated when
+	// the node table must grow, and the table is only cleared when the generation wraps around.
+	node* begin_query(size_t node_count)
 	{
-		if(domain.width() < 1 || domain.height() < 1)
-		{ std::runtime_error{"Empty search domain"}; }
+		if(node_count > capacity)
+		{
+			nodes = std::make_unique<node[]>(node_count);
+			capacity = node_count;
+			generation = 0;
+		}
 
-		if(outside(cheapest_route::vec<int64_t, 2>{source}, domain))
-		{ std::runtime_error{"Source location is outside search domain"}; }
+		if(generation == std::numeric_limits<uint32_t>::max())
+		{
+			std::fill_n(nodes.get(), capacity, node{});
+			generation = 0;
+		}
 
-		if(outside(cheapest_route::vec<int64_t, 2>{target}, domain))
-		{ std::runtime_error{"Target location is outside search domain"}; }
+		++generation;
+		queue.clear();
+		return nodes.get();
+	}
 
-		auto cmp = [](pending_route_node const& a, pending_route_node const& b)
-		{ return is_cheaper(b, a); };
+	// Only the entries of nodes that are touched by the current query are valid
+	uint32_t* begin_labels(size_t node_count)
+	{
+		if(std::size(labels) < node_count)
+		{ labels.resize(node_count); }
+		return std::data(labels);
+	}
+};
+
+cheapest_route::search_context::search_context():m_buffers{std::make_unique<buffers>()}
+{}
 
-		std::priority_queue<pending_route_node, std::vector<pending_route_node>, decltype(cmp)> nodes_to_visit;
-		nodes_to_visit.push(pending_route_node{scale_int*cheapest_route::to<int64_t>{source}, 0.0});
+cheapest_route::search_context::~search_context() = default;
 
-		auto const dom_scaled = scale_int*domain - cheapest_route::vec<int64_t, 2>{scale_int - 1, scale_int - 1};
+cheapest_route::search_context::search_context(search_context&&) noexcept = default;
 
-		auto const w = dom_scaled.width();
-		auto const h = dom_scaled.height();
+cheapest_route::search_context& cheapest_route::search_context::operator=(search_context&&) noexcept = default;
+
+namespace
+{
+	// The search is seeded with every source at zero cost. A source is its own parent.
+	auto do_search(std::span<cheapest_route::from<int64_t> const> sources,
+		std::optional<cheapest_route::to<int64_t>> target,
+		cheapest_route::search_domain const& domain,
+		void const* callback_data,
+		cheapest_route::cost_function_ptr cost_function,
+		cheapest_route::search_options const& options,
+		jump_regions const& jumps,
+		cheapest_route::search_context::buffers& buffers,
+		bool track_labels = false)
+	{
+		auto const source = sources.front();
+		auto const monitor = options.monitor;
+		auto const cost_lower_bound = monitor != nullptr ? lower_bound(source, target, *monitor) : 0.0;
+		size_t settled_count = 0;
+		if(monitor != nullptr)
+		{ poll(*monitor, cheapest_route::search_progress{0.0, cost_lower_bound, settled_count}); }
+
+		auto const lattice = make_search_lattice(source, target, domain, options);
+		for(auto const& item : sources.subspan(1))
+		{ make_search_lattice(item, target, domain, options); }
+
+		auto const cost = make_edge_cost(domain, callback_data, cost_function, options);
+		auto const arc_flags = target.has_value() ? options.arc_flags : nullptr;
+		auto const target_region = arc_flags != nullptr ?
+			check_arc_flags(*arc_flags, domain, options, cheapest_route::vec<int64_t, 2>{scale_int*(*target)}) : size_t{0};
+
+		if(target.has_value() && (source[0] != (*target)[0] || source[1] != (*target)[1])
+			&& is_isolated(scale_int*(*target), lattice, cost))
+		{ throw_not_reached(*target, options.max_cost); }
 
-		auto cost_table = std::make_unique<node[]>(w*h);
+		auto cmp = [](pending_route_node const& a, pending_route_node const& b)
+		{ return is_cheaper(b, a); };
+
+		auto const cost_table = buffers.begin_query(cheapest_route::lattice_detail::node_count(lattice));
+		auto const generation = buffers.generation;
+		auto const labels = track_labels ? buffers.begin_labels(cheapest_route::lattice_detail::node_count(lattice))
+			: nullptr;
+		auto& nodes_to_visit = buffers.queue;
+		for(size_t k = 0; k != std::size(sources); ++k)
+		{
+			auto const loc = scale_int*cheapest_route::to<int64_t>{sources[k]};
+			auto& item = get_current(get_item(cost_table, loc, lattice), generation);
+			item.integrated_cost = 0.0;
+			item.loc = cheapest_route::from<int64_t>{loc.value()};
+			if(labels != nullptr)
+			{ get_item(labels, loc, lattice) = static_cast<uint32_t>(k); }
+			nodes_to_visit.push_back(pending_route_node{loc, 0.0});
+		}
 
 		while(!nodes_to_visit.empty())
 		{
-			auto current = nodes_to_visit.top();
-			nodes_to_visit.pop();
-			auto& cost_item = get_item(cost_table.get(), current.loc, w);
+			std::ranges::pop_heap(nodes_to_visit, cmp);
+			auto const current = nodes_to_visit.back();
+			nodes_to_visit.pop_back();
+			auto& cost_item = get_current(get_item(cost_table, current.loc, lattice), generation);
+			if(cost_item.visited)
+			{ continue; }
 			cost_item.visited = true;
 
+			++settled_count;
+			if(monitor != nullptr && settled_count%cheapest_route::search_monitor::check_interval == 0)
+			{ poll(*monitor, cheapest_route::search_progress{current.integrated_cost, cost_lower_bound, settled_count}); }
+
 			auto const from_loc = cheapest_route::from<int64_t>{current.loc};
 			auto const from_loc_scaled = scale_to_float(scale, from_loc);
 
-			if(length_squared(cheapest_route::to<double>{target} - from_loc_scaled) < 1.0/(scale*scale))
+			if(target.has_value()
+				&& length_squared(cheapest_route::to<double>{*target} - from_loc_scaled) < 1.0/(scale*scale))
 			{
-				return search_result{std::move(cost_table), from_loc, dom_scaled};
+				return search_result{cost_table, labels, generation, from_loc, lattice};
 			}
 
-			for(auto item : neigbour_offsets)
+			auto const directions = arc_flags != nullptr ?
+				flagged_directions(*arc_flags, cost.weights_lattice, cheapest_route::vec<int64_t, 2>(current.loc),
+					target_region)
+				: all_directions;
+			std::array<double, std::size(neigbour_offsets)> edge_costs;
+			cost(cheapest_route::vec<int64_t, 2>(current.loc), lattice, directions, edge_costs);
+			for(size_t k = 0; k != std::size(neigbour_offsets); ++k)
 			{
- 				auto const next_loc = current.loc + item;
-				if(outside(cheapest_route::vec<int64_t, 2>(next_loc), dom_scaled))
+ 				auto const next_loc = current.loc + neigbour_offsets[k];
+				if(outside(cheapest_route::vec<int64_t, 2>(next_loc), lattice))
 				{ continue; }
 
-				auto const next_scaled = scale_to_float(scale, next_loc);
-				auto const cost_increment = cost_function(callback_data, from_loc_scaled, next_scaled);
+				auto const cost_increment = edge_costs[k];
 
 				if(cost_increment < 0.0)
 				{ throw std::runtime_error{"Cost function must be positive"}; }
@@ -126,59 +247,256 @@ namespace
 				if(cost_increment == std::numeric_limits<double>::infinity())
 				{ continue; }
 
-				auto& new_cost_item = get_item(cost_table.get(), next_loc, w);
+				auto end_loc = cheapest_route::vec<int64_t, 2>{next_loc};
+				auto new_cost = current.integrated_cost + cost_increment;
+
+				// Continue straight ahead until the first node outside the block. Inside the block,
+				// all steps in the same direction have the same cost.
+				if(jumps.interior_block(end_loc) != -1)
+				{
+					auto const step = cheapest_route::vec<int64_t, 2>{neigbour_offsets[k]};
+					auto step_count = std::min(jumps.steps_inside_block(end_loc, step),
+						steps_inside(lattice, end_loc, step));
+					if(options.passability != nullptr)
+					{
+						for(int64_t l = 1; l <= step_count; ++l)
+						{
+							if(!is_passable(*options.passability, end_loc + l*step))
+							{ step_count = l - 1; }
+						}
+					}
+
+					if(step_count != 0)
+					{
+						auto const step_cost = cost(end_loc, k);
+						if(step_cost < 0.0)
+						{ throw std::runtime_error{"Cost function must be positive"}; }
+
+						if(step_cost != std::numeric_limits<double>::infinity())
+						{
+							end_loc += step_count*step;
+							new_cost += static_cast<double>(step_count)*step_cost;
+						}
+					}
+
+					if(!outside(end_loc + step, lattice))
+					{
+						auto const step_cost = cost(end_loc, k);
+						if(step_cost < 0.0)
+						{ throw std::runtime_error{"Cost function must be positive"}; }
+
+						if(step_cost != std::numeric_limits<double>::infinity())
+						{
+							end_loc += step;
+							new_cost += step_cost;
+						}
+					}
+				}
+
+				auto& new_cost_item = get_current(get_item(cost_table, end_loc, lattice), generation);
 				if(new_cost_item.visited)
 				{ continue; }
 
-				auto const new_cost = current.integrated_cost + cost_increment;
-				if(new_cost < new_cost_item.integrated_cost)
+				if(new_cost < new_cost_item.integrated_cost && new_cost <= options.max_cost)
 				{
 					new_cost_item.integrated_cost = new_cost;
 					new_cost_item.loc = cheapest_route::from<int64_t>{current.loc.value()};
-					nodes_to_visit.push(pending_route_node{next_loc, new_cost});
+					if(labels != nullptr)
+					{ get_item(labels, end_loc, lattice) = get_item(labels, current.loc, lattice); }
+					nodes_to_visit.push_back(pending_route_node{cheapest_route::to<int64_t>{end_loc}, new_cost});
+					std::ranges::push_heap(nodes_to_visit, cmp);
 				}
 			}
 		}
-		throw std::runtime_error{std::string{"Target "}.append(to_string(target)).append(" not reached")};
+		if(target.has_value())
+		{ throw_not_reached(*target, options.max_cost); }
+
+		return search_result{cost_table, labels, generation, scale_int*source, lattice};
 	}
 }
 
 namespace
 {
-	auto follow_path(search_result const& res)
+	void follow_path(search_result const& res, cheapest_route::path& ret)
 	{
+		auto const push = [&ret](cheapest_route::vec<int64_t, 2> loc, double integrated_cost) {
+			ret.push_back(cheapest_route::path::value_type{
+				cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{scale_to_float(scale, loc)},
+				integrated_cost
+			});
+		};
+
 		auto loc_search = res.termination_point;
-		auto loc_prev = scale_to_float(scale, loc_search);
-		cheapest_route::path ret;
+		ret.clear();
 		while(true)
 		{
-			auto const loc = scale_to_float(scale, loc_search);
-			auto const& item = get_item(res.cost_table.get(), loc_search, res.dom_scaled.width());
+			auto const& item = get_item(res.cost_table, loc_search, res.lattice);
+			auto const loc = cheapest_route::vec<int64_t, 2>{loc_search};
+			push(loc, item.integrated_cost);
 
-			ret.push_back(cheapest_route::path::value_type{
-				cheapest_route::vec<double, 2, cheapest_route::quantity_type::point>{loc}, item.integrated_cost
-			});
-
-			if(item.integrated_cost == std::numeric_limits<double>::infinity())
+			auto const parent = cheapest_route::vec<int64_t, 2>{item.loc};
+			if(parent[0] == loc[0] && parent[1] == loc[1])
 			{
-				ret.back().integrated_cost = 0.0;
 				std::reverse(std::begin(ret), std::end(ret));
-				return ret;
+				return;
+			}
+
+			// Restore the nodes that were jumped over. Their cost is interpolated.
+			auto const [direction, step_count] = cheapest_route::lattice_detail::split_straight_line(loc - parent);
+			if(step_count > 1)
+			{
+				auto const parent_cost = get_item(res.cost_table, parent, res.lattice).integrated_cost;
+				auto const step = cheapest_route::vec<int64_t, 2>{neigbour_offsets[direction]};
+				for(auto k = step_count - 1; k != 0; --k)
+				{
+					push(parent + k*step, parent_cost
+						+ (item.integrated_cost - parent_cost)*static_cast<double>(k)/static_cast<double>(step_count));
+				}
 			}
 
-			loc_prev = loc;
 			loc_search = item.loc;
 		}
-		return ret;
 	}
 }
 
+cheapest_route::path const& cheapest_route::search_impl(from<int64_t> source,
+	to<int64_t> target,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	search_context& context)
+{
+	auto& buffers = context.get_buffers();
+	auto const jumps = make_jump_regions(source, target, domain, options);
+	auto const tmp = do_search(std::span{&source, 1}, target, domain, callback_data, cost_function, options, jumps, buffers);
+	follow_path(tmp, buffers.route);
+	return buffers.route;
+}
+
 cheapest_route::path cheapest_route::search_impl(from<int64_t> source,
 	to<int64_t> target,
 	dimensions_2d<int64_t, boundary_type::inclusive, boundary_type::exclusive, boundary_type::inclusive, boundary_type::exclusive> const& domain,
 	void const* callback_data,
-	cost_function_ptr cost_function)
+	cost_function_ptr cost_function,
+	search_options const& options)
+{
+	search_context::buffers buffers;
+	auto const jumps = make_jump_regions(source, target, domain, options);
+	auto const tmp = do_search(std::span{&source, 1}, target, domain, callback_data, cost_function, options, jumps, buffers);
+	follow_path(tmp, buffers.route);
+	return std::move(buffers.route);
+}
+
+void cheapest_route::cost_field_impl(from<int64_t> source,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	std::span<float> costs)
 {
-	auto tmp = do_search(source, target, domain, callback_data, cost_function);
-	return follow_path(tmp);
-}
\ No newline at end of file
+	if(std::size(costs) != static_cast<size_t>(domain.width()*domain.height()))
+	{ throw std::runtime_error{"The size of the output buffer does not match the search domain"}; }
+
+	search_context::buffers buffers;
+	auto const res = do_search(std::span{&source, 1}, std::nullopt, domain, callback_data, cost_function, options, no_jumps, buffers);
+	std::ranges::fill(costs, std::numeric_limits<float>::infinity());
+	auto const& lattice = res.lattice;
+	for(auto y = lattice.vert_interval.min; y < lattice.vert_interval.max; y += scale_int)
+	{
+		for(auto x = lattice.horz_interval.min; x < lattice.horz_interval.max; x += scale_int)
+		{
+			auto const& item = get_item(res.cost_table, vec<int64_t, 2>{x, y}, lattice);
+			if(is_visited(item, res.generation))
+			{
+				costs[(y/scale_int)*domain.width() + x/scale_int] = static_cast<float>(
+					(x == res.termination_point[0] && y == res.termination_point[1]) ? 0.0 : item.integrated_cost);
+			}
+		}
+	}
+}
+
+void cheapest_route::source_partition_impl(std::span<vec<int64_t, 2> const> sources,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	std::span<float> costs,
+	std::span<uint32_t> labels)
+{
+	auto const pixel_count = static_cast<size_t>(domain.width()*domain.height());
+	if(std::size(costs) != pixel_count || std::size(labels) != pixel_count)
+	{ throw std::runtime_error{"The size of the output buffers does not match the search domain"}; }
+
+	if(std::empty(sources))
+	{ throw std::runtime_error{"At least one source is needed"}; }
+
+	if(std::size(sources) >= no_source)
+	{ throw std::runtime_error{"Too many sources"}; }
+
+	std::vector<from<int64_t>> seeds(std::begin(sources), std::end(sources));
+	search_context::buffers buffers;
+	auto const res = do_search(seeds, std::nullopt, domain, callback_data, cost_function, options, no_jumps, buffers,
+		true);
+	std::ranges::fill(costs, std::numeric_limits<float>::infinity());
+	std::ranges::fill(labels, no_source);
+	auto const& lattice = res.lattice;
+	for(auto y = lattice.vert_interval.min; y < lattice.vert_interval.max; y += scale_int)
+	{
+		for(auto x = lattice.horz_interval.min; x < lattice.horz_interval.max; x += scale_int)
+		{
+			auto const loc = vec<int64_t, 2>{x, y};
+			auto const& item = get_item(res.cost_table, loc, lattice);
+			if(is_visited(item, res.generation))
+			{
+				auto const index = (y/scale_int)*domain.width() + x/scale_int;
+				costs[index] = static_cast<float>(item.integrated_cost);
+				labels[index] = get_item(res.labels, loc, lattice);
+			}
+		}
+	}
+}
+
+cheapest_route::search_tree cheapest_route::build_search_tree_impl(to<int64_t> root,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options)
+{
+	search_context::buffers buffers;
+	auto const source = from<int64_t>{root.value()};
+	auto const res = do_search(std::span{&source, 1}, std::nullopt, domain, callback_data, cost_function, options,
+		no_jumps, buffers);
+
+	search_tree ret{domain, root};
+	auto const costs = ret.costs();
+	auto const directions = ret.directions();
+	std::ranges::fill(costs, std::numeric_limits<float>::infinity());
+	std::ranges::fill(directions, no_parent);
+	auto const tree_lattice = make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	for(auto y = tree_lattice.vert_interval.min; y != tree_lattice.vert_interval.max; ++y)
+	{
+		for(auto x = tree_lattice.horz_interval.min; x != tree_lattice.horz_interval.max; ++x)
+		{
+			auto const loc = vec<int64_t, 2>{x, y};
+			auto& cost = get_item(std::data(costs), loc, tree_lattice);
+			auto& dir = get_item(std::data(directions), loc, tree_lattice);
+			if(outside(loc, res.lattice))
+			{ continue; }
+
+			auto const& item = get_item(res.cost_table, loc, res.lattice);
+			if(!is_visited(item, res.generation))
+			{ continue; }
+
+			if(x == res.termination_point[0] && y == res.termination_point[1])
+			{
+				cost = 0.0f;
+				continue;
+			}
+
+			cost = static_cast<float>(item.integrated_cost);
+			dir = lattice_detail::get_direction(loc - vec<int64_t, 2>{item.loc.value()});
+		}
+	}
+	return ret;
+}
@@ -8,6 +8,11 @@
 #include <cmath>
 #include <vector>
 #include <utility>
+#include <optional>
+#include <limits>
+#include <type_traits>
+#include <span>
+#include <memory>
 
 namespace cheapest_route
 {
@@ -43,30 +48,208 @@ namespace cheapest_route
 
 	using cost_function_ptr = double (*)(void const* callback_data, from<double>, to<double>);
 
+	// Stores the cost of going from x0 to each point in x1 in costs
+	using batch_cost_function_ptr = void (*)(void const* callback_data,
+		from<double> x0,
+		std::span<to<double> const> x1,
+		std::span<double> costs);
+
+	struct batch_cost_function
+	{
+		void const* callback_data;
+		batch_cost_function_ptr evaluate;
+	};
+
+	// Wraps f.evaluate_batch, which must give the same costs as f
+	template<class CostFunction>
+	batch_cost_function make_batch_cost_function(CostFunction const& f)
+	{
+		return batch_cost_function{&f, [](void const* callback_data,
+			from<double> x0,
+			std::span<to<double> const> x1,
+			std::span<double> costs){
+			static_cast<CostFunction const*>(callback_data)->evaluate_batch(x0, x1, costs);
+		}};
+	}
+
 	using search_domain = dimensions_2d<int64_t,
 		boundary_type::inclusive,
 		boundary_type::exclusive,
 		boundary_type::inclusive,
 		boundary_type::exclusive>;
 
+	using search_bounds = rectangle<int64_t,
+		boundary_type::inclusive,
+		boundary_type::exclusive,
+		boundary_type::inclusive,
+		boundary_type::exclusive>;
+
+	struct edge_weights_view;
+	struct passability_view;
+	struct uniform_block_view;
+	struct search_monitor;
+	struct arc_flags_view;
+
+	struct search_options
+	{
+		// The search gives up on nodes that are more expensive to reach than max_cost
+		double max_cost = std::numeric_limits<double>::infinity();
+
+		// Restricts the search to a part of the domain. The cost table is sized after bounds.
+		std::optional<search_bounds> bounds;
+
+		// Precompiled edge weights to use instead of the cost function. They must cover the
+		// search domain.
+		edge_weights_view const* edge_weights = nullptr;
+
+		// Pixels that cannot be entered. Edges into a lattice node whose nearest pixel is blocked
+		// are skipped without evaluating their cost. The mask must cover the search domain.
+		passability_view const* passability = nullptr;
+
+		// Lets search cross uniform blocks along straight lines, without settling the lattice
+		// nodes in between (jump pruning). This expands far fewer nodes on flat terrain, but the
+		// route may be slightly more expensive, since it can only turn near block edges. The
+		// blocks that contain the source or the target are searched normally. Only used by
+		// search.
+		uniform_block_view const* uniform_blocks = nullptr;
+
+		// Makes it possible to stop the search from another thread, and reports its progress. Only
+		// used by search, cost fields, source partitions, and search trees. anytime_search,
+		// incremental_search, search_adaptive, and compute_arc_flags ignore it.
+		search_monitor const* monitor = nullptr;
+
+		// Evaluates all edges that leave a node in one call, instead of calling the cost function
+		// once per edge. It must give the same costs as the cost function. Not used together with
+		// edge_weights, and only used by search, cost fields, source partitions, and search trees.
+		batch_cost_function const* batch_cost = nullptr;
+
+		// Skips edges that are not on a cheapest route into the region of the target. The flags
+		// must have been computed with the same cost function, edge weights, and passability. They
+		// cannot be combined with bounds or uniform_blocks, and are only used by search.
+		arc_flags_view const* arc_flags = nullptr;
+	};
+
+	// Owns the buffers used by a search, so later queries can reuse them. A query only resets the
+	// nodes touched by the previous one. A context must not be used by several threads at the
+	// same time.
+	class search_context
+	{
+	public:
+		struct buffers;
+
+		search_context();
+		~search_context();
+		search_context(search_context&&) noexcept;
+		search_context& operator=(search_context&&) noexcept;
+
+		buffers& get_buffers()
+		{ return *m_buffers; }
+
+	private:
+		std::unique_ptr<buffers> m_buffers;
+	};
+
 	path search_impl(from<int64_t> source,
 		to<int64_t> target,
 		search_domain const& domain,
 		void const* callback_data,
-		cost_function_ptr cost_function);
+		cost_function_ptr cost_function,
+		search_options const& options);
+
+	path const& search_impl(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		search_context& context);
 
 	template<class CostFunction = flat_euclidian_norm>
 	auto search(from<int64_t> source,
 		to<int64_t> target,
 		search_domain const& domain,
-		CostFunction&& f = flat_euclidian_norm{})
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
 	{
 		return search_impl(source, target, domain, &f, [](void const* func_pair,
 			from<double> x0,
 			to<double> x1){
-			auto const& data = *static_cast<CostFunction const*>(func_pair);
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options);
+	}
+
+	// Like search, but uses the buffers in context. The returned path is owned by context, and is
+	// valid until the next query.
+	template<class CostFunction>
+	path const& search(from<int64_t> source,
+		to<int64_t> target,
+		search_domain const& domain,
+		CostFunction&& f,
+		search_options const& options,
+		search_context& context)
+	{
+		return search_impl(source, target, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options, context);
+	}
+
+	void cost_field_impl(from<int64_t> source,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		std::span<float> costs);
+
+	// Computes the integrated cost of reaching every pixel in domain from source. Pixels that
+	// cannot be reached, or are more expensive than options.max_cost, are set to infinity.
+	template<class CostFunction = flat_euclidian_norm>
+	void compute_cost_field(from<int64_t> source,
+		search_domain const& domain,
+		std::span<float> costs,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
+	{
+		cost_field_impl(source, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options, costs);
+	}
+
+	// The label of pixels that cannot be reached from any source
+	constexpr uint32_t no_source = std::numeric_limits<uint32_t>::max();
+
+	void source_partition_impl(std::span<vec<int64_t, 2> const> sources,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		std::span<float> costs,
+		std::span<uint32_t> labels);
+
+	// Labels every pixel in domain with the index of the source that is cheapest to reach it from,
+	// and stores that cost, using one search seeded with all sources. Pixels that cannot be
+	// reached, or are more expensive than options.max_cost, are labeled no_source and set to
+	// infinity.
+	template<class CostFunction = flat_euclidian_norm>
+	void compute_source_partition(std::span<vec<int64_t, 2> const> sources,
+		search_domain const& domain,
+		std::span<float> costs,
+		std::span<uint32_t> labels,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
+	{
+		source_partition_impl(sources, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
 			return static_cast<double>(data(x0, x1));
-		});
+		}, options, costs, labels);
 	}
 }
 
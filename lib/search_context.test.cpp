@@ -0,0 +1,76 @@
+//@	{"target":{"name":"search_context.test"}}
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+	bool same_path(cheapest_route::path const& a, cheapest_route::path const& b)
+	{
+		return std::ranges::equal(a, b, [](auto const& x, auto const& y){
+			return x.loc[0] == y.loc[0] && x.loc[1] == y.loc[1] && x.integrated_cost == y.integrated_cost;
+		});
+	}
+}
+
+int main()
+{
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	struct query
+	{
+		cheapest_route::from<int64_t> source;
+		cheapest_route::to<int64_t> target;
+		cheapest_route::search_domain domain;
+		cheapest_route::search_options options;
+	};
+
+	auto bounded = cheapest_route::search_options{};
+	bounded.bounds = cheapest_route::search_bounds{
+		cheapest_route::make_interval<cheapest_route::boundary_type::inclusive,
+			cheapest_route::boundary_type::exclusive>(int64_t{20}, int64_t{90}),
+		cheapest_route::make_interval<cheapest_route::boundary_type::inclusive,
+			cheapest_route::boundary_type::exclusive>(int64_t{10}, int64_t{70})
+	};
+
+	// Later queries should not see any state from earlier ones, even when the lattice shrinks or grows
+	std::array const queries{
+		query{cheapest_route::from<int64_t>{3, 4}, cheapest_route::to<int64_t>{150, 100}, cheapest_route::search_domain{160, 120}, cheapest_route::search_options{}},
+		query{cheapest_route::from<int64_t>{25, 15}, cheapest_route::to<int64_t>{80, 60}, cheapest_route::search_domain{160, 120}, bounded},
+		query{cheapest_route::from<int64_t>{150, 100}, cheapest_route::to<int64_t>{3, 4}, cheapest_route::search_domain{160, 120}, cheapest_route::search_options{}},
+		query{cheapest_route::from<int64_t>{0, 0}, cheapest_route::to<int64_t>{239, 179}, cheapest_route::search_domain{240, 180}, cheapest_route::search_options{}},
+		query{cheapest_route::from<int64_t>{10, 10}, cheapest_route::to<int64_t>{11, 12}, cheapest_route::search_domain{40, 30}, cheapest_route::search_options{}}
+	};
+
+	cheapest_route::search_context context;
+	for(auto const& item : queries)
+	{
+		auto const& reused = cheapest_route::search(item.source, item.target, item.domain, f, item.options, context);
+		auto const fresh = cheapest_route::search(item.source, item.target, item.domain, f, item.options);
+		printf("%zu %.8g\n", std::size(reused), reused.back().integrated_cost);
+		assert(same_path(reused, fresh));
+	}
+
+	// A failed query must leave the context usable
+	auto limited = cheapest_route::search_options{};
+	limited.max_cost = 10.0;
+	try
+	{
+		cheapest_route::search(queries[0].source, queries[0].target, queries[0].domain, f, limited, context);
+		assert(false);
+	}
+	catch(std::runtime_error const&)
+	{}
+
+	auto const& reused = cheapest_route::search(queries[2].source, queries[2].target, queries[2].domain, f, queries[2].options, context);
+	assert(same_path(reused, cheapest_route::search(queries[2].source, queries[2].target, queries[2].domain, f, queries[2].options)));
+}
@@ -0,0 +1,50 @@
+#ifndef CHEAPESTROUTE_SEARCHMONITOR_HPP
+#define CHEAPESTROUTE_SEARCHMONITOR_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <stop_token>
+
+namespace cheapest_route
+{
+	struct search_progress
+	{
+		// The integrated cost of the node that was settled last. Every route that has not been
+		// found yet is at least this expensive.
+		double frontier_cost;
+
+		// min_cost_per_length times the straight-line distance between the source and the target.
+		// Zero when there is no target.
+		double lower_bound;
+
+		size_t settled_count;
+	};
+
+	using progress_callback_ptr = void (*)(void* callback_data, search_progress const& progress);
+
+	// Lets another thread stop a search, and reports how far it has come. Both are checked every
+	// search_monitor::check_interval settled nodes.
+	struct search_monitor
+	{
+		static constexpr size_t check_interval = 4096;
+
+		// The search throws search_cancelled once a stop has been requested
+		std::stop_token stop;
+
+		// Called from the thread that runs the search. May be null.
+		void* callback_data = nullptr;
+		progress_callback_ptr report_progress = nullptr;
+
+		// A lower bound of the cost of moving one pixel, used for search_progress::lower_bound
+		double min_cost_per_length = 0.0;
+	};
+
+	class search_cancelled:public std::runtime_error
+	{
+	public:
+		search_cancelled():std::runtime_error{"The search was cancelled"}
+		{}
+	};
+}
+
+#endif
@@ -0,0 +1,59 @@
+//@	{"target":{"name":"search_tree.o"}}
+
+#include "./search_tree.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+size_t cheapest_route::lattice_node_count(search_domain const& domain)
+{
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{domain, origin_at_zero{}});
+	return lattice_detail::node_count(lattice);
+}
+
+cheapest_route::path cheapest_route::follow_search_tree(search_tree_view const& tree, from<int64_t> origin)
+{
+	using lattice_detail::scale_int;
+	using lattice_detail::get_item;
+
+	if(outside(vec<int64_t, 2>{origin}, tree.domain))
+	{ throw std::runtime_error{"Source location is outside search domain"}; }
+
+	auto const lattice = lattice_detail::make_lattice_rectangle(search_bounds{tree.domain, origin_at_zero{}});
+	if(std::size(tree.costs) != lattice_node_count(tree.domain)
+		|| std::size(tree.directions) != lattice_node_count(tree.domain))
+	{ throw std::runtime_error{"Search tree does not match its domain"}; }
+
+	auto loc = vec<int64_t, 2>{scale_int*origin};
+	auto const origin_cost = static_cast<double>(get_item(std::data(tree.costs), loc, lattice));
+	if(origin_cost == std::numeric_limits<double>::infinity())
+	{
+		throw std::runtime_error{std::string{"Target "}.append(to_string(tree.root))
+			.append(" cannot be reached from ").append(to_string(origin))};
+	}
+
+	path ret;
+	while(true)
+	{
+		if(std::size(ret) > std::size(tree.costs))
+		{ throw std::runtime_error{"Search tree contains a cycle"}; }
+
+		auto const cost = static_cast<double>(get_item(std::data(tree.costs), loc, lattice));
+		ret.push_back(visited_node{
+			vec<double, 2, quantity_type::point>{scale_to_float(lattice_detail::scale, loc)},
+			std::max(origin_cost - cost, 0.0)
+		});
+
+		auto const dir = get_item(std::data(tree.directions), loc, lattice);
+		if(dir == no_parent)
+		{ break; }
+
+		loc -= vec<int64_t, 2>{lattice_detail::neigbour_offsets[dir]};
+	}
+
+	if(loc[0] != scale_int*tree.root[0] || loc[1] != scale_int*tree.root[1])
+	{ throw std::runtime_error{"Search tree is broken"}; }
+
+	return ret;
+}
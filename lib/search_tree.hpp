@@ -0,0 +1,91 @@
+//@	{"dependencies_extra":[{"ref":"./search_tree.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_SEARCHTREE_HPP
+#define CHEAPESTROUTE_SEARCHTREE_HPP
+
+#include "./search.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace cheapest_route
+{
+	// Marks lattice nodes without a parent. That is the root, and nodes that were not reached.
+	constexpr uint8_t no_parent = 0xff;
+
+	// A compact shortest-path tree, with the integrated cost and the direction towards the parent
+	// of every lattice node in the domain
+	struct search_tree_view
+	{
+		search_domain domain;
+		to<int64_t> root;
+		std::span<float const> costs;
+		std::span<uint8_t const> directions;
+	};
+
+	size_t lattice_node_count(search_domain const& domain);
+
+	class search_tree
+	{
+	public:
+		explicit search_tree(search_domain const& domain, to<int64_t> root):
+			m_domain{domain},
+			m_root{root},
+			m_node_count{lattice_node_count(domain)},
+			m_costs{std::make_unique_for_overwrite<float[]>(m_node_count)},
+			m_directions{std::make_unique_for_overwrite<uint8_t[]>(m_node_count)}
+		{}
+
+		search_tree_view view() const
+		{
+			return search_tree_view{
+				m_domain,
+				m_root,
+				std::span{m_costs.get(), m_node_count},
+				std::span{m_directions.get(), m_node_count}
+			};
+		}
+
+		std::span<float> costs()
+		{ return std::span{m_costs.get(), m_node_count}; }
+
+		std::span<uint8_t> directions()
+		{ return std::span{m_directions.get(), m_node_count}; }
+
+	private:
+		search_domain m_domain;
+		to<int64_t> m_root;
+		size_t m_node_count;
+		std::unique_ptr<float[]> m_costs;
+		std::unique_ptr<uint8_t[]> m_directions;
+	};
+
+	search_tree build_search_tree_impl(to<int64_t> root,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options);
+
+	// Computes the shortest-path tree rooted at root, covering all nodes that can be reached. The
+	// search runs from root, so the tree can only be used to find routes towards root when the
+	// cost function is symmetric.
+	template<class CostFunction = flat_euclidian_norm>
+	search_tree build_search_tree(to<int64_t> root,
+		search_domain const& domain,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
+	{
+		return build_search_tree_impl(root, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options);
+	}
+
+	// Walks the tree from origin to the root. The integrated cost starts at zero in origin.
+	path follow_search_tree(search_tree_view const& tree, from<int64_t> origin);
+}
+
+#endif
@@ -0,0 +1,36 @@
+//@	{"target":{"name":"search_tree.test"}}
+
+#include "./search_tree.hpp"
+
+#include <cassert>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const root = cheapest_route::to<int64_t>{120, 80};
+	auto const tree = build_search_tree(root, domain, f);
+
+	for(auto origin : {cheapest_route::from<int64_t>{3, 4},
+		cheapest_route::from<int64_t>{159, 0},
+		cheapest_route::from<int64_t>{120, 80}})
+	{
+		auto const from_tree = follow_search_tree(tree.view(), origin);
+		auto const direct = search(origin, root, domain, f);
+		printf("%zu %.8g %zu %.8g\n",
+			std::size(from_tree), from_tree.back().integrated_cost,
+			std::size(direct), direct.back().integrated_cost);
+
+		assert(from_tree.front().loc[0] == static_cast<double>(origin[0]));
+		assert(from_tree.front().loc[1] == static_cast<double>(origin[1]));
+		assert(from_tree.back().loc[0] == static_cast<double>(root[0]));
+		assert(from_tree.back().loc[1] == static_cast<double>(root[1]));
+		assert(std::abs(from_tree.back().integrated_cost - direct.back().integrated_cost)
+			<= 1.0e-5*direct.back().integrated_cost);
+	}
+}
@@ -0,0 +1,71 @@
+//@	{"target":{"name":"source_partition.test"}}
+
+#include "./search.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{64, 48};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	std::array const sources{
+		cheapest_route::vec<int64_t, 2>{3, 4},
+		cheapest_route::vec<int64_t, 2>{60, 10},
+		cheapest_route::vec<int64_t, 2>{30, 40},
+		cheapest_route::vec<int64_t, 2>{31, 40}
+	};
+
+	auto const pixel_count = static_cast<size_t>(domain.width()*domain.height());
+	std::vector<float> costs(pixel_count);
+	std::vector<uint32_t> labels(pixel_count);
+	compute_source_partition(sources, domain, costs, labels, f);
+
+	// Compare with one cost field per source
+	std::vector<std::vector<float>> fields;
+	for(auto const& source : sources)
+	{
+		fields.emplace_back(pixel_count);
+		compute_cost_field(cheapest_route::from<int64_t>{source}, domain, fields.back(), f);
+	}
+
+	std::array<size_t, std::size(sources)> label_count{};
+	for(size_t k = 0; k != pixel_count; ++k)
+	{
+		auto min_cost = std::numeric_limits<float>::infinity();
+		for(auto const& field : fields)
+		{ min_cost = std::min(min_cost, field[k]); }
+
+		assert(labels[k] < std::size(sources));
+		++label_count[labels[k]];
+		assert(std::abs(costs[k] - min_cost) <= 1.0e-5f*min_cost);
+		assert(std::abs(fields[labels[k]][k] - min_cost) <= 1.0e-5f*min_cost);
+	}
+
+	for(size_t k = 0; k != std::size(sources); ++k)
+	{
+		auto const& source = sources[k];
+		auto const index = static_cast<size_t>(source[1]*domain.width() + source[0]);
+		printf("%zu %zu\n", k, label_count[k]);
+		assert(labels[index] == k);
+		assert(costs[index] == 0.0f);
+	}
+
+	// Pixels beyond max_cost are not reached from any source
+	auto limited = cheapest_route::search_options{};
+	limited.max_cost = 10.0;
+	compute_source_partition(sources, domain, costs, labels, f, limited);
+	for(size_t k = 0; k != pixel_count; ++k)
+	{
+		assert((labels[k] == cheapest_route::no_source) == (costs[k] == std::numeric_limits<float>::infinity()));
+		assert(costs[k] == std::numeric_limits<float>::infinity() || costs[k] <= 10.0f);
+	}
+	assert(labels.back() == cheapest_route::no_source);
+}
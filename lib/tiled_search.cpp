@@ -0,0 +1,226 @@
+//@	{"target":{"name":"tiled_search.o"}}
+
+#include "./tiled_search.hpp"
+#include "./lattice.hpp"
+
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+cheapest_route::search_bounds cheapest_route::tile_bounds(tile_grid const& grid, vec<int64_t, 2> tile)
+{
+	auto const x0 = tile[0]*grid.tile_size;
+	auto const y0 = tile[1]*grid.tile_size;
+	auto const x1 = std::min(x0 + grid.tile_size, grid.domain.width() - 1);
+	auto const y1 = std::min(y0 + grid.tile_size, grid.domain.height() - 1);
+	return search_bounds{
+		make_interval<boundary_type::inclusive, boundary_type::exclusive>(x0, x1 + 1),
+		make_interval<boundary_type::inclusive, boundary_type::exclusive>(y0, y1 + 1)
+	};
+}
+
+cheapest_route::search_bounds cheapest_route::tile_window(tile_grid const& grid, vec<int64_t, 2> tile)
+{
+	auto const bounds = tile_bounds(grid, tile);
+	return search_bounds{
+		make_interval<boundary_type::inclusive, boundary_type::exclusive>(
+			std::max(bounds.horz_interval.min - grid.overlap, int64_t{0}),
+			std::min(bounds.horz_interval.max + grid.overlap, grid.domain.width())),
+		make_interval<boundary_type::inclusive, boundary_type::exclusive>(
+			std::max(bounds.vert_interval.min - grid.overlap, int64_t{0}),
+			std::min(bounds.vert_interval.max + grid.overlap, grid.domain.height()))
+	};
+}
+
+namespace
+{
+	// The end points of [first, last], and the multiples of spacing between them
+	std::vector<int64_t> edge_positions(int64_t first, int64_t last, int64_t spacing)
+	{
+		std::vector<int64_t> ret{first};
+		for(auto k = (first/spacing + 1)*spacing; k < last; k += spacing)
+		{ ret.push_back(k); }
+		if(last != first)
+		{ ret.push_back(last); }
+		return ret;
+	}
+}
+
+std::vector<cheapest_route::vec<int64_t, 2>>
+cheapest_route::tile_boundary_nodes(tile_grid const& grid, vec<int64_t, 2> tile)
+{
+	auto const bounds = tile_bounds(grid, tile);
+	auto const x0 = bounds.horz_interval.min;
+	auto const x1 = bounds.horz_interval.max - 1;
+	auto const y0 = bounds.vert_interval.min;
+	auto const y1 = bounds.vert_interval.max - 1;
+
+	std::vector<vec<int64_t, 2>> ret;
+	auto const add_vertical_edge = [&ret, y0, y1, spacing = grid.boundary_spacing](int64_t x) {
+		for(auto const y : edge_positions(y0, y1, spacing))
+		{ ret.push_back(vec<int64_t, 2>{x, y}); }
+	};
+	auto const add_horizontal_edge = [&ret, x0, x1, spacing = grid.boundary_spacing](int64_t y) {
+		for(auto const x : edge_positions(x0, x1, spacing))
+		{ ret.push_back(vec<int64_t, 2>{x, y}); }
+	};
+
+	if(tile[0] != 0)
+	{ add_vertical_edge(x0); }
+	if(tile[0] != tile_count_x(grid) - 1)
+	{ add_vertical_edge(x1); }
+	if(tile[1] != 0)
+	{ add_horizontal_edge(y0); }
+	if(tile[1] != tile_count_y(grid) - 1)
+	{ add_horizontal_edge(y1); }
+
+	// Corners belong to two edges
+	std::ranges::sort(ret, [](auto a, auto b) { return a[1] != b[1] ? a[1] < b[1] : a[0] < b[0]; });
+	auto const duplicates = std::ranges::unique(ret, [](auto a, auto b) { return a[0] == b[0] && a[1] == b[1]; });
+	ret.erase(std::begin(duplicates), std::end(duplicates));
+	return ret;
+}
+
+cheapest_route::tile_costs cheapest_route::compute_tile_costs_impl(tile_grid const& grid,
+	vec<int64_t, 2> tile,
+	std::span<vec<int64_t, 2> const> extra_nodes,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options)
+{
+	if(options.bounds.has_value())
+	{ throw std::runtime_error{"Tiles cannot be combined with search bounds"}; }
+
+	tile_costs ret{tile, tile_boundary_nodes(grid, tile), {}};
+	auto const bounds = tile_bounds(grid, tile);
+	for(auto const item : extra_nodes)
+	{
+		if(inside(item, bounds) && std::ranges::none_of(ret.nodes, [item](auto node) {
+			return node[0] == item[0] && node[1] == item[1];
+		}))
+		{ ret.nodes.push_back(item); }
+	}
+
+	auto const window = tile_window(grid, tile);
+	auto const window_domain = search_domain{window.width(), window.height()};
+	auto const n = std::size(ret.nodes);
+	ret.costs.resize(n*n);
+	std::vector<float> field(static_cast<size_t>(window.width()*window.height()));
+	for(size_t i = 0; i != n; ++i)
+	{
+		cost_field_impl(from<int64_t>{ret.nodes[i] - window.min()},
+			window_domain,
+			callback_data,
+			cost_function,
+			options,
+			field);
+
+		for(size_t j = 0; j != n; ++j)
+		{
+			auto const loc = ret.nodes[j] - window.min();
+			ret.costs[i*n + j] = field[static_cast<size_t>(loc[1]*window.width() + loc[0])];
+		}
+	}
+	return ret;
+}
+
+std::vector<cheapest_route::tile_leg> cheapest_route::find_tile_legs(tile_grid const& grid,
+	std::span<tile_costs const> tiles,
+	from<int64_t> origin,
+	to<int64_t> destination)
+{
+	if(origin[0] == destination[0] && origin[1] == destination[1])
+	{
+		auto const tile = vec<int64_t, 2>{
+			std::min(origin[0]/grid.tile_size, tile_count_x(grid) - 1),
+			std::min(origin[1]/grid.tile_size, tile_count_y(grid) - 1)
+		};
+		return std::vector{tile_leg{tile, origin, destination}};
+	}
+
+	struct edge
+	{
+		uint32_t to;
+		uint32_t tile;
+		float cost;
+	};
+
+	std::unordered_map<int64_t, uint32_t> node_ids;
+	std::vector<vec<int64_t, 2>> node_locs;
+	std::vector<std::vector<edge>> edges;
+	auto const get_node_id = [&node_ids, &node_locs, &edges, width = grid.domain.width()](vec<int64_t, 2> loc) {
+		auto const [i, inserted] = node_ids.emplace(loc[1]*width + loc[0], static_cast<uint32_t>(std::size(node_locs)));
+		if(inserted)
+		{
+			node_locs.push_back(loc);
+			edges.emplace_back();
+		}
+		return i->second;
+	};
+
+	for(size_t t = 0; t != std::size(tiles); ++t)
+	{
+		auto const& item = tiles[t];
+		auto const n = std::size(item.nodes);
+		std::vector<uint32_t> ids(n);
+		for(size_t k = 0; k != n; ++k)
+		{ ids[k] = get_node_id(item.nodes[k]); }
+
+		for(size_t i = 0; i != n; ++i)
+		{
+			for(size_t j = 0; j != n; ++j)
+			{
+				auto const cost = item.costs[i*n + j];
+				if(i != j && cost != std::numeric_limits<float>::infinity())
+				{ edges[ids[i]].push_back(edge{ids[j], static_cast<uint32_t>(t), cost}); }
+			}
+		}
+	}
+
+	auto const width = grid.domain.width();
+	auto const source = node_ids.find(origin[1]*width + origin[0]);
+	auto const target = node_ids.find(destination[1]*width + destination[0]);
+	if(source == std::end(node_ids) || target == std::end(node_ids))
+	{ throw std::runtime_error{"The origin and the destination must be nodes of the tiles"}; }
+
+	constexpr auto no_node = std::numeric_limits<uint32_t>::max();
+	std::vector<double> costs(std::size(node_locs), std::numeric_limits<double>::infinity());
+	std::vector<std::pair<uint32_t, uint32_t>> came_from(std::size(node_locs), std::pair{no_node, no_node});
+	std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, std::greater<>> nodes;
+	costs[source->second] = 0.0;
+	nodes.push(std::pair{0.0, source->second});
+	while(!nodes.empty())
+	{
+		auto const [cost, node] = nodes.top();
+		nodes.pop();
+		if(cost != costs[node])
+		{ continue; }
+
+		if(node == target->second)
+		{ break; }
+
+		for(auto const& item : edges[node])
+		{
+			auto const new_cost = cost + static_cast<double>(item.cost);
+			if(new_cost < costs[item.to])
+			{
+				costs[item.to] = new_cost;
+				came_from[item.to] = std::pair{node, item.tile};
+				nodes.push(std::pair{new_cost, item.to});
+			}
+		}
+	}
+
+	if(costs[target->second] == std::numeric_limits<double>::infinity())
+	{ lattice_detail::throw_not_reached(destination, std::numeric_limits<double>::infinity()); }
+
+	std::vector<tile_leg> ret;
+	for(auto node = target->second; node != source->second; node = came_from[node].first)
+	{
+		auto const [prev, tile] = came_from[node];
+		ret.push_back(tile_leg{tiles[tile].tile, from<int64_t>{node_locs[prev]}, to<int64_t>{node_locs[node]}});
+	}
+	std::ranges::reverse(ret);
+	return ret;
+}
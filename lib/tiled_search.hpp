@@ -0,0 +1,92 @@
+//@	{"dependencies_extra":[{"ref":"./tiled_search.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_TILEDSEARCH_HPP
+#define CHEAPESTROUTE_TILEDSEARCH_HPP
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace cheapest_route
+{
+	// Splits a domain into square tiles of tile_size pixels. Adjacent tiles share the pixels on
+	// their common edge. Routes within a tile may leave it by up to overlap pixels. Routes between
+	// tiles cross the shared edges at boundary nodes, placed every boundary_spacing pixels.
+	struct tile_grid
+	{
+		search_domain domain;
+		int64_t tile_size;
+		int64_t overlap;
+		int64_t boundary_spacing;
+	};
+
+	constexpr int64_t tile_count_x(tile_grid const& grid)
+	{ return std::max((grid.domain.width() + grid.tile_size - 2)/grid.tile_size, int64_t{1}); }
+
+	constexpr int64_t tile_count_y(tile_grid const& grid)
+	{ return std::max((grid.domain.height() + grid.tile_size - 2)/grid.tile_size, int64_t{1}); }
+
+	// The pixels of tile, including its edges
+	search_bounds tile_bounds(tile_grid const& grid, vec<int64_t, 2> tile);
+
+	// The pixels that a route within tile may use
+	search_bounds tile_window(tile_grid const& grid, vec<int64_t, 2> tile);
+
+	// The boundary nodes on the edges that tile shares with other tiles, in domain coordinates.
+	// Both tiles of an edge get the same nodes.
+	std::vector<vec<int64_t, 2>> tile_boundary_nodes(tile_grid const& grid, vec<int64_t, 2> tile);
+
+	// The cost of the cheapest route within a tile between any two of its nodes. The cost from
+	// nodes[i] to nodes[j] is costs[i*size(nodes) + j], and is infinity if there is no such route.
+	struct tile_costs
+	{
+		vec<int64_t, 2> tile;
+		std::vector<vec<int64_t, 2>> nodes;
+		std::vector<float> costs;
+	};
+
+	tile_costs compute_tile_costs_impl(tile_grid const& grid,
+		vec<int64_t, 2> tile,
+		std::span<vec<int64_t, 2> const> extra_nodes,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options);
+
+	// Computes the costs between the boundary nodes of tile, and the extra_nodes that are within
+	// it, by searching within its window. f is called with coordinates relative to the window, so
+	// it only needs the part of the cost map that the window covers.
+	template<class CostFunction = flat_euclidian_norm>
+	tile_costs compute_tile_costs(tile_grid const& grid,
+		vec<int64_t, 2> tile,
+		std::span<vec<int64_t, 2> const> extra_nodes,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{})
+	{
+		return compute_tile_costs_impl(grid, tile, extra_nodes, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options);
+	}
+
+	// A part of a route that stays within the window of tile
+	struct tile_leg
+	{
+		vec<int64_t, 2> tile;
+		from<int64_t> origin;
+		to<int64_t> destination;
+	};
+
+	// Finds the cheapest route from origin to destination through the graph formed by the costs
+	// of all tiles, and splits it into legs. origin and destination must have been extra nodes when
+	// the costs were computed.
+	std::vector<tile_leg> find_tile_legs(tile_grid const& grid,
+		std::span<tile_costs const> tiles,
+		from<int64_t> origin,
+		to<int64_t> destination);
+}
+
+#endif
@@ -0,0 +1,92 @@
+//@	{"target":{"name":"tiled_search.test"}}
+
+#include "./tiled_search.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	double cost(cheapest_route::from<double> x0, cheapest_route::to<double> x1)
+	{
+		auto const mid = midpoint(x1, x0);
+		if(mid[0] > 20.0 && mid[0] < 22.0 && mid[1] > 6.0)
+		{ return 50.0*std::sqrt(length_squared(x1 - x0)); }
+		return (1.0 + 0.5*std::sin(mid[0]/5.0)*std::cos(mid[1]/3.0))*std::sqrt(length_squared(x1 - x0));
+	}
+
+	// The cost function as seen by a tile, whose window starts at offset
+	auto window_cost(cheapest_route::vec<int64_t, 2> offset)
+	{
+		auto const dx = static_cast<double>(offset[0]);
+		auto const dy = static_cast<double>(offset[1]);
+		return [dx, dy](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+			return cost(cheapest_route::from<double>{x0[0] + dx, x0[1] + dy},
+				cheapest_route::to<double>{x1[0] + dx, x1[1] + dy});
+		};
+	}
+}
+
+int main()
+{
+	auto const grid = cheapest_route::tile_grid{cheapest_route::search_domain{48, 40}, 16, 4, 4};
+	assert(tile_count_x(grid) == 3);
+	assert(tile_count_y(grid) == 3);
+
+	// Adjacent tiles share the nodes on their common edge
+	{
+		auto const left = tile_boundary_nodes(grid, cheapest_route::vec<int64_t, 2>{0, 1});
+		auto const right = tile_boundary_nodes(grid, cheapest_route::vec<int64_t, 2>{1, 1});
+		size_t shared = 0;
+		for(auto const a : left)
+		{
+			for(auto const b : right)
+			{ shared += (a[0] == b[0] && a[1] == b[1]) ? 1 : 0; }
+		}
+		assert(shared == 5);
+	}
+
+	for(auto const& [source, target] : {
+		std::pair{cheapest_route::from<int64_t>{1, 38}, cheapest_route::to<int64_t>{46, 37}},
+		std::pair{cheapest_route::from<int64_t>{45, 2}, cheapest_route::to<int64_t>{3, 30}},
+		std::pair{cheapest_route::from<int64_t>{3, 3}, cheapest_route::to<int64_t>{9, 5}}})
+	{
+		std::array const extra_nodes{cheapest_route::vec<int64_t, 2>{source}, cheapest_route::vec<int64_t, 2>{target}};
+		std::vector<cheapest_route::tile_costs> tiles;
+		for(int64_t y = 0; y != tile_count_y(grid); ++y)
+		{
+			for(int64_t x = 0; x != tile_count_x(grid); ++x)
+			{
+				auto const tile = cheapest_route::vec<int64_t, 2>{x, y};
+				tiles.push_back(compute_tile_costs(grid, tile, extra_nodes, window_cost(tile_window(grid, tile).min())));
+			}
+		}
+
+		auto const legs = find_tile_legs(grid, tiles, source, target);
+		assert(!std::empty(legs));
+		assert(legs.front().origin[0] == source[0] && legs.front().origin[1] == source[1]);
+		assert(legs.back().destination[0] == target[0] && legs.back().destination[1] == target[1]);
+
+		auto tiled_cost = 0.0;
+		for(auto const& leg : legs)
+		{
+			auto const window = tile_window(grid, leg.tile);
+			auto const offset = window.min();
+			auto const origin = cheapest_route::vec<int64_t, 2>{leg.origin} - offset;
+			auto const destination = cheapest_route::vec<int64_t, 2>{leg.destination} - offset;
+			auto const route = search(cheapest_route::from<int64_t>{origin},
+				cheapest_route::to<int64_t>{destination},
+				cheapest_route::search_domain{window.width(), window.height()},
+				window_cost(offset));
+			tiled_cost += route.back().integrated_cost;
+		}
+
+		auto const direct = search(source, target, grid.domain,
+			window_cost(cheapest_route::vec<int64_t, 2>{0, 0}));
+		auto const direct_cost = direct.back().integrated_cost;
+		printf("%zu %.8g %.8g\n", std::size(legs), tiled_cost, direct_cost);
+		assert(tiled_cost >= direct_cost*(1.0 - 1.0e-9));
+		assert(tiled_cost <= direct_cost*1.05);
+	}
+}
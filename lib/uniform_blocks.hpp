@@ -0,0 +1,98 @@
+#ifndef CHEAPESTROUTE_UNIFORMBLOCKS_HPP
+#define CHEAPESTROUTE_UNIFORMBLOCKS_HPP
+
+#include "./search.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace cheapest_route
+{
+	// One bit per square block of block_size x block_size pixels, stored row by row. A set bit
+	// marks a block where the cost of an edge only depends on its direction, and not on where it
+	// starts.
+	struct uniform_block_view
+	{
+		search_domain domain;
+		int64_t block_size;
+		std::span<uint64_t const> bits;
+
+		int64_t columns() const
+		{ return (domain.width() + block_size - 1)/block_size; }
+
+		bool uniform(int64_t block_x, int64_t block_y) const
+		{
+			auto const index = static_cast<uint64_t>(block_y*columns() + block_x);
+			return (bits[index/64] >> (index%64)) & 1;
+		}
+	};
+
+	constexpr size_t uniform_block_word_count(search_domain const& domain, int64_t block_size)
+	{
+		auto const columns = (domain.width() + block_size - 1)/block_size;
+		auto const rows = (domain.height() + block_size - 1)/block_size;
+		return (static_cast<size_t>(columns*rows) + 63)/64;
+	}
+
+	class uniform_block_mask
+	{
+	public:
+		// No block is uniform initially
+		explicit uniform_block_mask(search_domain const& domain, int64_t block_size):
+			m_domain{domain},
+			m_block_size{block_size},
+			m_word_count{uniform_block_word_count(domain, block_size)},
+			m_bits{std::make_unique<uint64_t[]>(m_word_count)}
+		{}
+
+		uniform_block_view view() const
+		{ return uniform_block_view{m_domain, m_block_size, std::span{m_bits.get(), m_word_count}}; }
+
+		void set_uniform(int64_t block_x, int64_t block_y, bool value)
+		{
+			auto const index = static_cast<uint64_t>(block_y*view().columns() + block_x);
+			auto const bit = uint64_t{1} << (index%64);
+			m_bits[index/64] = value ? (m_bits[index/64] | bit) : (m_bits[index/64] & ~bit);
+		}
+
+	private:
+		search_domain m_domain;
+		int64_t m_block_size;
+		size_t m_word_count;
+		std::unique_ptr<uint64_t[]> m_bits;
+	};
+
+	// Marks the blocks where same_cost(x0, y0, x1, y1) holds between the first pixel of the block
+	// and every other pixel of it. Since edge costs are interpolated, the first row and column of
+	// the next block are included.
+	template<class SameCost>
+	uniform_block_mask make_uniform_block_mask(search_domain const& domain,
+		int64_t block_size,
+		SameCost&& same_cost)
+	{
+		uniform_block_mask ret{domain, block_size};
+		auto const view = ret.view();
+		for(int64_t block_y = 0; block_y*block_size < domain.height(); ++block_y)
+		{
+			for(int64_t block_x = 0; block_x < view.columns(); ++block_x)
+			{
+				auto const x_0 = block_x*block_size;
+				auto const y_0 = block_y*block_size;
+				auto const x_1 = std::min(x_0 + block_size, domain.width() - 1);
+				auto const y_1 = std::min(y_0 + block_size, domain.height() - 1);
+				auto uniform = true;
+				for(auto y = y_0; y <= y_1 && uniform; ++y)
+				{
+					for(auto x = x_0; x <= x_1 && uniform; ++x)
+					{ uniform = same_cost(x_0, y_0, x, y); }
+				}
+				ret.set_uniform(block_x, block_y, uniform);
+			}
+		}
+		return ret;
+	}
+}
+
+#endif
@@ -0,0 +1,76 @@
+//@	{"target":{"name":"uniform_blocks.test"}}
+
+#include "./uniform_blocks.hpp"
+
+#include <cassert>
+#include <utility>
+#include <cmath>
+#include <cstdio>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{256, 192};
+
+	// Flat terrain, with a rough area in the middle
+	auto const friction = [](int64_t x, int64_t y) {
+		auto const dx = static_cast<double>(x - 128);
+		auto const dy = static_cast<double>(y - 96);
+		return dx*dx + dy*dy < 40.0*40.0 ? 2.0 + std::sin(static_cast<double>(x)/5.0) : 1.0;
+	};
+
+	size_t call_count = 0;
+	auto const f = [&call_count, friction](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		++call_count;
+		auto const mid = midpoint(x1, x0);
+		auto const x = static_cast<int64_t>(mid[0]);
+		auto const y = static_cast<int64_t>(mid[1]);
+		auto const xi = mid[0] - static_cast<double>(x);
+		auto const eta = mid[1] - static_cast<double>(y);
+		auto const val = (1.0 - eta)*((1.0 - xi)*friction(x, y) + xi*friction(x + 1, y))
+			+ eta*((1.0 - xi)*friction(x, y + 1) + xi*friction(x + 1, y + 1));
+		return val*std::sqrt(length_squared(x1 - x0));
+	};
+
+	auto const mask = make_uniform_block_mask(domain, 16, [friction](int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+		return friction(x0, y0) == friction(x1, y1);
+	});
+	auto const blocks = mask.view();
+	assert(blocks.uniform(0, 0));
+	assert(!blocks.uniform(8, 6));
+
+	for(auto const& [source, target] : {
+		std::pair{cheapest_route::from<int64_t>{3, 4}, cheapest_route::to<int64_t>{250, 180}},
+		std::pair{cheapest_route::from<int64_t>{250, 10}, cheapest_route::to<int64_t>{5, 150}},
+		std::pair{cheapest_route::from<int64_t>{20, 100}, cheapest_route::to<int64_t>{30, 101}}})
+	{
+		call_count = 0;
+		auto const reference = search(source, target, domain, f);
+		auto const reference_calls = call_count;
+
+		call_count = 0;
+		auto options = cheapest_route::search_options{};
+		options.uniform_blocks = &blocks;
+		auto const pruned = search(source, target, domain, f, options);
+		auto const pruned_calls = call_count;
+
+		printf("%.8g %.8g %zu %zu\n", reference.back().integrated_cost, pruned.back().integrated_cost,
+			reference_calls, pruned_calls);
+		fflush(stdout);
+		assert(pruned_calls < reference_calls);
+		assert(pruned.back().integrated_cost >= reference.back().integrated_cost*(1.0 - 1.0e-9));
+		assert(pruned.back().integrated_cost <= 1.02*reference.back().integrated_cost);
+
+		assert(pruned.front().loc[0] == static_cast<double>(source[0]));
+		assert(pruned.front().loc[1] == static_cast<double>(source[1]));
+		assert(pruned.back().loc[0] == static_cast<double>(target[0]));
+		assert(pruned.back().loc[1] == static_cast<double>(target[1]));
+
+		// The nodes that were jumped over are part of the route
+		for(size_t k = 1; k != std::size(pruned); ++k)
+		{
+			auto const step = pruned[k].loc - pruned[k - 1].loc;
+			assert(length_squared(step) <= 1.25 + 1.0e-9);
+			assert(pruned[k].integrated_cost >= pruned[k - 1].integrated_cost);
+		}
+	}
+}
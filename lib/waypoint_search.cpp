@@ -0,0 +1,78 @@
+//@	{"target":{"name":"waypoint_search.o"}}
+
+#include "./waypoint_search.hpp"
+#include "./lattice.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+cheapest_route::path cheapest_route::search_via_waypoints_impl(std::span<vec<int64_t, 2> const> points,
+	search_domain const& domain,
+	void const* callback_data,
+	cost_function_ptr cost_function,
+	search_options const& options,
+	size_t thread_count)
+{
+	if(std::size(points) < 2)
+	{ throw std::runtime_error{"A route needs at least two points"}; }
+
+	auto const leg_count = std::size(points) - 1;
+	std::vector<path> legs(leg_count);
+	std::vector<std::exception_ptr> errors(leg_count);
+	std::atomic<size_t> next_leg{0};
+	{
+		std::vector<std::jthread> workers;
+		for(size_t k = 0; k != std::min(std::max(thread_count, size_t{1}), leg_count); ++k)
+		{
+			workers.emplace_back([&]() {
+				search_context context;
+				while(true)
+				{
+					auto const leg = next_leg++;
+					if(leg >= leg_count)
+					{ return; }
+
+					try
+					{
+						auto const& route = search_impl(from<int64_t>{points[leg]},
+							to<int64_t>{points[leg + 1]},
+							domain,
+							callback_data,
+							cost_function,
+							options,
+							context);
+						legs[leg].assign(std::begin(route), std::end(route));
+					}
+					catch(...)
+					{ errors[leg] = std::current_exception(); }
+				}
+			});
+		}
+	}
+
+	// Report the error of the first leg that failed, as a sequential search would have done
+	for(auto const& item : errors)
+	{
+		if(item != nullptr)
+		{ std::rethrow_exception(item); }
+	}
+
+	path ret;
+	auto offset = 0.0;
+	for(auto const& leg : legs)
+	{
+		// The first node of a leg is the last node of the previous one
+		auto const first = std::empty(ret) ? std::begin(leg) : std::next(std::begin(leg));
+		for(auto i = first; i != std::end(leg); ++i)
+		{ ret.push_back(visited_node{i->loc, offset + i->integrated_cost}); }
+		offset = ret.back().integrated_cost;
+	}
+
+	if(offset > options.max_cost)
+	{ lattice_detail::throw_not_reached(to<int64_t>{points.back()}, options.max_cost); }
+
+	return ret;
+}
@@ -0,0 +1,40 @@
+//@	{"dependencies_extra":[{"ref":"./waypoint_search.o", "rel":"implementation"}]}
+
+#ifndef CHEAPESTROUTE_WAYPOINTSEARCH_HPP
+#define CHEAPESTROUTE_WAYPOINTSEARCH_HPP
+
+#include "./search.hpp"
+
+#include <span>
+#include <thread>
+
+namespace cheapest_route
+{
+	path search_via_waypoints_impl(std::span<vec<int64_t, 2> const> points,
+		search_domain const& domain,
+		void const* callback_data,
+		cost_function_ptr cost_function,
+		search_options const& options,
+		size_t thread_count);
+
+	// Finds the cheapest route that visits points in order. The legs between consecutive points
+	// are independent, and are solved concurrently using up to thread_count threads, so the cost
+	// function is called concurrently. The integrated cost accumulates across legs, and max_cost
+	// applies to the whole route.
+	template<class CostFunction = flat_euclidian_norm>
+	path search_via_waypoints(std::span<vec<int64_t, 2> const> points,
+		search_domain const& domain,
+		CostFunction&& f = flat_euclidian_norm{},
+		search_options const& options = search_options{},
+		size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		return search_via_waypoints_impl(points, domain, &f, [](void const* func_pair,
+			from<double> x0,
+			to<double> x1){
+			auto const& data = *static_cast<std::remove_cvref_t<CostFunction> const*>(func_pair);
+			return static_cast<double>(data(x0, x1));
+		}, options, thread_count);
+	}
+}
+
+#endif
@@ -0,0 +1,64 @@
+//@	{"target":{"name":"waypoint_search.test"}}
+
+#include "./waypoint_search.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+
+int main()
+{
+	auto const domain = cheapest_route::search_domain{160, 120};
+	auto const f = [](cheapest_route::from<double> x0, cheapest_route::to<double> x1) {
+		auto const mid = midpoint(x1, x0);
+		return (1.0 + 0.5*std::sin(mid[0]/10.0)*std::cos(mid[1]/7.0))*std::sqrt(length_squared(x1 - x0));
+	};
+
+	std::array const points{
+		cheapest_route::vec<int64_t, 2>{3, 4},
+		cheapest_route::vec<int64_t, 2>{150, 20},
+		cheapest_route::vec<int64_t, 2>{150, 20},
+		cheapest_route::vec<int64_t, 2>{40, 110},
+		cheapest_route::vec<int64_t, 2>{120, 80}
+	};
+
+	auto const route = search_via_waypoints(points, domain, f);
+
+	// Compare with the legs solved one by one
+	size_t expected_size = 1;
+	auto expected_cost = 0.0;
+	for(size_t k = 0; k + 1 != std::size(points); ++k)
+	{
+		auto const leg = search(cheapest_route::from<int64_t>{points[k]}, cheapest_route::to<int64_t>{points[k + 1]}, domain, f);
+		expected_size += std::size(leg) - 1;
+		expected_cost += leg.back().integrated_cost;
+	}
+
+	printf("%zu %.8g\n", std::size(route), route.back().integrated_cost);
+	assert(std::size(route) == expected_size);
+	assert(std::abs(route.back().integrated_cost - expected_cost) <= 1.0e-9*expected_cost);
+	assert(route.front().integrated_cost == 0.0);
+	assert(std::ranges::is_sorted(route, [](auto const& a, auto const& b) {
+		return a.integrated_cost < b.integrated_cost;
+	}));
+
+	for(auto const& point : points)
+	{
+		assert(std::ranges::any_of(route, [point](auto const& item) {
+			return item.loc[0] == static_cast<double>(point[0]) && item.loc[1] == static_cast<double>(point[1]);
+		}));
+	}
+
+	// max_cost applies to the whole route, not only to each leg
+	auto limited = cheapest_route::search_options{};
+	limited.max_cost = 0.75*expected_cost;
+	try
+	{
+		search_via_waypoints(points, domain, f, limited);
+		assert(false);
+	}
+	catch(std::runtime_error const& err)
+	{ printf("%s\n", err.what()); }
+}